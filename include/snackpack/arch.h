@@ -0,0 +1,17 @@
+#ifndef _SNACKPACK_ARCH_H_
+#define _SNACKPACK_ARCH_H_
+
+#include <stdbool.h>
+#include "snackpack/snackpack.h"
+
+
+const char *
+sp_get_arch(void);
+
+
+bool
+sp_set_arch(
+    const char * const name);
+
+
+#endif
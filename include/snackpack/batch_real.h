@@ -0,0 +1,156 @@
+#ifndef _SNACKPACK_BATCH_REAL_H_
+#define _SNACKPACK_BATCH_REAL_H_
+
+#include <stdbool.h>
+#include "snackpack/snackpack.h"
+
+
+/*
+ * Batched level 1 and 2 routines. Each applies the same operation to
+ * batch_count independent vectors or matrices of the same shape. The plain
+ * form takes the first vector or matrix and the distance (stride) between
+ * consecutive ones; the _ptr form takes an array of pointers to them.
+ */
+
+
+void
+sp_blas_sasum_batch(
+    len_t n,
+    const float * const x,
+    len_t inc_x,
+    len_t stride_x,
+    float * const result,
+    len_t batch_count);
+
+
+void
+sp_blas_sasum_batch_ptr(
+    len_t n,
+    const float * const * const x,
+    len_t inc_x,
+    float * const result,
+    len_t batch_count);
+
+
+void
+sp_blas_saxpy_batch(
+    len_t n,
+    float alpha,
+    const float * const x,
+    len_t inc_x,
+    len_t stride_x,
+    float * const y,
+    len_t inc_y,
+    len_t stride_y,
+    len_t batch_count);
+
+
+void
+sp_blas_saxpy_batch_ptr(
+    len_t n,
+    float alpha,
+    const float * const * const x,
+    len_t inc_x,
+    float * const * const y,
+    len_t inc_y,
+    len_t batch_count);
+
+
+void
+sp_blas_sdot_batch(
+    len_t n,
+    const float * const x,
+    len_t inc_x,
+    len_t stride_x,
+    const float * const y,
+    len_t inc_y,
+    len_t stride_y,
+    float * const result,
+    len_t batch_count);
+
+
+void
+sp_blas_sdot_batch_ptr(
+    len_t n,
+    const float * const * const x,
+    len_t inc_x,
+    const float * const * const y,
+    len_t inc_y,
+    float * const result,
+    len_t batch_count);
+
+
+void
+sp_blas_snrm2_batch(
+    len_t n,
+    const float * const x,
+    len_t inc_x,
+    len_t stride_x,
+    float * const result,
+    len_t batch_count);
+
+
+void
+sp_blas_snrm2_batch_ptr(
+    len_t n,
+    const float * const * const x,
+    len_t inc_x,
+    float * const result,
+    len_t batch_count);
+
+
+void
+sp_blas_sscal_batch(
+    len_t n,
+    float alpha,
+    float * const x,
+    len_t inc_x,
+    len_t stride_x,
+    len_t batch_count);
+
+
+void
+sp_blas_sscal_batch_ptr(
+    len_t n,
+    float alpha,
+    float * const * const x,
+    len_t inc_x,
+    len_t batch_count);
+
+
+void
+sp_blas_sgemv_batch(
+    bool is_trans,
+    len_t rows,
+    len_t cols,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    len_t stride_A,
+    const float * const x,
+    len_t inc_x,
+    len_t stride_x,
+    float beta,
+    float * const y,
+    len_t inc_y,
+    len_t stride_y,
+    len_t batch_count);
+
+
+void
+sp_blas_sgemv_batch_ptr(
+    bool is_trans,
+    len_t rows,
+    len_t cols,
+    float alpha,
+    const float * const * const A,
+    len_t lda,
+    const float * const * const x,
+    len_t inc_x,
+    float beta,
+    float * const * const y,
+    len_t inc_y,
+    len_t batch_count);
+
+
+#endif
@@ -136,4 +136,49 @@ sp_blas_isamin(
     len_t inc_x);
 
 
+len_t
+sp_blas_isamax_value(
+    len_t n,
+    const float * const x,
+    len_t inc_x,
+    float * const value);
+
+
+len_t
+sp_blas_isamin_value(
+    len_t n,
+    const float * const x,
+    len_t inc_x,
+    float * const value);
+
+
+float
+sp_blas_saxpy_dot(
+    len_t n,
+    float alpha,
+    const float * const x,
+    len_t inc_x,
+    float * const y,
+    len_t inc_y,
+    const float * const z,
+    len_t inc_z);
+
+
+float
+sp_blas_snrm2_scal(
+    len_t n,
+    float * const x,
+    len_t inc_x);
+
+
+void
+sp_blas_scopy_scal(
+    len_t n,
+    float alpha,
+    const float * const x,
+    len_t inc_x,
+    float * const y,
+    len_t inc_y);
+
+
 #endif
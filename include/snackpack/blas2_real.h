@@ -1,7 +1,6 @@
 #ifndef _SNACKPACK_BLAS2_REAL_H_
 #define _SNACKPACK_BLAS2_REAL_H_
 
-#include <math.h>
 #include <stdbool.h>
 #include "snackpack/snackpack.h"
 
@@ -11,16 +10,29 @@ sp_blas_sgemv(
     bool is_trans,
     len_t m,
     len_t n,
-    float_t alpha,
-    const float_t * const a,
+    float alpha,
+    const float * const a,
     len_t lda,
-    const float_t * const x,
+    const float * const x,
     len_t inc_x,
-    float_t beta,
-    float_t * const y,
+    float beta,
+    float * const y,
     len_t inc_y);
 
 
+void
+sp_blas_sger(
+    len_t rows,
+    len_t cols,
+    float alpha,
+    const float * const x,
+    len_t inc_x,
+    const float * const y,
+    len_t inc_y,
+    float * const A,
+    len_t lda);
+
+
 void
 sp_blas_strmv(
     bool is_upper,
@@ -33,4 +45,145 @@ sp_blas_strmv(
     len_t inc_x);
 
 
+void
+sp_blas_strsv(
+    bool is_upper,
+    bool is_trans,
+    bool is_unit,
+    len_t n,
+    const float * const A,
+    len_t lda,
+    float * const x,
+    len_t inc_x);
+
+
+void
+sp_blas_ssymv(
+    bool is_upper,
+    len_t n,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    const float * const x,
+    len_t inc_x,
+    float beta,
+    float * const y,
+    len_t inc_y);
+
+
+void
+sp_blas_sspmv(
+    bool is_upper,
+    len_t n,
+    float alpha,
+    const float * const AP,
+    const float * const x,
+    len_t inc_x,
+    float beta,
+    float * const y,
+    len_t inc_y);
+
+
+void
+sp_blas_stpmv(
+    bool is_upper,
+    bool is_trans,
+    bool is_unit,
+    len_t n,
+    const float * const AP,
+    float * const x,
+    len_t inc_x);
+
+
+void
+sp_blas_stpsv(
+    bool is_upper,
+    bool is_trans,
+    bool is_unit,
+    len_t n,
+    const float * const AP,
+    float * const x,
+    len_t inc_x);
+
+
+void
+sp_blas_sspr(
+    bool is_upper,
+    len_t n,
+    float alpha,
+    const float * const x,
+    len_t inc_x,
+    float * const AP);
+
+
+void
+sp_blas_sspr2(
+    bool is_upper,
+    len_t n,
+    float alpha,
+    const float * const x,
+    len_t inc_x,
+    const float * const y,
+    len_t inc_y,
+    float * const AP);
+
+
+void
+sp_blas_sgbmv(
+    bool is_trans,
+    len_t rows,
+    len_t cols,
+    len_t kl,
+    len_t ku,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    const float * const x,
+    len_t inc_x,
+    float beta,
+    float * const y,
+    len_t inc_y);
+
+
+void
+sp_blas_ssbmv(
+    bool is_upper,
+    len_t n,
+    len_t k,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    const float * const x,
+    len_t inc_x,
+    float beta,
+    float * const y,
+    len_t inc_y);
+
+
+void
+sp_blas_stbmv(
+    bool is_upper,
+    bool is_trans,
+    bool is_unit,
+    len_t n,
+    len_t k,
+    const float * const A,
+    len_t lda,
+    float * const x,
+    len_t inc_x);
+
+
+void
+sp_blas_stbsv(
+    bool is_upper,
+    bool is_trans,
+    bool is_unit,
+    len_t n,
+    len_t k,
+    const float * const A,
+    len_t lda,
+    float * const x,
+    len_t inc_x);
+
+
 #endif
@@ -0,0 +1,40 @@
+#ifndef _SNACKPACK_BLAS3_REAL_H_
+#define _SNACKPACK_BLAS3_REAL_H_
+
+#include <stdbool.h>
+#include "snackpack/snackpack.h"
+
+
+void
+sp_blas_sgemm(
+    bool is_trans_a,
+    bool is_trans_b,
+    len_t m,
+    len_t n,
+    len_t k,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    const float * const B,
+    len_t ldb,
+    float beta,
+    float * const C,
+    len_t ldc);
+
+
+void
+sp_blas_strsm(
+    bool is_left,
+    bool is_upper,
+    bool is_trans,
+    bool is_unit,
+    len_t m,
+    len_t n,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    float * const B,
+    len_t ldb);
+
+
+#endif
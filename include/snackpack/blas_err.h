@@ -0,0 +1,527 @@
+#ifndef _SNACKPACK_BLAS_ERR_H_
+#define _SNACKPACK_BLAS_ERR_H_
+
+#include <stdbool.h>
+#include "snackpack/snackpack.h"
+#include "snackpack/error.h"
+
+
+/*
+ * Forms of the BLAS routines that return an SP_ERROR code instead of
+ * printing. Each sp_blas_X_err takes the arguments of sp_blas_X; routines
+ * that return a value store it through a trailing result or index pointer,
+ * which holds the same fallback value as sp_blas_X when the call fails.
+ * Nothing is printed and no lock is taken on failure, so these are safe to
+ * call from many threads at once. The batched routines of batch_real.h
+ * have _err forms as well. srotg, srotm and srotmg check nothing and have
+ * none.
+ *
+ * The code returned is that of the call alone. Like the plain routines,
+ * a call that passes leaves the thread-local error of snackpack/error.h as
+ * it was; one that fails stores its error there.
+ */
+
+
+SP_ERROR
+sp_blas_sasum_err(
+    len_t n,
+    const float * const x,
+    len_t inc_x,
+    float * const result);
+
+
+SP_ERROR
+sp_blas_saxpy_err(
+    len_t n,
+    float alpha,
+    const float * const x,
+    len_t inc_x,
+    float * const y,
+    len_t inc_y);
+
+
+SP_ERROR
+sp_blas_sdot_err(
+    len_t n,
+    const float * const x,
+    len_t inc_x,
+    const float * const y,
+    len_t inc_y,
+    float * const result);
+
+
+SP_ERROR
+sp_blas_srot_err(
+    len_t n,
+    float * const x,
+    len_t inc_x,
+    float * const y,
+    len_t inc_y,
+    float c,
+    float s);
+
+
+SP_ERROR
+sp_blas_sswap_err(
+    len_t n,
+    float * const x,
+    len_t inc_x,
+    float * const y,
+    len_t inc_y);
+
+
+SP_ERROR
+sp_blas_scopy_err(
+    len_t n,
+    const float * const x,
+    len_t inc_x,
+    float * const y,
+    len_t inc_y);
+
+
+SP_ERROR
+sp_blas_snrm2_err(
+    len_t n,
+    const float * const x,
+    len_t inc_x,
+    float * const result);
+
+
+SP_ERROR
+sp_blas_sscal_err(
+    len_t n,
+    float alpha,
+    float * const x,
+    len_t inc_x);
+
+
+SP_ERROR
+sp_blas_isamax_err(
+    len_t n,
+    const float * const x,
+    len_t inc_x,
+    len_t * const index);
+
+
+SP_ERROR
+sp_blas_isamin_err(
+    len_t n,
+    const float * const x,
+    len_t inc_x,
+    len_t * const index);
+
+
+SP_ERROR
+sp_blas_isamax_value_err(
+    len_t n,
+    const float * const x,
+    len_t inc_x,
+    float * const value,
+    len_t * const index);
+
+
+SP_ERROR
+sp_blas_isamin_value_err(
+    len_t n,
+    const float * const x,
+    len_t inc_x,
+    float * const value,
+    len_t * const index);
+
+
+SP_ERROR
+sp_blas_sdsdot_err(
+    len_t n,
+    float sb,
+    const float * const x,
+    len_t inc_x,
+    const float * const y,
+    len_t inc_y,
+    float * const result);
+
+
+SP_ERROR
+sp_blas_saxpy_dot_err(
+    len_t n,
+    float alpha,
+    const float * const x,
+    len_t inc_x,
+    float * const y,
+    len_t inc_y,
+    const float * const z,
+    len_t inc_z,
+    float * const result);
+
+
+SP_ERROR
+sp_blas_snrm2_scal_err(
+    len_t n,
+    float * const x,
+    len_t inc_x,
+    float * const result);
+
+
+SP_ERROR
+sp_blas_scopy_scal_err(
+    len_t n,
+    float alpha,
+    const float * const x,
+    len_t inc_x,
+    float * const y,
+    len_t inc_y);
+
+
+SP_ERROR
+sp_blas_sgemv_err(
+    bool is_trans,
+    len_t m,
+    len_t n,
+    float alpha,
+    const float * const a,
+    len_t lda,
+    const float * const x,
+    len_t inc_x,
+    float beta,
+    float * const y,
+    len_t inc_y);
+
+
+SP_ERROR
+sp_blas_sger_err(
+    len_t rows,
+    len_t cols,
+    float alpha,
+    const float * const x,
+    len_t inc_x,
+    const float * const y,
+    len_t inc_y,
+    float * const A,
+    len_t lda);
+
+
+SP_ERROR
+sp_blas_strmv_err(
+    bool is_upper,
+    bool is_trans,
+    bool is_unit,
+    len_t n,
+    const float * const A,
+    len_t lda,
+    float * const x,
+    len_t inc_x);
+
+
+SP_ERROR
+sp_blas_strsv_err(
+    bool is_upper,
+    bool is_trans,
+    bool is_unit,
+    len_t n,
+    const float * const A,
+    len_t lda,
+    float * const x,
+    len_t inc_x);
+
+
+SP_ERROR
+sp_blas_ssymv_err(
+    bool is_upper,
+    len_t n,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    const float * const x,
+    len_t inc_x,
+    float beta,
+    float * const y,
+    len_t inc_y);
+
+
+SP_ERROR
+sp_blas_sspmv_err(
+    bool is_upper,
+    len_t n,
+    float alpha,
+    const float * const AP,
+    const float * const x,
+    len_t inc_x,
+    float beta,
+    float * const y,
+    len_t inc_y);
+
+
+SP_ERROR
+sp_blas_stpmv_err(
+    bool is_upper,
+    bool is_trans,
+    bool is_unit,
+    len_t n,
+    const float * const AP,
+    float * const x,
+    len_t inc_x);
+
+
+SP_ERROR
+sp_blas_stpsv_err(
+    bool is_upper,
+    bool is_trans,
+    bool is_unit,
+    len_t n,
+    const float * const AP,
+    float * const x,
+    len_t inc_x);
+
+
+SP_ERROR
+sp_blas_sspr_err(
+    bool is_upper,
+    len_t n,
+    float alpha,
+    const float * const x,
+    len_t inc_x,
+    float * const AP);
+
+
+SP_ERROR
+sp_blas_sspr2_err(
+    bool is_upper,
+    len_t n,
+    float alpha,
+    const float * const x,
+    len_t inc_x,
+    const float * const y,
+    len_t inc_y,
+    float * const AP);
+
+
+SP_ERROR
+sp_blas_sgbmv_err(
+    bool is_trans,
+    len_t rows,
+    len_t cols,
+    len_t kl,
+    len_t ku,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    const float * const x,
+    len_t inc_x,
+    float beta,
+    float * const y,
+    len_t inc_y);
+
+
+SP_ERROR
+sp_blas_ssbmv_err(
+    bool is_upper,
+    len_t n,
+    len_t k,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    const float * const x,
+    len_t inc_x,
+    float beta,
+    float * const y,
+    len_t inc_y);
+
+
+SP_ERROR
+sp_blas_stbmv_err(
+    bool is_upper,
+    bool is_trans,
+    bool is_unit,
+    len_t n,
+    len_t k,
+    const float * const A,
+    len_t lda,
+    float * const x,
+    len_t inc_x);
+
+
+SP_ERROR
+sp_blas_stbsv_err(
+    bool is_upper,
+    bool is_trans,
+    bool is_unit,
+    len_t n,
+    len_t k,
+    const float * const A,
+    len_t lda,
+    float * const x,
+    len_t inc_x);
+
+
+SP_ERROR
+sp_blas_sgemm_err(
+    bool is_trans_a,
+    bool is_trans_b,
+    len_t m,
+    len_t n,
+    len_t k,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    const float * const B,
+    len_t ldb,
+    float beta,
+    float * const C,
+    len_t ldc);
+
+
+SP_ERROR
+sp_blas_strsm_err(
+    bool is_left,
+    bool is_upper,
+    bool is_trans,
+    bool is_unit,
+    len_t m,
+    len_t n,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    float * const B,
+    len_t ldb);
+
+
+SP_ERROR
+sp_blas_sasum_batch_err(
+    len_t n,
+    const float * const x,
+    len_t inc_x,
+    len_t stride_x,
+    float * const result,
+    len_t batch_count);
+
+
+SP_ERROR
+sp_blas_sasum_batch_ptr_err(
+    len_t n,
+    const float * const * const x,
+    len_t inc_x,
+    float * const result,
+    len_t batch_count);
+
+
+SP_ERROR
+sp_blas_saxpy_batch_err(
+    len_t n,
+    float alpha,
+    const float * const x,
+    len_t inc_x,
+    len_t stride_x,
+    float * const y,
+    len_t inc_y,
+    len_t stride_y,
+    len_t batch_count);
+
+
+SP_ERROR
+sp_blas_saxpy_batch_ptr_err(
+    len_t n,
+    float alpha,
+    const float * const * const x,
+    len_t inc_x,
+    float * const * const y,
+    len_t inc_y,
+    len_t batch_count);
+
+
+SP_ERROR
+sp_blas_sdot_batch_err(
+    len_t n,
+    const float * const x,
+    len_t inc_x,
+    len_t stride_x,
+    const float * const y,
+    len_t inc_y,
+    len_t stride_y,
+    float * const result,
+    len_t batch_count);
+
+
+SP_ERROR
+sp_blas_sdot_batch_ptr_err(
+    len_t n,
+    const float * const * const x,
+    len_t inc_x,
+    const float * const * const y,
+    len_t inc_y,
+    float * const result,
+    len_t batch_count);
+
+
+SP_ERROR
+sp_blas_snrm2_batch_err(
+    len_t n,
+    const float * const x,
+    len_t inc_x,
+    len_t stride_x,
+    float * const result,
+    len_t batch_count);
+
+
+SP_ERROR
+sp_blas_snrm2_batch_ptr_err(
+    len_t n,
+    const float * const * const x,
+    len_t inc_x,
+    float * const result,
+    len_t batch_count);
+
+
+SP_ERROR
+sp_blas_sscal_batch_err(
+    len_t n,
+    float alpha,
+    float * const x,
+    len_t inc_x,
+    len_t stride_x,
+    len_t batch_count);
+
+
+SP_ERROR
+sp_blas_sscal_batch_ptr_err(
+    len_t n,
+    float alpha,
+    float * const * const x,
+    len_t inc_x,
+    len_t batch_count);
+
+
+SP_ERROR
+sp_blas_sgemv_batch_err(
+    bool is_trans,
+    len_t rows,
+    len_t cols,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    len_t stride_A,
+    const float * const x,
+    len_t inc_x,
+    len_t stride_x,
+    float beta,
+    float * const y,
+    len_t inc_y,
+    len_t stride_y,
+    len_t batch_count);
+
+
+SP_ERROR
+sp_blas_sgemv_batch_ptr_err(
+    bool is_trans,
+    len_t rows,
+    len_t cols,
+    float alpha,
+    const float * const * const A,
+    len_t lda,
+    const float * const * const x,
+    len_t inc_x,
+    float beta,
+    float * const * const y,
+    len_t inc_y,
+    len_t batch_count);
+
+
+#endif
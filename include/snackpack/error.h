@@ -25,15 +25,37 @@ typedef enum {
 extern const char * SP_ERROR_DESCR[NUM_SP_ERROR];
 
 
+/*
+ * Every failed SP_ASSERT_* statement stores its error code in a thread-local
+ * slot that can be read back with sp_get_last_error. Like errno, the slot is
+ * only written on failure: clear it before a call to find out whether that
+ * call failed. The slot of one thread is not changed by calls made on any
+ * other thread.
+ */
+SP_ERROR
+sp_get_last_error(void);
+
+
+void
+sp_clear_last_error(void);
+
+
+void
+sp_set_last_error(
+    SP_ERROR error);
+
+
 /* 
  * If SP_PRINT_ERRORS is defined, then debug information is printed to
  * SP_PRINTF(...), which is by default directed to printf if not defined.
- * Note that SP_PRINTF is always invoked by the SP_PRINT_ERROR macro.
+ * Otherwise nothing is printed, so failing calls never take the stdio lock.
  */
+#ifdef SP_PRINT_ERRORS
 #ifndef SP_PRINTF
 #include <stdio.h>
 #define SP_PRINTF(...) printf(__VA_ARGS__)
 #endif
+#endif
 
 
 /* 
@@ -58,17 +80,23 @@ goto fail; \
 /* 
  * The SP_PRINT_ERROR macro calls SP_PRINTF with a pre-defined message
  * output including the error code, description, and a relevant argument.
+ * It does nothing unless SP_PRINT_ERRORS is defined.
  */
 #ifndef SP_PRINT_ERROR
+#ifdef SP_PRINT_ERRORS
 #define SP_PRINT_ERROR(errno, arg) \
 { \
     if ((errno) < NUM_SP_ERROR) { \
-        SP_PRINTF("Error \"%s\" (%d) in %s(%d):%s\n", \
-            SP_ERROR_DESCR[(errno)], (arg), __FILE__, __LINE__, __func__); \
+        SP_PRINTF("Error \"%s\" (%lld) in %s(%d):%s\n", \
+            SP_ERROR_DESCR[(errno)], (long long)(arg), __FILE__, __LINE__, \
+            __func__); \
     } else { \
         SP_PRINTF("Invalid error code %d!\n", (errno)); \
     } \
 }
+#else
+#define SP_PRINT_ERROR(errno, arg)
+#endif
 #endif
 
 
@@ -83,6 +111,7 @@ goto fail; \
 #define SP_ASSERT_CONDITION(cond, errno, arg) \
 { \
     if (!(cond)) { \
+        sp_set_last_error((errno)); \
         SP_PRINT_ERROR((errno), (arg)); \
         SP_FAIL(); \
     } \
@@ -106,13 +135,15 @@ SP_ASSERT_CONDITION((n) <= SP_MAX_DIMENSION, SP_ERROR_DIM_TOO_LARGE, (n)); \
 
 /**
  * Assert that an argument is a valid vector or matrix increment. A valid
- * increment is != 0 (it may be negative) and <= SP_MAX_DIMENSION.
+ * increment is != 0 (it may be negative) and at most SP_MAX_DIMENSION in
+ * magnitude.
  */
 #ifndef SP_ASSERT_VALID_INC
 #define SP_ASSERT_VALID_INC(n) \
 { \
 SP_ASSERT_CONDITION((n) != 0, SP_ERROR_INVALID_INC, (n)); \
-SP_ASSERT_CONDITION((n) <= SP_MAX_DIMENSION, SP_ERROR_DIM_TOO_LARGE, (n)); \
+SP_ASSERT_CONDITION((n) <= SP_MAX_DIMENSION && (n) >= -SP_MAX_DIMENSION, \
+    SP_ERROR_DIM_TOO_LARGE, (n)); \
 }
 #endif
 
@@ -126,7 +157,7 @@ SP_ASSERT_CONDITION((n) <= SP_MAX_DIMENSION, SP_ERROR_DIM_TOO_LARGE, (n)); \
 #ifndef SP_ASSERT_VALID_LDA
 #define SP_ASSERT_VALID_LDA(lda, m) \
 { \
-SP_ASSERT_CONDITION((lda) >= m, SP_ERROR_INVALID_LDA, (lda)); \
+SP_ASSERT_CONDITION((lda) >= (m), SP_ERROR_INVALID_LDA, (lda)); \
 SP_ASSERT_CONDITION((lda) <= SP_MAX_DIMENSION, SP_ERROR_DIM_TOO_LARGE, (lda)); \
 }
 #endif
@@ -186,4 +186,48 @@ sp_blas_sdsdot_incxy(
     len_t inc_y);
 
 
+/*
+ * Fused saxpy and sdot: y += alpha*x, then return y^T*z. The kernels
+ * always do the update, so alpha = 0 is left to the caller.
+ */
+float
+sp_blas_saxpy_dot_inc1(
+    len_t n,
+    float alpha,
+    const float * const x,
+    float * const y,
+    const float * const z);
+
+
+float
+sp_blas_saxpy_dot_incxyz(
+    len_t n,
+    float alpha,
+    const float * const x,
+    len_t inc_x,
+    float * const y,
+    len_t inc_y,
+    const float * const z,
+    len_t inc_z);
+
+
+/* Fused scopy and sscal: y = alpha*x. alpha = 0 is left to the caller. */
+void
+sp_blas_scopy_scal_inc1(
+    len_t n,
+    float alpha,
+    const float * const x,
+    float * const y);
+
+
+void
+sp_blas_scopy_scal_incxy(
+    len_t n,
+    float alpha,
+    const float * const x,
+    len_t inc_x,
+    float * const y,
+    len_t inc_y);
+
+
 #endif
@@ -0,0 +1,86 @@
+#ifndef _SNACKPACK_INTERNAL_BLAS1_REAL_REDUCE_H_
+#define _SNACKPACK_INTERNAL_BLAS1_REAL_REDUCE_H_
+
+#include "snackpack/snackpack.h"
+
+
+/*
+ * Vectors at least this long are reduced by the chunked routines below
+ * instead of the dispatched kernels, and the chunks are spread over the
+ * thread pool.
+ */
+#ifndef SP_REDUCE_PARALLEL_MIN
+#define SP_REDUCE_PARALLEL_MIN (1 << 15)
+#endif
+
+
+/*
+ * Smallest chunk of a reduction, in elements. Must be a multiple of 16.
+ * Chunks grow for very long vectors so that there are never more than
+ * SP_REDUCE_MAX_CHUNKS of them, which bounds the stack space needed for
+ * the partial results.
+ */
+#ifndef SP_REDUCE_CHUNK
+#define SP_REDUCE_CHUNK (4096)
+#endif
+
+#ifndef SP_REDUCE_MAX_CHUNKS
+#define SP_REDUCE_MAX_CHUNKS (1024)
+#endif
+
+
+/*
+ * Deterministic reductions. The vector is cut into chunks whose size
+ * depends only on n, each chunk is summed by the same portable code with
+ * 16 fixed lanes, and the partial results are combined in a fixed binary
+ * tree. The result is therefore bitwise identical for any number of
+ * threads and any dispatched instruction set, although it may differ in
+ * the last bits from the single-threaded kernels.
+ */
+float
+sp_blas_sasum_reduce(
+    len_t n,
+    const float * const x,
+    len_t inc_x);
+
+
+float
+sp_blas_sdot_reduce(
+    len_t n,
+    const float * const x,
+    len_t inc_x,
+    const float * const y,
+    len_t inc_y);
+
+
+float
+sp_blas_sdsdot_reduce(
+    len_t n,
+    float sb,
+    const float * const x,
+    len_t inc_x,
+    const float * const y,
+    len_t inc_y);
+
+
+float
+sp_blas_snrm2_reduce(
+    len_t n,
+    const float * const x,
+    len_t inc_x);
+
+
+/* y += alpha*x, then return y^T*z, reduced as sp_blas_sdot_reduce. */
+float
+sp_blas_saxpy_dot_reduce(
+    len_t n,
+    float alpha,
+    const float * const x,
+    len_t inc_x,
+    float * const y,
+    len_t inc_y,
+    const float * const z,
+    len_t inc_z);
+
+
+#endif
@@ -0,0 +1,340 @@
+#ifndef _SNACKPACK_INTERNAL_BLAS1_REAL_SIMD_H_
+#define _SNACKPACK_INTERNAL_BLAS1_REAL_SIMD_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "snackpack/snackpack.h"
+#include "snackpack/internal/blas1_real_internal.h"
+
+
+/*
+ * Hand-vectorized versions of the unit-stride level 1 kernels. Each
+ * instruction set lives in its own source file, which is compiled with the
+ * matching -m flags, so these may only be called on a CPU that supports
+ * them; the public wrappers reach them through the dispatch table (see
+ * dispatch.h). The scalar kernels in blas1_real_internal.c are the
+ * reference implementation.
+ *
+ * The reductions use several independent accumulators, so results may
+ * differ from the scalar kernels in the last few bits.
+ */
+
+
+/*
+ * Number of leading elements to handle before ptr is aligned to a multiple
+ * of align bytes, clamped to n. Arrays that are not even float-aligned are
+ * not peeled.
+ */
+static inline len_t
+sp_simd_align_head(
+    const float * const ptr,
+    uintptr_t align,
+    len_t n)
+{
+    uintptr_t addr = (uintptr_t)ptr;
+    len_t head = 0;
+    if ((addr % sizeof(float)) == 0) {
+        head = (len_t)(((align - (addr % align)) % align) / sizeof(float));
+    }
+    return head < n ? head : n;
+}
+
+
+/*
+ * Last step of the vectorized isamax/isamin. Given the best magnitude seen
+ * by each of num_lanes lanes and the index it was found at, return the
+ * overall best index and store its magnitude in *best. Ties go to the
+ * smallest index, so the first occurrence wins as in the scalar kernels.
+ */
+static inline len_t
+sp_simd_pick_lane(
+    const float * const val,
+    const int32_t * const idx,
+    len_t num_lanes,
+    bool is_min,
+    float * const best)
+{
+    float b = val[0];
+    len_t ib = idx[0];
+    for (len_t k = 1; k < num_lanes; k++) {
+        bool is_better = is_min ? val[k] < b : val[k] > b;
+        if (is_better || (val[k] == b && idx[k] < ib)) {
+            b = val[k];
+            ib = idx[k];
+        }
+    }
+    *best = b;
+    return ib;
+}
+
+
+#ifdef SP_HAVE_X86_KERNELS
+
+/* SSE4.2 kernels */
+
+float
+sp_blas_sasum_inc1_sse42(
+    len_t n,
+    const float * const x);
+
+
+void
+sp_blas_saxpy_inc1_sse42(
+    len_t n,
+    float alpha,
+    const float * const x,
+    float * const y);
+
+
+float
+sp_blas_sdot_inc1_sse42(
+    len_t n,
+    const float * const x,
+    const float * const y);
+
+
+void
+sp_blas_srot_inc1_sse42(
+    len_t n,
+    float * const x,
+    float * const y,
+    float c,
+    float s);
+
+
+void
+sp_blas_sscal_inc1_sse42(
+    len_t n,
+    float alpha,
+    float * const x);
+
+
+void
+sp_blas_scopy_inc1_sse42(
+    len_t n,
+    const float * const x,
+    float * const y);
+
+
+void
+sp_blas_sswap_inc1_sse42(
+    len_t n,
+    float * const x,
+    float * const y);
+
+
+float
+sp_blas_snrm2_inc1_sse42(
+    len_t n,
+    const float * const x);
+
+
+len_t
+sp_blas_isamax_inc1_sse42(
+    len_t n,
+    const float * const x);
+
+
+len_t
+sp_blas_isamin_inc1_sse42(
+    len_t n,
+    const float * const x);
+
+
+float
+sp_blas_saxpy_dot_inc1_sse42(
+    len_t n,
+    float alpha,
+    const float * const x,
+    float * const y,
+    const float * const z);
+
+
+void
+sp_blas_scopy_scal_inc1_sse42(
+    len_t n,
+    float alpha,
+    const float * const x,
+    float * const y);
+
+
+/* AVX2 + FMA kernels */
+
+float
+sp_blas_sasum_inc1_avx2(
+    len_t n,
+    const float * const x);
+
+
+void
+sp_blas_saxpy_inc1_avx2(
+    len_t n,
+    float alpha,
+    const float * const x,
+    float * const y);
+
+
+float
+sp_blas_sdot_inc1_avx2(
+    len_t n,
+    const float * const x,
+    const float * const y);
+
+
+void
+sp_blas_srot_inc1_avx2(
+    len_t n,
+    float * const x,
+    float * const y,
+    float c,
+    float s);
+
+
+void
+sp_blas_sscal_inc1_avx2(
+    len_t n,
+    float alpha,
+    float * const x);
+
+
+void
+sp_blas_scopy_inc1_avx2(
+    len_t n,
+    const float * const x,
+    float * const y);
+
+
+void
+sp_blas_sswap_inc1_avx2(
+    len_t n,
+    float * const x,
+    float * const y);
+
+
+float
+sp_blas_snrm2_inc1_avx2(
+    len_t n,
+    const float * const x);
+
+
+len_t
+sp_blas_isamax_inc1_avx2(
+    len_t n,
+    const float * const x);
+
+
+len_t
+sp_blas_isamin_inc1_avx2(
+    len_t n,
+    const float * const x);
+
+
+float
+sp_blas_saxpy_dot_inc1_avx2(
+    len_t n,
+    float alpha,
+    const float * const x,
+    float * const y,
+    const float * const z);
+
+
+void
+sp_blas_scopy_scal_inc1_avx2(
+    len_t n,
+    float alpha,
+    const float * const x,
+    float * const y);
+
+
+/* AVX-512F kernels */
+
+float
+sp_blas_sasum_inc1_avx512(
+    len_t n,
+    const float * const x);
+
+
+void
+sp_blas_saxpy_inc1_avx512(
+    len_t n,
+    float alpha,
+    const float * const x,
+    float * const y);
+
+
+float
+sp_blas_sdot_inc1_avx512(
+    len_t n,
+    const float * const x,
+    const float * const y);
+
+
+void
+sp_blas_srot_inc1_avx512(
+    len_t n,
+    float * const x,
+    float * const y,
+    float c,
+    float s);
+
+
+void
+sp_blas_sscal_inc1_avx512(
+    len_t n,
+    float alpha,
+    float * const x);
+
+
+void
+sp_blas_scopy_inc1_avx512(
+    len_t n,
+    const float * const x,
+    float * const y);
+
+
+void
+sp_blas_sswap_inc1_avx512(
+    len_t n,
+    float * const x,
+    float * const y);
+
+
+float
+sp_blas_snrm2_inc1_avx512(
+    len_t n,
+    const float * const x);
+
+
+len_t
+sp_blas_isamax_inc1_avx512(
+    len_t n,
+    const float * const x);
+
+
+len_t
+sp_blas_isamin_inc1_avx512(
+    len_t n,
+    const float * const x);
+
+
+float
+sp_blas_saxpy_dot_inc1_avx512(
+    len_t n,
+    float alpha,
+    const float * const x,
+    float * const y,
+    const float * const z);
+
+
+void
+sp_blas_scopy_scal_inc1_avx512(
+    len_t n,
+    float alpha,
+    const float * const x,
+    float * const y);
+
+#endif
+
+
+#endif
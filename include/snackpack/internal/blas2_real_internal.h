@@ -0,0 +1,233 @@
+#ifndef _SNACKPACK_INTERNAL_BLAS2_REAL_INTERNAL_H_
+#define _SNACKPACK_INTERNAL_BLAS2_REAL_INTERNAL_H_
+
+#include <stdbool.h>
+#include "snackpack/snackpack.h"
+
+
+/*
+ * Number of rows of y that the non-transposed sgemv kernels update per
+ * sweep over the columns of A. 2048 floats of y (8 KiB) plus the four
+ * column segments of A being streamed stay resident in L1. This is also
+ * the size of the stack buffers used to pack a strided x or y.
+ */
+#ifndef SP_SGEMV_ROW_BLOCK
+#define SP_SGEMV_ROW_BLOCK (2048)
+#endif
+
+
+/*
+ * Work (rows * cols) below which sgemv runs on the calling thread, and the
+ * least work given to each thread above it. Waking the pool costs a few
+ * microseconds, which is about what a 256 x 256 product takes on one core.
+ */
+#ifndef SP_SGEMV_PARALLEL_MIN
+#define SP_SGEMV_PARALLEL_MIN (1 << 16)
+#endif
+
+
+/*
+ * Row split granularity for the threaded non-transposed sgemv. Each thread
+ * gets a multiple of this many rows, so with unit stride the threads only
+ * share cache lines of y at the ends of their pieces.
+ */
+#ifndef SP_SGEMV_PARALLEL_ROWS
+#define SP_SGEMV_PARALLEL_ROWS (64)
+#endif
+
+
+/*
+ * Size of the diagonal blocks in the blocked triangular routines. The
+ * triangle inside a block is done with plain loops on a contiguous copy of
+ * that part of x; everything off the diagonal blocks goes through sgemv.
+ */
+#ifndef SP_STRMV_BLOCK
+#define SP_STRMV_BLOCK (64)
+#endif
+
+
+/*
+ * Number of columns of a rank-1 update done per pass over a block of rows
+ * of A, and so the size of the stack buffer holding alpha * y for them.
+ * The sger kernels keep the current rows of x in registers for all of
+ * these columns.
+ */
+#ifndef SP_SGER_COL_BLOCK
+#define SP_SGER_COL_BLOCK (256)
+#endif
+
+
+/*
+ * Block size of ssymv. The stored triangle is cut into square blocks of
+ * this order; each is read once and used for both of the parts of y that
+ * it touches. Also the size of the stack buffers used to pack strided
+ * vectors for one pair of blocks.
+ */
+#ifndef SP_SSYMV_BLOCK
+#define SP_SSYMV_BLOCK (256)
+#endif
+
+
+/*
+ * Row counts with shape-specialized kernels for small matrices, used by
+ * the batched sgemv. Each must be a multiple of 4, at most
+ * SP_SGEMV_SMALL_MAX_ROWS.
+ */
+#define SP_SGEMV_SMALL_MAX_ROWS (16)
+
+#define SP_SGEMV_IS_SMALL(rows) ((rows) == 4 || (rows) == 8 || (rows) == 16)
+
+
+/* sgemv for A*x with inc_y = 1. Applies beta in the same pass. */
+void
+sp_blas_sgemv_n_inc1(
+    len_t rows,
+    len_t cols,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    const float * const x,
+    len_t inc_x,
+    float beta,
+    float * const y);
+
+
+/* sgemv for A^T*x with inc_x = 1. Applies beta in the same pass. */
+void
+sp_blas_sgemv_t_inc1(
+    len_t rows,
+    len_t cols,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    const float * const x,
+    float beta,
+    float * const y,
+    len_t inc_y);
+
+
+/*
+ * sgemv with unit increments for a small matrix whose number of rows
+ * satisfies SP_SGEMV_IS_SMALL. alpha is applied once to the finished
+ * product.
+ */
+void
+sp_blas_sgemv_n_small(
+    len_t rows,
+    len_t cols,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    const float * const x,
+    float beta,
+    float * const y);
+
+
+void
+sp_blas_sgemv_t_small(
+    len_t rows,
+    len_t cols,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    const float * const x,
+    float beta,
+    float * const y);
+
+
+/*
+ * Rank-1 update A += x*t^T with contiguous x and t, where t already holds
+ * alpha * y. The rows are taken 32 at a time, and that part of x is kept
+ * in registers while it is added into each column.
+ */
+void
+sp_blas_sger_inc1(
+    len_t rows,
+    len_t cols,
+    const float * const x,
+    const float * const t,
+    float * const A,
+    len_t lda);
+
+
+/*
+ * Single pass over a block M of a symmetric matrix that is stored once but
+ * used twice: y_r += alpha*M*x_c and y_c += alpha*M^T*x_r, all vectors
+ * contiguous. y_r and y_c must not overlap.
+ */
+void
+sp_blas_ssymv_panel_inc1(
+    len_t rows,
+    len_t cols,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    const float * const x_r,
+    const float * const x_c,
+    float * const y_r,
+    float * const y_c);
+
+
+/*
+ * sgemv for any increments, on the calling thread. Strided vectors are
+ * packed in blocks of SP_SGEMV_ROW_BLOCK and handed to the dispatched
+ * unit-stride kernels. Unlike sp_blas_sgemv, alpha = 0 is not a special
+ * case.
+ */
+void
+sp_blas_sgemv_n_incxy(
+    len_t rows,
+    len_t cols,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    const float * const x,
+    len_t inc_x,
+    float beta,
+    float * const y,
+    len_t inc_y);
+
+
+void
+sp_blas_sgemv_t_incxy(
+    len_t rows,
+    len_t cols,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    const float * const x,
+    len_t inc_x,
+    float beta,
+    float * const y,
+    len_t inc_y);
+
+
+/* sgemv split across the thread pool, with alpha != 0. */
+void
+sp_blas_sgemv_parallel(
+    bool is_trans,
+    len_t rows,
+    len_t cols,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    const float * const x,
+    len_t inc_x,
+    float beta,
+    float * const y,
+    len_t inc_y);
+
+
+/*
+ * y = beta*y for the level 2 routines. A zero beta stores zeros, so NaN in
+ * y is cleared.
+ */
+void
+sp_blas_scale_y(
+    len_t len_y,
+    float beta,
+    float * const y,
+    len_t inc_y);
+
+
+#endif
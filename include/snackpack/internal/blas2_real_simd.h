@@ -0,0 +1,133 @@
+#ifndef _SNACKPACK_INTERNAL_BLAS2_REAL_SIMD_H_
+#define _SNACKPACK_INTERNAL_BLAS2_REAL_SIMD_H_
+
+#include "snackpack/snackpack.h"
+#include "snackpack/internal/blas2_real_internal.h"
+
+
+/*
+ * Hand-vectorized level 2 kernels. As with blas1_real_simd.h, each
+ * instruction set is compiled in its own source file and the kernels are
+ * reached through the dispatch table. The portable kernels in
+ * blas2_real_internal.c are the reference implementation.
+ */
+
+
+#ifdef SP_HAVE_X86_KERNELS
+
+/* AVX2 + FMA kernels */
+
+void
+sp_blas_sgemv_n_inc1_avx2(
+    len_t rows,
+    len_t cols,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    const float * const x,
+    len_t inc_x,
+    float beta,
+    float * const y);
+
+
+void
+sp_blas_sgemv_t_inc1_avx2(
+    len_t rows,
+    len_t cols,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    const float * const x,
+    float beta,
+    float * const y,
+    len_t inc_y);
+
+
+void
+sp_blas_sgemv_n_small_avx2(
+    len_t rows,
+    len_t cols,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    const float * const x,
+    float beta,
+    float * const y);
+
+
+void
+sp_blas_sgemv_t_small_avx2(
+    len_t rows,
+    len_t cols,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    const float * const x,
+    float beta,
+    float * const y);
+
+
+void
+sp_blas_sger_inc1_avx2(
+    len_t rows,
+    len_t cols,
+    const float * const x,
+    const float * const t,
+    float * const A,
+    len_t lda);
+
+
+void
+sp_blas_ssymv_panel_inc1_avx2(
+    len_t rows,
+    len_t cols,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    const float * const x_r,
+    const float * const x_c,
+    float * const y_r,
+    float * const y_c);
+
+
+/* AVX-512F kernels */
+
+void
+sp_blas_sgemv_n_inc1_avx512(
+    len_t rows,
+    len_t cols,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    const float * const x,
+    len_t inc_x,
+    float beta,
+    float * const y);
+
+
+void
+sp_blas_sgemv_t_inc1_avx512(
+    len_t rows,
+    len_t cols,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    const float * const x,
+    float beta,
+    float * const y,
+    len_t inc_y);
+
+
+void
+sp_blas_sger_inc1_avx512(
+    len_t rows,
+    len_t cols,
+    const float * const x,
+    const float * const t,
+    float * const A,
+    len_t lda);
+
+#endif
+
+
+#endif
@@ -0,0 +1,82 @@
+#ifndef _SNACKPACK_INTERNAL_BLAS3_REAL_INTERNAL_H_
+#define _SNACKPACK_INTERNAL_BLAS3_REAL_INTERNAL_H_
+
+#include "snackpack/snackpack.h"
+
+
+/*
+ * Cache blocking for sgemm. A kc x nc panel of B is packed once and shared
+ * by all threads. It should fit in L3, and each nr-wide sliver of it in L1.
+ * Each thread packs an mc x kc block of A that stays in L2. The packed
+ * panels are kept in per-thread heap buffers of up to SP_SGEMM_KC *
+ * SP_SGEMM_NC floats (768 KiB) for the calling thread and SP_SGEMM_MC *
+ * SP_SGEMM_KC floats (192 KiB) for each thread running the macro-kernel.
+ * SP_SGEMM_MC must be a multiple of every kernel's mr and SP_SGEMM_NC a
+ * multiple of every kernel's nr.
+ */
+#ifndef SP_SGEMM_KC
+#define SP_SGEMM_KC (256)
+#endif
+
+#ifndef SP_SGEMM_MC
+#define SP_SGEMM_MC (192)
+#endif
+
+#ifndef SP_SGEMM_NC
+#define SP_SGEMM_NC (768)
+#endif
+
+
+/* Largest tile of C computed by any micro-kernel. */
+#define SP_SGEMM_MAX_MR (32)
+#define SP_SGEMM_MAX_NR (12)
+
+
+/*
+ * Work (m * n * k) below which sgemm runs on the calling thread. Above it,
+ * the rows of C are split so that every thread gets a block of A.
+ */
+#ifndef SP_SGEMM_PARALLEL_MIN
+#define SP_SGEMM_PARALLEL_MIN (1 << 18)
+#endif
+
+
+/*
+ * Blocking for strsm. The diagonal blocks of A are SP_STRSM_BLOCK square
+ * and are inverted into a per-thread heap buffer; the matching block of
+ * right-hand sides is copied SP_STRSM_RHS at a time so that it can be
+ * multiplied by the inverse with sgemm.
+ */
+#ifndef SP_STRSM_BLOCK
+#define SP_STRSM_BLOCK (64)
+#endif
+
+#ifndef SP_STRSM_RHS
+#define SP_STRSM_RHS (256)
+#endif
+
+
+/* Tile size of the reference micro-kernel. */
+#define SP_SGEMM_MR (8)
+#define SP_SGEMM_NR (4)
+
+
+/*
+ * sgemm micro-kernel: C = alpha*A*B + beta*C for one mr x nr tile of C,
+ * where A is a packed mr x k sliver (each column of mr entries contiguous)
+ * and B is a packed k x nr sliver (each row of nr entries contiguous).
+ * beta == 0 ignores the old C. The result is alpha times the accumulated
+ * product, with beta*C added by a fused multiply-add.
+ */
+void
+sp_blas_sgemm_kernel(
+    len_t k,
+    float alpha,
+    const float * const A,
+    const float * const B,
+    float beta,
+    float * const C,
+    len_t ldc);
+
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef _SNACKPACK_INTERNAL_BLAS3_REAL_SIMD_H_
+#define _SNACKPACK_INTERNAL_BLAS3_REAL_SIMD_H_
+
+#include "snackpack/snackpack.h"
+#include "snackpack/internal/blas3_real_internal.h"
+
+
+/*
+ * Hand-vectorized sgemm micro-kernels, one per instruction set, with the
+ * same contract as sp_blas_sgemm_kernel. The tile is as large as the
+ * register file allows: mr is two vectors of C, and nr is the number of
+ * columns that still leaves registers for the loads of A and the broadcast
+ * of B.
+ */
+
+
+#ifdef SP_HAVE_X86_KERNELS
+
+/* AVX2 + FMA kernel: 16 x 6 tile, 12 accumulators */
+
+#define SP_SGEMM_MR_AVX2 (16)
+#define SP_SGEMM_NR_AVX2 (6)
+
+void
+sp_blas_sgemm_kernel_avx2(
+    len_t k,
+    float alpha,
+    const float * const A,
+    const float * const B,
+    float beta,
+    float * const C,
+    len_t ldc);
+
+
+/* AVX-512F kernel: 32 x 12 tile, 24 accumulators */
+
+#define SP_SGEMM_MR_AVX512 (32)
+#define SP_SGEMM_NR_AVX512 (12)
+
+void
+sp_blas_sgemm_kernel_avx512(
+    len_t k,
+    float alpha,
+    const float * const A,
+    const float * const B,
+    float beta,
+    float * const C,
+    len_t ldc);
+
+#endif
+
+
+#endif
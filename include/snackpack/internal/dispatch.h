@@ -0,0 +1,168 @@
+#ifndef _SNACKPACK_INTERNAL_DISPATCH_H_
+#define _SNACKPACK_INTERNAL_DISPATCH_H_
+
+#include "snackpack/snackpack.h"
+
+
+/*
+ * Table of the kernels that have instruction-set specific variants. The
+ * public wrappers call through sp_kernels, which is filled in once when the
+ * library is loaded (see dispatch.c), so there is no per-call CPU probing.
+ */
+typedef struct {
+
+    /* Name of the variant, as accepted by SNACKPACK_ARCH. */
+    const char * name;
+
+    float (*sasum_inc1)(
+        len_t n,
+        const float * const x);
+
+    void (*saxpy_inc1)(
+        len_t n,
+        float alpha,
+        const float * const x,
+        float * const y);
+
+    float (*sdot_inc1)(
+        len_t n,
+        const float * const x,
+        const float * const y);
+
+    void (*srot_inc1)(
+        len_t n,
+        float * const x,
+        float * const y,
+        float c,
+        float s);
+
+    void (*sscal_inc1)(
+        len_t n,
+        float alpha,
+        float * const x);
+
+    void (*scopy_inc1)(
+        len_t n,
+        const float * const x,
+        float * const y);
+
+    void (*sswap_inc1)(
+        len_t n,
+        float * const x,
+        float * const y);
+
+    float (*snrm2_inc1)(
+        len_t n,
+        const float * const x);
+
+    len_t (*isamax_inc1)(
+        len_t n,
+        const float * const x);
+
+    len_t (*isamin_inc1)(
+        len_t n,
+        const float * const x);
+
+    float (*saxpy_dot_inc1)(
+        len_t n,
+        float alpha,
+        const float * const x,
+        float * const y,
+        const float * const z);
+
+    void (*scopy_scal_inc1)(
+        len_t n,
+        float alpha,
+        const float * const x,
+        float * const y);
+
+    void (*sgemv_n_inc1)(
+        len_t rows,
+        len_t cols,
+        float alpha,
+        const float * const A,
+        len_t lda,
+        const float * const x,
+        len_t inc_x,
+        float beta,
+        float * const y);
+
+    void (*sgemv_t_inc1)(
+        len_t rows,
+        len_t cols,
+        float alpha,
+        const float * const A,
+        len_t lda,
+        const float * const x,
+        float beta,
+        float * const y,
+        len_t inc_y);
+
+    void (*sgemv_n_small)(
+        len_t rows,
+        len_t cols,
+        float alpha,
+        const float * const A,
+        len_t lda,
+        const float * const x,
+        float beta,
+        float * const y);
+
+    void (*sgemv_t_small)(
+        len_t rows,
+        len_t cols,
+        float alpha,
+        const float * const A,
+        len_t lda,
+        const float * const x,
+        float beta,
+        float * const y);
+
+    void (*sger_inc1)(
+        len_t rows,
+        len_t cols,
+        const float * const x,
+        const float * const t,
+        float * const A,
+        len_t lda);
+
+    void (*ssymv_panel_inc1)(
+        len_t rows,
+        len_t cols,
+        float alpha,
+        const float * const A,
+        len_t lda,
+        const float * const x_r,
+        const float * const x_c,
+        float * const y_r,
+        float * const y_c);
+
+    /* sgemm micro-kernel and the mr x nr tile of C that it computes. */
+    len_t sgemm_mr;
+    len_t sgemm_nr;
+    void (*sgemm_kernel)(
+        len_t k,
+        float alpha,
+        const float * const A,
+        const float * const B,
+        float beta,
+        float * const C,
+        len_t ldc);
+
+    /* Sorting network for 16 sp_sort_key values, see sort_internal.h. */
+    void (*sort16)(
+        uint32_t * const keys);
+
+    len_t (*sort_partition)(
+        uint32_t * const keys,
+        len_t n,
+        uint32_t pivot);
+
+} sp_kernel_table;
+
+
+/* The kernels selected for this process. */
+extern sp_kernel_table sp_kernels;
+
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef _SNACKPACK_INTERNAL_SORT_INTERNAL_H_
+#define _SNACKPACK_INTERNAL_SORT_INTERNAL_H_
+
+#include <stdint.h>
+
+#include "snackpack/snackpack.h"
+
+
+/*
+ * The sorts work on unsigned 32-bit keys that order the same way as the
+ * floats they come from: the sign bit of a positive float is set and all
+ * bits of a negative one are flipped, so -0.0 comes right before +0.0.
+ * Flipping all bits of a key reverses the order. The keys overwrite the
+ * floats in place, hence the may_alias type.
+ */
+typedef uint32_t __attribute__((may_alias)) sp_sort_key;
+
+
+/*
+ * Partitions of at most this many keys are finished by the sort16
+ * sorting network, padded with UINT32_MAX.
+ */
+#define SP_SORT_SMALL (16)
+
+
+/*
+ * Arrays at least this long are sorted by an LSD radix sort, which needs a
+ * buffer of n keys from the heap. Shorter arrays, or any array if the
+ * buffer cannot be allocated, are sorted in place by introsort.
+ */
+#ifndef SP_SORT_RADIX_MIN
+#define SP_SORT_RADIX_MIN (2048)
+#endif
+
+
+/*
+ * Arrays at least this long are sorted by a parallel sample sort when more
+ * than one thread is available. The keys are split into
+ * SP_SORT_BUCKETS_PER_THREAD buckets per thread, rounded up to a power of
+ * 2 and at most SP_SORT_MAX_BUCKETS, by splitters taken from a sorted
+ * sample of SP_SORT_OVERSAMPLE keys per bucket.
+ */
+#ifndef SP_SORT_PARALLEL_MIN
+#define SP_SORT_PARALLEL_MIN (1 << 18)
+#endif
+
+#define SP_SORT_BUCKETS_PER_THREAD (4)
+#define SP_SORT_MAX_BUCKETS (1024)
+#define SP_SORT_OVERSAMPLE (32)
+
+
+/*
+ * Sort 16 keys in increasing order with a fixed sorting network: two
+ * 19-comparator networks of 8, then a bitonic merge.
+ */
+void
+sp_sort16(
+    uint32_t * const keys);
+
+
+/*
+ * Reorder n keys so that those below pivot come first, and return how
+ * many there are. The order within each side is unspecified.
+ */
+len_t
+sp_sort_partition(
+    uint32_t * const keys,
+    len_t n,
+    uint32_t pivot);
+
+
+#endif
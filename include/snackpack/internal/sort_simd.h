@@ -0,0 +1,31 @@
+#ifndef _SNACKPACK_INTERNAL_SORT_SIMD_H_
+#define _SNACKPACK_INTERNAL_SORT_SIMD_H_
+
+#include "snackpack/snackpack.h"
+#include "snackpack/internal/sort_internal.h"
+
+
+/*
+ * Hand-vectorized versions of the sort kernels, with the same contracts as
+ * the ones in sort_internal.h. Each layer of comparators in the sorting
+ * networks is one permute, a min, a max and a blend. The partition uses a
+ * table of permutations to pack each block of 8 keys.
+ */
+
+
+#ifdef SP_HAVE_X86_KERNELS
+
+void
+sp_sort16_avx2(
+    uint32_t * const keys);
+
+len_t
+sp_sort_partition_avx2(
+    uint32_t * const keys,
+    len_t n,
+    uint32_t pivot);
+
+#endif
+
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef _SNACKPACK_INTERNAL_THREADPOOL_H_
+#define _SNACKPACK_INTERNAL_THREADPOOL_H_
+
+#include "snackpack/snackpack.h"
+
+
+/* Upper bound on the number of threads, including the calling thread. */
+#ifndef SP_MAX_THREADS
+#define SP_MAX_THREADS (256)
+#endif
+
+
+/*
+ * Body of a parallel loop. Called with a half-open range [begin, end) of
+ * the index space passed to sp_parallel_for.
+ */
+typedef void (*sp_task_fn)(
+    void * arg,
+    len_t begin,
+    len_t end);
+
+
+/*
+ * Run fn over [0, n) on the thread pool and return when all of it is done.
+ *
+ * The range is split into at most sp_get_num_threads() contiguous pieces of
+ * at least grain indices each. The calling thread works on one of them.
+ * Calls made from inside a parallel loop, or while another thread is using
+ * the pool, run fn(arg, 0, n) on the calling thread instead, so this is
+ * always safe to call.
+ */
+void
+sp_parallel_for(
+    len_t n,
+    len_t grain,
+    sp_task_fn fn,
+    void * arg);
+
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef _SNACKPACK_PLAN_H_
+#define _SNACKPACK_PLAN_H_
+
+#include <stdbool.h>
+#include "snackpack/snackpack.h"
+
+
+/*
+ * Execution plans for calls that are repeated with the same shape. Making
+ * a plan checks the arguments and picks the code path and the threading
+ * once; sp_plan_execute then runs it on the given arrays without any
+ * checks.
+ * A plan is read-only after it is made and can be executed from several
+ * threads at once.
+ */
+typedef struct sp_plan sp_plan;
+
+
+sp_plan *
+sp_plan_sgemv(
+    bool is_trans,
+    len_t rows,
+    len_t cols,
+    float alpha,
+    len_t lda,
+    len_t inc_x,
+    float beta,
+    len_t inc_y);
+
+
+sp_plan *
+sp_plan_saxpy(
+    len_t n,
+    float alpha,
+    len_t inc_x,
+    len_t inc_y);
+
+
+sp_plan *
+sp_plan_sdot(
+    len_t n,
+    len_t inc_x,
+    len_t inc_y);
+
+
+sp_plan *
+sp_plan_sscal(
+    len_t n,
+    float alpha,
+    len_t inc_x);
+
+
+sp_plan *
+sp_plan_scopy(
+    len_t n,
+    len_t inc_x,
+    len_t inc_y);
+
+
+float
+sp_plan_execute(
+    const sp_plan * const plan,
+    const float * const A,
+    const float * const x,
+    float * const y);
+
+
+void
+sp_plan_destroy(
+    sp_plan * const plan);
+
+
+#endif
@@ -9,11 +9,41 @@
 #include <stdint.h>
 #endif
 
-// TODO increase this after testing
+/*
+ * len_t is the type of every dimension, increment and index. It is 32 bits
+ * wide unless SP_ILP64 is defined, which is how the snackpack64 library is
+ * built; code linking to that library must define SP_ILP64 as well.
+ *
+ * SP_MAX_DIMENSION is the largest n whose square fits in len_t, so the
+ * product of two dimensions or increments, such as the offset j * lda of a
+ * column, cannot overflow.
+ */
+#ifdef SP_ILP64
+
+typedef int64_t len_t;
+
 #ifndef SP_MAX_DIMENSION
-#define SP_MAX_DIMENSION (10000)
+#define SP_MAX_DIMENSION (INT64_C(3037000499))
 #endif
 
+#else
+
 typedef int32_t len_t;
 
+#ifndef SP_MAX_DIMENSION
+#define SP_MAX_DIMENSION (46340)
+#endif
+
+#endif
+
+/*
+ * Return codes of the LAPACK-style routines. The values match the INFO
+ * argument of the reference implementation.
+ */
+typedef enum {
+    SP_STATUS_OK = 0,
+    SP_STATUS_ERROR = -1,
+    SP_STATUS_INVALID_DIM = -2,
+} SP_STATUS;
+
 #endif
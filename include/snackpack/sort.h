@@ -1,13 +1,57 @@
 #ifndef _SNACKPACK_SORT_H_
 #define _SNACKPACK_SORT_H_
 
+#include <stdbool.h>
 #include "snackpack/snackpack.h"
-#include <math.h>
 
 SP_STATUS
 sp_slasrt(
     char id,
     len_t n,
-    float_t * const d);
+    float * const d);
+
+
+SP_STATUS
+sp_slasrt_perm(
+    char id,
+    len_t n,
+    float * const d,
+    len_t * const perm);
+
+
+SP_STATUS
+sp_slapmt(
+    bool is_forward,
+    len_t rows,
+    len_t n,
+    float * const A,
+    len_t lda,
+    len_t * const perm);
+
+
+SP_STATUS
+sp_slasrt_cols(
+    char id,
+    len_t n,
+    float * const d,
+    len_t rows,
+    float * const A,
+    len_t lda);
+
+
+SP_STATUS
+sp_slasrt_topk(
+    char id,
+    len_t k,
+    len_t n,
+    float * const d);
+
+
+SP_STATUS
+sp_sselect(
+    char id,
+    len_t k,
+    len_t n,
+    float * const d);
 
 #endif
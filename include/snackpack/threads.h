@@ -0,0 +1,22 @@
+#ifndef _SNACKPACK_THREADS_H_
+#define _SNACKPACK_THREADS_H_
+
+#include <stdbool.h>
+#include "snackpack/snackpack.h"
+
+
+void
+sp_set_num_threads(
+    len_t num_threads);
+
+
+len_t
+sp_get_num_threads(void);
+
+
+void
+sp_set_thread_affinity(
+    bool is_pinned);
+
+
+#endif
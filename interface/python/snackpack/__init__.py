@@ -6,7 +6,7 @@ from libloader import LibInterface, pycparsify_headers
 # TODO: Make this platform independent
 _libpath = '../../lib/libsnackpack.dylib'
 
-def load_dll(libpath):
+def load_dll(libpath, header_names, func_prefix):
     # Find the current directory and assume relative locations for binary and
     # headers.
     this_file = inspect.getfile(inspect.currentframe())
@@ -17,13 +17,19 @@ def load_dll(libpath):
 
     # These are a list of headers that have been pushed through the preprocessor
     # with _PYCPARSER_SCAN_ defined. They should be autogenerated by CMake.
-    headers = [
-        '../../include/snackpack/' + 'blas1_real.h'
-    ]
+    headers = ['../../include/snackpack/' + h for h in header_names]
 
     parsed_header = pycparsify_headers(headers, [header_dir])
 
-    return LibInterface(libpath, parsed_header, 'sp_blas_', strip_prefix=True)
+    return LibInterface(libpath, parsed_header, func_prefix, strip_prefix=True)
 
 
-blas = load_dll(_libpath)
+blas = load_dll(
+    _libpath, ['blas1_real.h', 'blas2_real.h', 'batch_real.h', 'blas3_real.h',
+               'blas_err.h'],
+    'sp_blas_')
+lapack = load_dll(_libpath, ['sort.h'], 'sp_')
+plan = load_dll(_libpath, ['plan.h'], 'sp_plan_')
+arch = load_dll(_libpath, ['arch.h'], 'sp_')
+threads = load_dll(_libpath, ['threads.h'], 'sp_')
+error = load_dll(_libpath, ['error.h'], 'sp_')
@@ -6,15 +6,18 @@ def pycparsify_headers(header_list, include_paths):
     """Given some headers, try to clean them up for pycparser.
     """
     includes = ['-I' + i for i in include_paths]
-    pyc_header = ''
-    for header in header_list:
-        # This works for clang on OS X
-        args = ['cpp'] + includes + ['-DPYCPARSER_SCAN', header]
-        cpp = Popen(args, stdout=PIPE)
-        # pycparser doesn't like some preprocessor output, so we scrub any
-        # remaining lines
-        pyc_header += ''.join(
-            l for l in cpp.stdout.readlines() if not l.startswith('#'))
+    # Preprocess all of the headers as one unit so that the include guards
+    # drop the declarations they share. cffi rejects a second copy of an
+    # anonymous enum.
+    source = ''.join('#include "%s"\n' % h for h in header_list)
+    # This works for clang on OS X
+    args = ['cpp'] + includes + ['-DPYCPARSER_SCAN', '-']
+    cpp = Popen(args, stdin=PIPE, stdout=PIPE)
+    output = cpp.communicate(source)[0]
+    # pycparser doesn't like some preprocessor output, so we scrub any
+    # remaining lines
+    pyc_header = ''.join(
+        l for l in output.splitlines(True) if not l.startswith('#'))
     return pyc_header
 
 
@@ -0,0 +1,828 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "snackpack/batch_real.h"
+#include "snackpack/error.h"
+#include "snackpack/internal/blas1_real_internal.h"
+#include "snackpack/internal/blas2_real_internal.h"
+#include "snackpack/internal/dispatch.h"
+#include "snackpack/internal/threadpool.h"
+
+
+/*
+ * Total number of elements touched by a batch (n * batch_count, or
+ * rows * cols * batch_count for sgemv) below which it runs on the calling
+ * thread, and the least work given to each thread above it.
+ */
+#ifndef SP_BATCH_PARALLEL_MIN
+#define SP_BATCH_PARALLEL_MIN (1 << 15)
+#endif
+
+
+/*
+ * Arguments shared by the threads of a batched level 1 call. x and y are
+ * read, out is written.
+ */
+typedef struct batch_args batch_args;
+
+struct batch_args {
+    void (*entry)(const batch_args * p, len_t b);
+    len_t n;
+    float alpha;
+
+    const float * x;
+    const float * const * x_ptr;
+    len_t inc_x;
+    len_t stride_x;
+
+    const float * y;
+    const float * const * y_ptr;
+    len_t inc_y;
+    len_t stride_y;
+
+    float * out;
+    float * const * out_ptr;
+    len_t inc_out;
+    len_t stride_out;
+
+    float * result;
+};
+
+
+/*
+ * Vector of entry b: the b-th pointer of v_ptr if there is a pointer
+ * array, or b * stride elements past v otherwise.
+ */
+static inline const float *
+entry_in(
+    const float * const v,
+    const float * const * const v_ptr,
+    len_t stride,
+    len_t b)
+{
+    return v_ptr != NULL ? v_ptr[b] : v + (int64_t)b * stride;
+}
+
+
+static inline float *
+entry_out(
+    float * const v,
+    float * const * const v_ptr,
+    len_t stride,
+    len_t b)
+{
+    return v_ptr != NULL ? v_ptr[b] : v + (int64_t)b * stride;
+}
+
+
+static void
+batch_task(
+    void * arg,
+    len_t begin,
+    len_t end)
+{
+    const batch_args * p = arg;
+    for (len_t b = begin; b < end; b++) {
+        p->entry(p, b);
+    }
+}
+
+
+/*
+ * Run task over the entries of a batch, each of which touches about work
+ * elements. Large batches are split into contiguous ranges of entries
+ * across the thread pool.
+ */
+static void
+run_batch(
+    sp_task_fn task,
+    void * const args,
+    int64_t work,
+    len_t batch_count)
+{
+    if (work * batch_count < SP_BATCH_PARALLEL_MIN) {
+        task(args, 0, batch_count);
+    } else {
+        sp_parallel_for(batch_count,
+            (len_t)(SP_BATCH_PARALLEL_MIN / work + 1), task, args);
+    }
+}
+
+
+/*
+ * The entries call the kernels directly: the arguments were checked once
+ * for the whole batch, and the strides are the same for every entry.
+ */
+
+
+static void
+sasum_entry(
+    const batch_args * const p,
+    len_t b)
+{
+    const float * x = entry_in(p->x, p->x_ptr, p->stride_x, b);
+    p->result[b] = p->inc_x == 1 ?
+        sp_kernels.sasum_inc1(p->n, x) : sp_blas_sasum_incx(p->n, x, p->inc_x);
+}
+
+
+static void
+saxpy_entry(
+    const batch_args * const p,
+    len_t b)
+{
+    const float * x = entry_in(p->x, p->x_ptr, p->stride_x, b);
+    float * y = entry_out(p->out, p->out_ptr, p->stride_out, b);
+    if (p->inc_x == 1 && p->inc_out == 1) {
+        sp_kernels.saxpy_inc1(p->n, p->alpha, x, y);
+    } else {
+        sp_blas_saxpy_incxy(p->n, p->alpha, x, p->inc_x, y, p->inc_out);
+    }
+}
+
+
+static void
+sdot_entry(
+    const batch_args * const p,
+    len_t b)
+{
+    const float * x = entry_in(p->x, p->x_ptr, p->stride_x, b);
+    const float * y = entry_in(p->y, p->y_ptr, p->stride_y, b);
+    p->result[b] = p->inc_x == 1 && p->inc_y == 1 ?
+        sp_kernels.sdot_inc1(p->n, x, y) :
+        sp_blas_sdot_incxy(p->n, x, p->inc_x, y, p->inc_y);
+}
+
+
+static void
+snrm2_entry(
+    const batch_args * const p,
+    len_t b)
+{
+    const float * x = entry_in(p->x, p->x_ptr, p->stride_x, b);
+    p->result[b] = p->inc_x == 1 ?
+        sp_kernels.snrm2_inc1(p->n, x) : sp_blas_snrm2_incx(p->n, x, p->inc_x);
+}
+
+
+static void
+sscal_entry(
+    const batch_args * const p,
+    len_t b)
+{
+    float * x = entry_out(p->out, p->out_ptr, p->stride_out, b);
+    if (p->inc_out == 1) {
+        sp_kernels.sscal_inc1(p->n, p->alpha, x);
+    } else {
+        sp_blas_sscal_incx(p->n, p->alpha, x, p->inc_out);
+    }
+}
+
+
+/**
+ * Compute the sums of absolute values of a batch of vectors.
+ *
+ * \param[in] n             Length of each vector
+ * \param[in] x             First vector
+ * \param[in] inc_x         Increment (stride) within each vector
+ * \param[in] stride_x      Distance between the first elements of
+ *                          consecutive vectors
+ * \param[out] result       Array of batch_count results
+ * \param[in] batch_count   Number of vectors
+ *
+ * The arguments are checked once for the whole batch. Batches with at
+ * least SP_BATCH_PARALLEL_MIN elements in total are split across the
+ * thread pool.
+ */
+void
+sp_blas_sasum_batch(
+    len_t n,
+    const float * const x,
+    len_t inc_x,
+    len_t stride_x,
+    float * const result,
+    len_t batch_count)
+{
+    SP_ASSERT_VALID_DIM(n);
+    SP_ASSERT_VALID_INC(inc_x);
+    SP_ASSERT_CONDITION(batch_count >= 0, SP_ERROR_INVALID_DIM, batch_count);
+
+    batch_args args = {
+        .entry = sasum_entry,
+        .n = n,
+        .x = x,
+        .inc_x = inc_x,
+        .stride_x = stride_x,
+        .result = result,
+    };
+    run_batch(batch_task, &args, n, batch_count);
+
+fail:
+    return;
+}
+
+
+/**
+ * Same as sp_blas_sasum_batch, but x is an array of batch_count pointers
+ * to the vectors.
+ */
+void
+sp_blas_sasum_batch_ptr(
+    len_t n,
+    const float * const * const x,
+    len_t inc_x,
+    float * const result,
+    len_t batch_count)
+{
+    SP_ASSERT_VALID_DIM(n);
+    SP_ASSERT_VALID_INC(inc_x);
+    SP_ASSERT_CONDITION(batch_count >= 0, SP_ERROR_INVALID_DIM, batch_count);
+
+    batch_args args = {
+        .entry = sasum_entry,
+        .n = n,
+        .x_ptr = x,
+        .inc_x = inc_x,
+        .result = result,
+    };
+    run_batch(batch_task, &args, n, batch_count);
+
+fail:
+    return;
+}
+
+
+/**
+ * Compute y = alpha*x + y for a batch of vector pairs.
+ *
+ * \param[in] n             Length of each vector
+ * \param[in] alpha         Scalar shared by the whole batch
+ * \param[in] x             First x vector
+ * \param[in] inc_x         Increment (stride) within each x
+ * \param[in] stride_x      Distance between consecutive x vectors. May be
+ *                          0 to use the same x for every entry.
+ * \param[in,out] y         First y vector
+ * \param[in] inc_y         Increment (stride) within each y
+ * \param[in] stride_y      Distance between consecutive y vectors
+ * \param[in] batch_count   Number of vector pairs
+ *
+ * The y vectors must not overlap, since entries may be updated in
+ * parallel.
+ */
+void
+sp_blas_saxpy_batch(
+    len_t n,
+    float alpha,
+    const float * const x,
+    len_t inc_x,
+    len_t stride_x,
+    float * const y,
+    len_t inc_y,
+    len_t stride_y,
+    len_t batch_count)
+{
+    SP_ASSERT_VALID_DIM(n);
+    SP_ASSERT_VALID_INC(inc_x);
+    SP_ASSERT_VALID_INC(inc_y);
+    SP_ASSERT_CONDITION(batch_count >= 0, SP_ERROR_INVALID_DIM, batch_count);
+
+    if (alpha == 0.0f) {
+        return;
+    }
+
+    batch_args args = {
+        .entry = saxpy_entry,
+        .n = n,
+        .alpha = alpha,
+        .x = x,
+        .inc_x = inc_x,
+        .stride_x = stride_x,
+        .out = y,
+        .inc_out = inc_y,
+        .stride_out = stride_y,
+    };
+    run_batch(batch_task, &args, n, batch_count);
+
+fail:
+    return;
+}
+
+
+/**
+ * Same as sp_blas_saxpy_batch, but x and y are arrays of batch_count
+ * pointers to the vectors.
+ */
+void
+sp_blas_saxpy_batch_ptr(
+    len_t n,
+    float alpha,
+    const float * const * const x,
+    len_t inc_x,
+    float * const * const y,
+    len_t inc_y,
+    len_t batch_count)
+{
+    SP_ASSERT_VALID_DIM(n);
+    SP_ASSERT_VALID_INC(inc_x);
+    SP_ASSERT_VALID_INC(inc_y);
+    SP_ASSERT_CONDITION(batch_count >= 0, SP_ERROR_INVALID_DIM, batch_count);
+
+    if (alpha == 0.0f) {
+        return;
+    }
+
+    batch_args args = {
+        .entry = saxpy_entry,
+        .n = n,
+        .alpha = alpha,
+        .x_ptr = x,
+        .inc_x = inc_x,
+        .out_ptr = y,
+        .inc_out = inc_y,
+    };
+    run_batch(batch_task, &args, n, batch_count);
+
+fail:
+    return;
+}
+
+
+/**
+ * Compute the dot products of a batch of vector pairs.
+ *
+ * \param[in] n             Length of each vector
+ * \param[in] x             First x vector
+ * \param[in] inc_x         Increment (stride) within each x
+ * \param[in] stride_x      Distance between consecutive x vectors. May be
+ *                          0 to use the same x for every entry.
+ * \param[in] y             First y vector
+ * \param[in] inc_y         Increment (stride) within each y
+ * \param[in] stride_y      Distance between consecutive y vectors. May be
+ *                          0 to use the same y for every entry.
+ * \param[out] result       Array of batch_count dot products
+ * \param[in] batch_count   Number of vector pairs
+ */
+void
+sp_blas_sdot_batch(
+    len_t n,
+    const float * const x,
+    len_t inc_x,
+    len_t stride_x,
+    const float * const y,
+    len_t inc_y,
+    len_t stride_y,
+    float * const result,
+    len_t batch_count)
+{
+    SP_ASSERT_VALID_DIM(n);
+    SP_ASSERT_VALID_INC(inc_x);
+    SP_ASSERT_VALID_INC(inc_y);
+    SP_ASSERT_CONDITION(batch_count >= 0, SP_ERROR_INVALID_DIM, batch_count);
+
+    batch_args args = {
+        .entry = sdot_entry,
+        .n = n,
+        .x = x,
+        .inc_x = inc_x,
+        .stride_x = stride_x,
+        .y = y,
+        .inc_y = inc_y,
+        .stride_y = stride_y,
+        .result = result,
+    };
+    run_batch(batch_task, &args, n, batch_count);
+
+fail:
+    return;
+}
+
+
+/**
+ * Same as sp_blas_sdot_batch, but x and y are arrays of batch_count
+ * pointers to the vectors.
+ */
+void
+sp_blas_sdot_batch_ptr(
+    len_t n,
+    const float * const * const x,
+    len_t inc_x,
+    const float * const * const y,
+    len_t inc_y,
+    float * const result,
+    len_t batch_count)
+{
+    SP_ASSERT_VALID_DIM(n);
+    SP_ASSERT_VALID_INC(inc_x);
+    SP_ASSERT_VALID_INC(inc_y);
+    SP_ASSERT_CONDITION(batch_count >= 0, SP_ERROR_INVALID_DIM, batch_count);
+
+    batch_args args = {
+        .entry = sdot_entry,
+        .n = n,
+        .x_ptr = x,
+        .inc_x = inc_x,
+        .y_ptr = y,
+        .inc_y = inc_y,
+        .result = result,
+    };
+    run_batch(batch_task, &args, n, batch_count);
+
+fail:
+    return;
+}
+
+
+/**
+ * Compute the two-norms of a batch of vectors.
+ *
+ * \param[in] n             Length of each vector
+ * \param[in] x             First vector
+ * \param[in] inc_x         Increment (stride) within each vector
+ * \param[in] stride_x      Distance between consecutive vectors
+ * \param[out] result       Array of batch_count norms
+ * \param[in] batch_count   Number of vectors
+ */
+void
+sp_blas_snrm2_batch(
+    len_t n,
+    const float * const x,
+    len_t inc_x,
+    len_t stride_x,
+    float * const result,
+    len_t batch_count)
+{
+    SP_ASSERT_VALID_DIM(n);
+    SP_ASSERT_VALID_INC(inc_x);
+    SP_ASSERT_CONDITION(batch_count >= 0, SP_ERROR_INVALID_DIM, batch_count);
+
+    batch_args args = {
+        .entry = snrm2_entry,
+        .n = n,
+        .x = x,
+        .inc_x = inc_x,
+        .stride_x = stride_x,
+        .result = result,
+    };
+    run_batch(batch_task, &args, n, batch_count);
+
+fail:
+    return;
+}
+
+
+/**
+ * Same as sp_blas_snrm2_batch, but x is an array of batch_count pointers
+ * to the vectors.
+ */
+void
+sp_blas_snrm2_batch_ptr(
+    len_t n,
+    const float * const * const x,
+    len_t inc_x,
+    float * const result,
+    len_t batch_count)
+{
+    SP_ASSERT_VALID_DIM(n);
+    SP_ASSERT_VALID_INC(inc_x);
+    SP_ASSERT_CONDITION(batch_count >= 0, SP_ERROR_INVALID_DIM, batch_count);
+
+    batch_args args = {
+        .entry = snrm2_entry,
+        .n = n,
+        .x_ptr = x,
+        .inc_x = inc_x,
+        .result = result,
+    };
+    run_batch(batch_task, &args, n, batch_count);
+
+fail:
+    return;
+}
+
+
+/**
+ * Scale a batch of vectors by the same scalar.
+ *
+ * \param[in] n             Length of each vector
+ * \param[in] alpha         Scalar to apply
+ * \param[in,out] x         First vector
+ * \param[in] inc_x         Increment (stride) within each vector
+ * \param[in] stride_x      Distance between consecutive vectors
+ * \param[in] batch_count   Number of vectors
+ */
+void
+sp_blas_sscal_batch(
+    len_t n,
+    float alpha,
+    float * const x,
+    len_t inc_x,
+    len_t stride_x,
+    len_t batch_count)
+{
+    SP_ASSERT_VALID_DIM(n);
+    SP_ASSERT_VALID_INC(inc_x);
+    SP_ASSERT_CONDITION(batch_count >= 0, SP_ERROR_INVALID_DIM, batch_count);
+
+    batch_args args = {
+        .entry = sscal_entry,
+        .n = n,
+        .alpha = alpha,
+        .out = x,
+        .inc_out = inc_x,
+        .stride_out = stride_x,
+    };
+    run_batch(batch_task, &args, n, batch_count);
+
+fail:
+    return;
+}
+
+
+/**
+ * Same as sp_blas_sscal_batch, but x is an array of batch_count pointers
+ * to the vectors.
+ */
+void
+sp_blas_sscal_batch_ptr(
+    len_t n,
+    float alpha,
+    float * const * const x,
+    len_t inc_x,
+    len_t batch_count)
+{
+    SP_ASSERT_VALID_DIM(n);
+    SP_ASSERT_VALID_INC(inc_x);
+    SP_ASSERT_CONDITION(batch_count >= 0, SP_ERROR_INVALID_DIM, batch_count);
+
+    batch_args args = {
+        .entry = sscal_entry,
+        .n = n,
+        .alpha = alpha,
+        .out_ptr = x,
+        .inc_out = inc_x,
+    };
+    run_batch(batch_task, &args, n, batch_count);
+
+fail:
+    return;
+}
+
+
+/* An sgemv kernel for one entry of a batch. alpha is nonzero. */
+typedef void (*sgemv_fn)(
+    len_t rows,
+    len_t cols,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    const float * const x,
+    len_t inc_x,
+    float beta,
+    float * const y,
+    len_t inc_y);
+
+
+/*
+ * Shape-specialized kernels from the dispatch table, for matrices whose
+ * row count satisfies SP_SGEMV_IS_SMALL when both increments are 1. They
+ * are picked once per batch; other shapes go through the same packing and
+ * dispatched kernels as sp_blas_sgemv.
+ */
+static void
+sgemv_n_small(
+    len_t rows,
+    len_t cols,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    const float * const x,
+    len_t inc_x,
+    float beta,
+    float * const y,
+    len_t inc_y)
+{
+    (void)inc_x;
+    (void)inc_y;
+    sp_kernels.sgemv_n_small(rows, cols, alpha, A, lda, x, beta, y);
+}
+
+
+static void
+sgemv_t_small(
+    len_t rows,
+    len_t cols,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    const float * const x,
+    len_t inc_x,
+    float beta,
+    float * const y,
+    len_t inc_y)
+{
+    (void)inc_x;
+    (void)inc_y;
+    sp_kernels.sgemv_t_small(rows, cols, alpha, A, lda, x, beta, y);
+}
+
+
+static sgemv_fn
+select_sgemv(
+    bool is_trans,
+    len_t rows,
+    len_t inc_x,
+    len_t inc_y)
+{
+    if (inc_x == 1 && inc_y == 1 && SP_SGEMV_IS_SMALL(rows)) {
+        return is_trans ? sgemv_t_small : sgemv_n_small;
+    }
+    return is_trans ? sp_blas_sgemv_t_incxy : sp_blas_sgemv_n_incxy;
+}
+
+
+/* Arguments shared by the threads of a batched sgemv. */
+typedef struct {
+    sgemv_fn kernel;
+    len_t rows;
+    len_t cols;
+    len_t len_y;
+    float alpha;
+    float beta;
+
+    const float * A;
+    const float * const * A_ptr;
+    len_t lda;
+    len_t stride_A;
+
+    const float * x;
+    const float * const * x_ptr;
+    len_t inc_x;
+    len_t stride_x;
+
+    float * y;
+    float * const * y_ptr;
+    len_t inc_y;
+    len_t stride_y;
+} sgemv_batch_args;
+
+
+static void
+sgemv_batch_task(
+    void * arg,
+    len_t begin,
+    len_t end)
+{
+    const sgemv_batch_args * p = arg;
+
+    for (len_t b = begin; b < end; b++) {
+        float * y = entry_out(p->y, p->y_ptr, p->stride_y, b);
+
+        /* If alpha is 0, all that's left is beta * y, as in sgemv. */
+        if (p->alpha == 0.0f) {
+            if (p->inc_y == 1) {
+                sp_kernels.sscal_inc1(p->len_y, p->beta, y);
+            } else {
+                sp_blas_sscal_incx(p->len_y, p->beta, y, p->inc_y);
+            }
+            continue;
+        }
+
+        p->kernel(p->rows, p->cols, p->alpha,
+            entry_in(p->A, p->A_ptr, p->stride_A, b), p->lda,
+            entry_in(p->x, p->x_ptr, p->stride_x, b), p->inc_x,
+            p->beta, y, p->inc_y);
+    }
+}
+
+
+/**
+ * Compute a batch of general matrix-vector products.
+ *
+ * Performs one of the operations
+ *
+ *      y_b = alpha*A_b*x_b + beta*y_b
+ * or
+ *      y_b = alpha*A_b^T*x_b + beta*y_b
+ *
+ * for b = 0, ..., batch_count - 1, with the same shape, scalars and
+ * transpose flag for every entry.
+ *
+ * \param[in] is_trans      True to take the transpose of each A_b
+ * \param[in] rows          Number of rows in each A_b
+ * \param[in] cols          Number of columns in each A_b
+ * \param[in] alpha         Scalar alpha
+ * \param[in] A             First matrix
+ * \param[in] lda           Leading dimension of each A_b - must be at
+ *                          least max(1, rows)
+ * \param[in] stride_A      Distance between consecutive matrices. May be 0
+ *                          to use the same matrix for every entry.
+ * \param[in] x             First x vector
+ * \param[in] inc_x         Increment (stride) within each x_b
+ * \param[in] stride_x      Distance between consecutive x vectors. May be
+ *                          0 to use the same x for every entry.
+ * \param[in] beta          Scalar beta
+ * \param[in,out] y         First y vector, stores results
+ * \param[in] inc_y         Increment (stride) within each y_b
+ * \param[in] stride_y      Distance between consecutive y vectors
+ * \param[in] batch_count   Number of products
+ *
+ * The arguments are checked and the kernel is picked once for the whole
+ * batch. Matrices with 4, 8 or 16 rows and unit increments use kernels
+ * specialized for that size. The y vectors must not overlap, since entries
+ * may be computed in parallel.
+ */
+void
+sp_blas_sgemv_batch(
+    bool is_trans,
+    len_t rows,
+    len_t cols,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    len_t stride_A,
+    const float * const x,
+    len_t inc_x,
+    len_t stride_x,
+    float beta,
+    float * const y,
+    len_t inc_y,
+    len_t stride_y,
+    len_t batch_count)
+{
+    SP_ASSERT_VALID_DIM(rows);
+    SP_ASSERT_VALID_DIM(cols);
+    SP_ASSERT_VALID_LDA(lda, rows);
+    SP_ASSERT_VALID_INC(inc_x);
+    SP_ASSERT_VALID_INC(inc_y);
+    SP_ASSERT_CONDITION(batch_count >= 0, SP_ERROR_INVALID_DIM, batch_count);
+
+    sgemv_batch_args args = {
+        .kernel = select_sgemv(is_trans, rows, inc_x, inc_y),
+        .rows = rows,
+        .cols = cols,
+        .len_y = is_trans ? cols : rows,
+        .alpha = alpha,
+        .beta = beta,
+        .A = A,
+        .lda = lda,
+        .stride_A = stride_A,
+        .x = x,
+        .inc_x = inc_x,
+        .stride_x = stride_x,
+        .y = y,
+        .inc_y = inc_y,
+        .stride_y = stride_y,
+    };
+    run_batch(sgemv_batch_task, &args, (int64_t)rows * cols, batch_count);
+
+fail:
+    return;
+}
+
+
+/**
+ * Same as sp_blas_sgemv_batch, but A, x and y are arrays of batch_count
+ * pointers to the matrices and vectors.
+ */
+void
+sp_blas_sgemv_batch_ptr(
+    bool is_trans,
+    len_t rows,
+    len_t cols,
+    float alpha,
+    const float * const * const A,
+    len_t lda,
+    const float * const * const x,
+    len_t inc_x,
+    float beta,
+    float * const * const y,
+    len_t inc_y,
+    len_t batch_count)
+{
+    SP_ASSERT_VALID_DIM(rows);
+    SP_ASSERT_VALID_DIM(cols);
+    SP_ASSERT_VALID_LDA(lda, rows);
+    SP_ASSERT_VALID_INC(inc_x);
+    SP_ASSERT_VALID_INC(inc_y);
+    SP_ASSERT_CONDITION(batch_count >= 0, SP_ERROR_INVALID_DIM, batch_count);
+
+    sgemv_batch_args args = {
+        .kernel = select_sgemv(is_trans, rows, inc_x, inc_y),
+        .rows = rows,
+        .cols = cols,
+        .len_y = is_trans ? cols : rows,
+        .alpha = alpha,
+        .beta = beta,
+        .A_ptr = A,
+        .lda = lda,
+        .x_ptr = x,
+        .inc_x = inc_x,
+        .y_ptr = y,
+        .inc_y = inc_y,
+    };
+    run_batch(sgemv_batch_task, &args, (int64_t)rows * cols, batch_count);
+
+fail:
+    return;
+}
@@ -1,4 +1,5 @@
 #include <float.h>
+#include <math.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include <stdio.h>
@@ -7,6 +8,48 @@
 #include "snackpack/blas1_real.h"
 #include "snackpack/error.h"
 #include "snackpack/internal/blas1_real_internal.h"
+#include "snackpack/internal/blas1_real_reduce.h"
+#include "snackpack/internal/dispatch.h"
+
+
+/*
+ * The SIMD isamax/isamin kernels keep indices in 32-bit lanes. In the
+ * ILP64 build, longer vectors are searched in pieces of this length.
+ */
+#ifndef SP_IAMAX_BLOCK
+#define SP_IAMAX_BLOCK (1 << 30)
+#endif
+
+
+/* isamax (or isamin) for inc_x = 1 */
+static len_t
+iamax_inc1(
+    len_t n,
+    const float * const x,
+    bool is_min)
+{
+    len_t (*kernel)(len_t, const float * const) =
+        is_min ? sp_kernels.isamin_inc1 : sp_kernels.isamax_inc1;
+
+#ifdef SP_ILP64
+    if (n > SP_IAMAX_BLOCK) {
+        len_t best = 0;
+        float b = 0.0f;
+        for (len_t i = 0; i < n; i += SP_IAMAX_BLOCK) {
+            len_t len = n - i < SP_IAMAX_BLOCK ? n - i : SP_IAMAX_BLOCK;
+            len_t j = i + kernel(len, x + i);
+            float a = fabsf(x[j]);
+            if (i == 0 || (is_min ? a < b : a > b)) {
+                b = a;
+                best = j;
+            }
+        }
+        return best;
+    }
+#endif
+
+    return kernel(n, x);
+}
 
 
 /**
@@ -16,6 +59,11 @@
  * \param[in] x         Pointer to the first element of the vector
  * \param[in] inc_x     Increment (stride) to sum over
  * \returns             Sum of absolute values of the vector elements
+ *
+ * Vectors with at least SP_REDUCE_PARALLEL_MIN elements are summed in
+ * chunks on the thread pool, and the chunk sums are added in a fixed order.
+ * The result then depends only on n and the data, not on the number of
+ * threads or the instruction set in use.
  */
 float
 sp_blas_sasum(
@@ -28,8 +76,10 @@ sp_blas_sasum(
     SP_ASSERT_VALID_DIM(n);
     SP_ASSERT_VALID_INC(inc_x);
 
-    if (inc_x == 1) {
-        result = sp_blas_sasum_inc1(n, x);
+    if (n >= SP_REDUCE_PARALLEL_MIN) {
+        result = sp_blas_sasum_reduce(n, x, inc_x);
+    } else if (inc_x == 1) {
+        result = sp_kernels.sasum_inc1(n, x);
     } else {
         result = sp_blas_sasum_incx(n, x, inc_x);
     }
@@ -68,7 +118,7 @@ sp_blas_saxpy(
     SP_ASSERT_VALID_INC(inc_y);
 
     if (inc_x == 1 && inc_y == 1) {
-        sp_blas_saxpy_inc1(n, alpha, x, y);
+        sp_kernels.saxpy_inc1(n, alpha, x, y);
     } else {
         sp_blas_saxpy_incxy(n, alpha, x, inc_x, y, inc_y);
     }
@@ -86,6 +136,8 @@ fail:
  * \param[in] inc_x         Increment (stride) of x.
  * \param[in] y             Array of dimension at least (1 + (n-1)*abs(inc_x))
  * \param[in] inc_y         Increment (stride) of y.
+ *
+ * Long vectors are reduced on the thread pool, as in sp_blas_sasum.
  */
 float
 sp_blas_sdot(
@@ -100,8 +152,10 @@ sp_blas_sdot(
     SP_ASSERT_VALID_INC(inc_x);
     SP_ASSERT_VALID_INC(inc_y);
 
-    if (inc_x == 1 && inc_y == 1) {
-        result = sp_blas_sdot_inc1(n, x, y);
+    if (n >= SP_REDUCE_PARALLEL_MIN) {
+        result = sp_blas_sdot_reduce(n, x, inc_x, y, inc_y);
+    } else if (inc_x == 1 && inc_y == 1) {
+        result = sp_kernels.sdot_inc1(n, x, y);
     } else {
         result = sp_blas_sdot_incxy(n, x, inc_x, y, inc_y);
     }
@@ -193,7 +247,7 @@ sp_blas_srot(
     SP_ASSERT_VALID_INC(inc_y);
 
     if (inc_x == 1 && inc_y == 1) {
-        sp_blas_srot_inc1(n, x, y, c, s);
+        sp_kernels.srot_inc1(n, x, y, c, s);
     } else {
         sp_blas_srot_incxy(n, x, inc_x, y, inc_y, c, s);
     }
@@ -225,7 +279,7 @@ sp_blas_sswap(
     SP_ASSERT_VALID_INC(inc_y);
 
     if (inc_x == 1 && inc_y == 1) {
-        sp_blas_sswap_inc1(n, x, y);
+        sp_kernels.sswap_inc1(n, x, y);
     } else {
         sp_blas_sswap_incxy(n, x, inc_x, y, inc_y);
     }
@@ -257,7 +311,7 @@ sp_blas_scopy(
     SP_ASSERT_VALID_INC(inc_y);
 
     if (inc_x == 1 && inc_y == 1) {
-        sp_blas_scopy_inc1(n, x, y);
+        sp_kernels.scopy_inc1(n, x, y);
     } else {
         sp_blas_scopy_incxy(n, x, inc_x, y, inc_y);
     }
@@ -274,6 +328,11 @@ fail:
  * \param[in] x         Pointer to the first element of the vector
  * \param[in] inc_x     Increment (stride) to sum over
  * \returns             Two-norm of the vector elements
+ *
+ * The squares are summed in double precision, which cannot overflow or
+ * underflow for any float input, so unlike the reference BLAS no scaling
+ * is needed. Long vectors are reduced on the thread pool, as in
+ * sp_blas_sasum.
  */
 float
 sp_blas_snrm2(
@@ -288,8 +347,10 @@ sp_blas_snrm2(
 
     if (n == 1) { return fabsf(*x); }
 
-    if (inc_x == 1) {
-        result = sp_blas_snrm2_inc1(n, x);
+    if (n >= SP_REDUCE_PARALLEL_MIN) {
+        result = sp_blas_snrm2_reduce(n, x, inc_x);
+    } else if (inc_x == 1) {
+        result = sp_kernels.snrm2_inc1(n, x);
     } else {
         result = sp_blas_snrm2_incx(n, x, inc_x);
     }
@@ -329,7 +390,7 @@ sp_blas_sscal(
     SP_ASSERT_VALID_INC(inc_x);
 
     if (inc_x == 1) {
-        sp_blas_sscal_inc1(n, alpha, x);
+        sp_kernels.sscal_inc1(n, alpha, x);
     } else {
         sp_blas_sscal_incx(n, alpha, x, inc_x);
     }
@@ -359,7 +420,7 @@ sp_blas_isamax(
     SP_ASSERT_VALID_INC(inc_x);
 
     if (inc_x == 1) {
-        result = sp_blas_isamax_inc1(n, x);
+        result = iamax_inc1(n, x, false);
     } else {
         result = sp_blas_isamax_incx(n, x, inc_x);
     }
@@ -389,7 +450,7 @@ sp_blas_isamin(
     SP_ASSERT_VALID_INC(inc_x);
 
     if (inc_x == 1) {
-        result = sp_blas_isamin_inc1(n, x);
+        result = iamax_inc1(n, x, true);
     } else {
         result = sp_blas_isamin_incx(n, x, inc_x);
     }
@@ -399,9 +460,59 @@ fail:
 }
 
 
+/**
+ * Find the element of an array with the largest magnitude, and return its
+ * value as well as its index.
+ *
+ * \param[in] n         Number of elements to search
+ * \param[in] x         Array of dimension at least (1 + (n-1)*abs(inc_x))
+ * \param[in] inc_x     Increment (stride) for the elements of x
+ * \param[out] value    The element at the returned index, with its sign
+ * \returns             Same as sp_blas_isamax
+ *
+ * This saves a pivot search from loading the pivot again.
+ */
+len_t
+sp_blas_isamax_value(
+    len_t n,
+    const float * const x,
+    len_t inc_x,
+    float * const value)
+{
+    len_t result = sp_blas_isamax(n, x, inc_x);
+    *value = n > 0 ? x[result] : 0.0f;
+    return result;
+}
+
+
+/**
+ * Find the element of an array with the smallest magnitude, and return its
+ * value as well as its index.
+ *
+ * \param[in] n         Number of elements to search
+ * \param[in] x         Array of dimension at least (1 + (n-1)*abs(inc_x))
+ * \param[in] inc_x     Increment (stride) for the elements of x
+ * \param[out] value    The element at the returned index, with its sign
+ * \returns             Same as sp_blas_isamin
+ */
+len_t
+sp_blas_isamin_value(
+    len_t n,
+    const float * const x,
+    len_t inc_x,
+    float * const value)
+{
+    len_t result = sp_blas_isamin(n, x, inc_x);
+    *value = n > 0 ? x[result] : 0.0f;
+    return result;
+}
+
+
 /**
  * Take the dot product of two single-precision vectors, doing the
  * accumulation in double precision.
+ *
+ * Long vectors are reduced on the thread pool, as in sp_blas_sasum.
  */
 float
 sp_blas_sdsdot(
@@ -418,7 +529,9 @@ sp_blas_sdsdot(
     SP_ASSERT_VALID_INC(inc_x);
     SP_ASSERT_VALID_INC(inc_y);
 
-    if (inc_x == 1 && inc_y == 1) {
+    if (n >= SP_REDUCE_PARALLEL_MIN) {
+        result = sp_blas_sdsdot_reduce(n, sb, x, inc_x, y, inc_y);
+    } else if (inc_x == 1 && inc_y == 1) {
         result = sp_blas_sdsdot_inc1(n, sb, x, y);
     } else {
         result = sp_blas_sdsdot_incxy(n, sb, x, inc_x, y, inc_y);
@@ -429,6 +542,194 @@ fail:
 }
 
 
+/**
+ * Add a multiple of one vector to another and take the dot product of the
+ * result with a third vector.
+ *
+ * Performs the operations
+ *
+ *      y = alpha*x + y
+ *      return y^T*z
+ *
+ * \param[in] n         Number of elements in x, y and z
+ * \param[in] alpha     Scalar to multiply x by
+ * \param[in] x         Array of dimension at least (1 + (n-1)*abs(inc_x))
+ * \param[in] inc_x     Increment (stride) for x
+ * \param[in,out] y     Array of dimension at least (1 + (n-1)*abs(inc_y))
+ * \param[in] inc_y     Increment (stride) for y
+ * \param[in] z         Array of dimension at least (1 + (n-1)*abs(inc_z))
+ * \param[in] inc_z     Increment (stride) for z
+ * \returns             Dot product of the updated y and z
+ *
+ * Each element of y is updated and used for the dot product while it is in
+ * a register, so y is streamed once instead of twice. z may be the same
+ * vector as y. Long vectors are reduced on the thread pool as in
+ * sp_blas_sdot, and give the same result for any number of threads.
+ */
+float
+sp_blas_saxpy_dot(
+    len_t n,
+    float alpha,
+    const float * const x,
+    len_t inc_x,
+    float * const y,
+    len_t inc_y,
+    const float * const z,
+    len_t inc_z)
+{
+    float result = 0.0f;
+
+    SP_ASSERT_VALID_DIM(n);
+    SP_ASSERT_VALID_INC(inc_x);
+    SP_ASSERT_VALID_INC(inc_y);
+    SP_ASSERT_VALID_INC(inc_z);
+
+    /* As in saxpy, alpha = 0 leaves y alone, whatever is in x. */
+    if (alpha == 0.0f) {
+        return sp_blas_sdot(n, y, inc_y, z, inc_z);
+    }
+
+    if (n >= SP_REDUCE_PARALLEL_MIN) {
+        result = sp_blas_saxpy_dot_reduce(
+            n, alpha, x, inc_x, y, inc_y, z, inc_z);
+    } else if (inc_x == 1 && inc_y == 1 && inc_z == 1) {
+        result = sp_kernels.saxpy_dot_inc1(n, alpha, x, y, z);
+    } else {
+        result = sp_blas_saxpy_dot_incxyz(
+            n, alpha, x, inc_x, y, inc_y, z, inc_z);
+    }
+
+fail:
+    return result;
+}
+
+
+/*
+ * Divide x by its norm in double precision, for when the float norm has
+ * no finite float reciprocal: it is subnormal, or x is finite but its norm
+ * overflows float. The sum of squares of floats cannot overflow or
+ * underflow a double. Returns false if x holds an infinity.
+ */
+static bool
+snrm2_scal_double(
+    len_t n,
+    float * const x,
+    len_t inc_x)
+{
+    len_t ix = inc_x < 0 ? (len_t)((1 - n) * inc_x) : 0;
+    double sum = 0.0;
+    for (len_t i = 0; i < n; i++) {
+        sum += (double)x[ix + i * inc_x] * (double)x[ix + i * inc_x];
+    }
+    if (!isfinite(sum)) {
+        return false;
+    }
+
+    double scale = 1.0 / sqrt(sum);
+    for (len_t i = 0; i < n; i++) {
+        x[ix + i * inc_x] = (float)((double)x[ix + i * inc_x] * scale);
+    }
+    return true;
+}
+
+
+/**
+ * Normalize a vector in place.
+ *
+ * \param[in] n         Length of the vector
+ * \param[in,out] x     Vector to normalize
+ * \param[in] inc_x     Increment (stride) of x
+ * \returns             Two-norm of x before it was scaled
+ *
+ * The norm is computed as in sp_blas_snrm2 and x is then multiplied by its
+ * reciprocal. A vector with norm zero is left unchanged. The norm has to
+ * be complete before the first element can be scaled, so this is still
+ * two passes over x, but without a second round of argument checks and
+ * dispatch. If the reciprocal of the norm is not a normal float (the norm
+ * is subnormal, or overflows float although x is finite), x is scaled in
+ * double precision instead.
+ */
+float
+sp_blas_snrm2_scal(
+    len_t n,
+    float * const x,
+    len_t inc_x)
+{
+    float result = 0.0f;
+
+    SP_ASSERT_VALID_DIM(n);
+    SP_ASSERT_VALID_INC(inc_x);
+
+    if (n == 1) {
+        result = fabsf(*x);
+    } else if (n >= SP_REDUCE_PARALLEL_MIN) {
+        result = sp_blas_snrm2_reduce(n, x, inc_x);
+    } else if (inc_x == 1) {
+        result = sp_kernels.snrm2_inc1(n, x);
+    } else {
+        result = sp_blas_snrm2_incx(n, x, inc_x);
+    }
+
+    if (result > 0.0f) {
+        float scale = 1.0f / result;
+        bool is_in_range = isnormal(result) && isnormal(scale);
+        if (!is_in_range && snrm2_scal_double(n, x, inc_x)) {
+            /* x has been scaled. */
+        } else if (inc_x == 1) {
+            sp_kernels.sscal_inc1(n, scale, x);
+        } else {
+            sp_blas_sscal_incx(n, scale, x, inc_x);
+        }
+    }
+
+fail:
+    return result;
+}
+
+
+/**
+ * Copy a scaled vector into another.
+ *
+ * Performs the operation
+ *
+ *      y = alpha*x
+ *
+ * \param[in] n         Number of elements to copy
+ * \param[in] alpha     Scalar to multiply x by
+ * \param[in] x         Array of dimension at least (1 + (n-1)*abs(inc_x))
+ * \param[in] inc_x     Increment (stride) for x
+ * \param[out] y        Array of dimension at least (1 + (n-1)*abs(inc_y))
+ * \param[in] inc_y     Increment (stride) for y
+ *
+ * This is scopy followed by sscal in one pass, so y is written once and
+ * never read. As in sscal, alpha = 0 stores zeros.
+ */
+void
+sp_blas_scopy_scal(
+    len_t n,
+    float alpha,
+    const float * const x,
+    len_t inc_x,
+    float * const y,
+    len_t inc_y)
+{
+    SP_ASSERT_VALID_DIM(n);
+    SP_ASSERT_VALID_INC(inc_x);
+    SP_ASSERT_VALID_INC(inc_y);
+
+    if (alpha == 0.0f) {
+        sp_blas_sscal(n, 0.0f, y, inc_y);
+    } else if (inc_x == 1 && inc_y == 1) {
+        sp_kernels.scopy_scal_inc1(n, alpha, x, y);
+    } else {
+        sp_blas_scopy_scal_incxy(n, alpha, x, inc_x, y, inc_y);
+    }
+
+fail:
+    return;
+}
+
+
 
 #if 0
 
@@ -0,0 +1,564 @@
+/*
+ * AVX2 + FMA versions of the unit-stride level 1 kernels. This file is
+ * compiled with -mavx2 -mfma.
+ */
+#if defined(__AVX2__) && defined(__FMA__)
+
+#include <math.h>
+#include <immintrin.h>
+
+#include "snackpack/snackpack.h"
+#include "snackpack/internal/blas1_real_simd.h"
+
+
+/* Mask with the first rem (< 8) lanes set, for maskload/maskstore. */
+static inline __m256i
+tail_mask(len_t rem)
+{
+    return _mm256_cmpgt_epi32(
+        _mm256_set1_epi32((int)rem),
+        _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+}
+
+
+static inline float
+hsum(__m256 v)
+{
+    __m128 lo = _mm_add_ps(
+        _mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    lo = _mm_add_ps(lo, _mm_movehl_ps(lo, lo));
+    lo = _mm_add_ss(lo, _mm_movehdup_ps(lo));
+    return _mm_cvtss_f32(lo);
+}
+
+
+static inline __m256
+vabs(__m256 v)
+{
+    return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), v);
+}
+
+
+/* sasum for inc_x = 1 */
+float
+sp_blas_sasum_inc1_avx2(
+    len_t n,
+    const float * const x)
+{
+    float tmp = 0.0f;
+    len_t i = 0;
+    len_t head = sp_simd_align_head(x, 32, n);
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    __m256 acc2 = _mm256_setzero_ps();
+    __m256 acc3 = _mm256_setzero_ps();
+
+    for (; i < head; i++) {
+        tmp += fabsf(x[i]);
+    }
+    for (; i + 32 <= n; i += 32) {
+        acc0 = _mm256_add_ps(acc0, vabs(_mm256_load_ps(x + i)));
+        acc1 = _mm256_add_ps(acc1, vabs(_mm256_load_ps(x + i + 8)));
+        acc2 = _mm256_add_ps(acc2, vabs(_mm256_load_ps(x + i + 16)));
+        acc3 = _mm256_add_ps(acc3, vabs(_mm256_load_ps(x + i + 24)));
+    }
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_add_ps(acc0, vabs(_mm256_loadu_ps(x + i)));
+    }
+    if (i < n) {
+        __m256i mask = tail_mask(n - i);
+        acc1 = _mm256_add_ps(acc1, vabs(_mm256_maskload_ps(x + i, mask)));
+    }
+
+    acc0 = _mm256_add_ps(_mm256_add_ps(acc0, acc1), _mm256_add_ps(acc2, acc3));
+    return tmp + hsum(acc0);
+}
+
+
+/* saxpy for inc_x = inc_y = 1 */
+void
+sp_blas_saxpy_inc1_avx2(
+    len_t n,
+    float alpha,
+    const float * const x,
+    float * const y)
+{
+    /* If alpha == 0, nothing to do */
+    if (alpha == 0.0f) {
+        return;
+    }
+
+    len_t i = 0;
+    len_t head = sp_simd_align_head(y, 32, n);
+    __m256 a = _mm256_set1_ps(alpha);
+
+    for (; i < head; i++) {
+        y[i] += alpha * x[i];
+    }
+    for (; i + 32 <= n; i += 32) {
+        __m256 y0 = _mm256_fmadd_ps(
+            a, _mm256_loadu_ps(x + i), _mm256_load_ps(y + i));
+        __m256 y1 = _mm256_fmadd_ps(
+            a, _mm256_loadu_ps(x + i + 8), _mm256_load_ps(y + i + 8));
+        __m256 y2 = _mm256_fmadd_ps(
+            a, _mm256_loadu_ps(x + i + 16), _mm256_load_ps(y + i + 16));
+        __m256 y3 = _mm256_fmadd_ps(
+            a, _mm256_loadu_ps(x + i + 24), _mm256_load_ps(y + i + 24));
+        _mm256_store_ps(y + i, y0);
+        _mm256_store_ps(y + i + 8, y1);
+        _mm256_store_ps(y + i + 16, y2);
+        _mm256_store_ps(y + i + 24, y3);
+    }
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(y + i, _mm256_fmadd_ps(
+            a, _mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i)));
+    }
+    if (i < n) {
+        __m256i mask = tail_mask(n - i);
+        __m256 yt = _mm256_fmadd_ps(
+            a, _mm256_maskload_ps(x + i, mask),
+            _mm256_maskload_ps(y + i, mask));
+        _mm256_maskstore_ps(y + i, mask, yt);
+    }
+}
+
+
+/* sdot for inc_x = inc_y = 1 */
+float
+sp_blas_sdot_inc1_avx2(
+    len_t n,
+    const float * const x,
+    const float * const y)
+{
+    float tmp = 0.0f;
+    len_t i = 0;
+    len_t head = sp_simd_align_head(x, 32, n);
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    __m256 acc2 = _mm256_setzero_ps();
+    __m256 acc3 = _mm256_setzero_ps();
+
+    for (; i < head; i++) {
+        tmp += x[i] * y[i];
+    }
+    for (; i + 32 <= n; i += 32) {
+        acc0 = _mm256_fmadd_ps(
+            _mm256_load_ps(x + i), _mm256_loadu_ps(y + i), acc0);
+        acc1 = _mm256_fmadd_ps(
+            _mm256_load_ps(x + i + 8), _mm256_loadu_ps(y + i + 8), acc1);
+        acc2 = _mm256_fmadd_ps(
+            _mm256_load_ps(x + i + 16), _mm256_loadu_ps(y + i + 16), acc2);
+        acc3 = _mm256_fmadd_ps(
+            _mm256_load_ps(x + i + 24), _mm256_loadu_ps(y + i + 24), acc3);
+    }
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_fmadd_ps(
+            _mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i), acc0);
+    }
+    if (i < n) {
+        __m256i mask = tail_mask(n - i);
+        acc1 = _mm256_fmadd_ps(
+            _mm256_maskload_ps(x + i, mask),
+            _mm256_maskload_ps(y + i, mask), acc1);
+    }
+
+    acc0 = _mm256_add_ps(_mm256_add_ps(acc0, acc1), _mm256_add_ps(acc2, acc3));
+    return tmp + hsum(acc0);
+}
+
+
+/* srot for inc_x = inc_y = 1 */
+void
+sp_blas_srot_inc1_avx2(
+    len_t n,
+    float * const x,
+    float * const y,
+    float c,
+    float s)
+{
+    len_t i = 0;
+    len_t head = sp_simd_align_head(x, 32, n);
+    __m256 vc = _mm256_set1_ps(c);
+    __m256 vs = _mm256_set1_ps(s);
+
+    for (; i < head; i++) {
+        float tmp = c * x[i] + s * y[i];
+        y[i] = c * y[i] - s * x[i];
+        x[i] = tmp;
+    }
+    for (; i + 16 <= n; i += 16) {
+        __m256 x0 = _mm256_load_ps(x + i);
+        __m256 x1 = _mm256_load_ps(x + i + 8);
+        __m256 y0 = _mm256_loadu_ps(y + i);
+        __m256 y1 = _mm256_loadu_ps(y + i + 8);
+        _mm256_store_ps(x + i,
+            _mm256_fmadd_ps(vc, x0, _mm256_mul_ps(vs, y0)));
+        _mm256_store_ps(x + i + 8,
+            _mm256_fmadd_ps(vc, x1, _mm256_mul_ps(vs, y1)));
+        _mm256_storeu_ps(y + i,
+            _mm256_fmsub_ps(vc, y0, _mm256_mul_ps(vs, x0)));
+        _mm256_storeu_ps(y + i + 8,
+            _mm256_fmsub_ps(vc, y1, _mm256_mul_ps(vs, x1)));
+    }
+    for (; i + 8 <= n; i += 8) {
+        __m256 x0 = _mm256_loadu_ps(x + i);
+        __m256 y0 = _mm256_loadu_ps(y + i);
+        _mm256_storeu_ps(x + i,
+            _mm256_fmadd_ps(vc, x0, _mm256_mul_ps(vs, y0)));
+        _mm256_storeu_ps(y + i,
+            _mm256_fmsub_ps(vc, y0, _mm256_mul_ps(vs, x0)));
+    }
+    if (i < n) {
+        __m256i mask = tail_mask(n - i);
+        __m256 x0 = _mm256_maskload_ps(x + i, mask);
+        __m256 y0 = _mm256_maskload_ps(y + i, mask);
+        _mm256_maskstore_ps(x + i, mask,
+            _mm256_fmadd_ps(vc, x0, _mm256_mul_ps(vs, y0)));
+        _mm256_maskstore_ps(y + i, mask,
+            _mm256_fmsub_ps(vc, y0, _mm256_mul_ps(vs, x0)));
+    }
+}
+
+
+/* sscal for inc = 1 */
+void
+sp_blas_sscal_inc1_avx2(
+    len_t n,
+    float alpha,
+    float * const x)
+{
+    len_t i = 0;
+    len_t head = sp_simd_align_head(x, 32, n);
+
+    /* alpha == 0 stores zeros rather than multiplying, so that NaN and Inf
+     * are cleared the same way as in the reference kernel.
+     */
+    __m256 a = _mm256_set1_ps(alpha);
+    __m256 zero = _mm256_setzero_ps();
+
+    if (alpha == 0.0f) {
+        for (; i < head; i++) {
+            x[i] = 0.0f;
+        }
+        for (; i + 8 <= n; i += 8) {
+            _mm256_store_ps(x + i, zero);
+        }
+        if (i < n) {
+            _mm256_maskstore_ps(x + i, tail_mask(n - i), zero);
+        }
+        return;
+    }
+
+    for (; i < head; i++) {
+        x[i] *= alpha;
+    }
+    for (; i + 32 <= n; i += 32) {
+        _mm256_store_ps(x + i, _mm256_mul_ps(a, _mm256_load_ps(x + i)));
+        _mm256_store_ps(x + i + 8,
+            _mm256_mul_ps(a, _mm256_load_ps(x + i + 8)));
+        _mm256_store_ps(x + i + 16,
+            _mm256_mul_ps(a, _mm256_load_ps(x + i + 16)));
+        _mm256_store_ps(x + i + 24,
+            _mm256_mul_ps(a, _mm256_load_ps(x + i + 24)));
+    }
+    for (; i + 8 <= n; i += 8) {
+        _mm256_store_ps(x + i, _mm256_mul_ps(a, _mm256_load_ps(x + i)));
+    }
+    if (i < n) {
+        __m256i mask = tail_mask(n - i);
+        _mm256_maskstore_ps(x + i, mask,
+            _mm256_mul_ps(a, _mm256_maskload_ps(x + i, mask)));
+    }
+}
+
+
+/* scopy for inc_x, inc_y = 1 */
+void
+sp_blas_scopy_inc1_avx2(
+    len_t n,
+    const float * const x,
+    float * const y)
+{
+    len_t i = 0;
+    len_t head = sp_simd_align_head(y, 32, n);
+
+    for (; i < head; i++) {
+        y[i] = x[i];
+    }
+    for (; i + 32 <= n; i += 32) {
+        __m256 v0 = _mm256_loadu_ps(x + i);
+        __m256 v1 = _mm256_loadu_ps(x + i + 8);
+        __m256 v2 = _mm256_loadu_ps(x + i + 16);
+        __m256 v3 = _mm256_loadu_ps(x + i + 24);
+        _mm256_store_ps(y + i, v0);
+        _mm256_store_ps(y + i + 8, v1);
+        _mm256_store_ps(y + i + 16, v2);
+        _mm256_store_ps(y + i + 24, v3);
+    }
+    for (; i + 8 <= n; i += 8) {
+        _mm256_store_ps(y + i, _mm256_loadu_ps(x + i));
+    }
+    if (i < n) {
+        __m256i mask = tail_mask(n - i);
+        _mm256_maskstore_ps(y + i, mask, _mm256_maskload_ps(x + i, mask));
+    }
+}
+
+
+/* sswap for inc_x = inc_y = 1 */
+void
+sp_blas_sswap_inc1_avx2(
+    len_t n,
+    float * const x,
+    float * const y)
+{
+    len_t i = 0;
+    len_t head = sp_simd_align_head(x, 32, n);
+
+    for (; i < head; i++) {
+        float tmp = x[i];
+        x[i] = y[i];
+        y[i] = tmp;
+    }
+    for (; i + 16 <= n; i += 16) {
+        __m256 x0 = _mm256_load_ps(x + i);
+        __m256 x1 = _mm256_load_ps(x + i + 8);
+        __m256 y0 = _mm256_loadu_ps(y + i);
+        __m256 y1 = _mm256_loadu_ps(y + i + 8);
+        _mm256_store_ps(x + i, y0);
+        _mm256_store_ps(x + i + 8, y1);
+        _mm256_storeu_ps(y + i, x0);
+        _mm256_storeu_ps(y + i + 8, x1);
+    }
+    for (; i + 8 <= n; i += 8) {
+        __m256 x0 = _mm256_loadu_ps(x + i);
+        _mm256_storeu_ps(x + i, _mm256_loadu_ps(y + i));
+        _mm256_storeu_ps(y + i, x0);
+    }
+    if (i < n) {
+        __m256i mask = tail_mask(n - i);
+        __m256 x0 = _mm256_maskload_ps(x + i, mask);
+        __m256 y0 = _mm256_maskload_ps(y + i, mask);
+        _mm256_maskstore_ps(x + i, mask, y0);
+        _mm256_maskstore_ps(y + i, mask, x0);
+    }
+}
+
+
+/* snrm2 for inc_x = 1, summing squares in double precision */
+float
+sp_blas_snrm2_inc1_avx2(
+    len_t n,
+    const float * const x)
+{
+    double tmp = 0.0;
+    len_t i = 0;
+    len_t head = sp_simd_align_head(x, 16, n);
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+    __m256d acc2 = _mm256_setzero_pd();
+    __m256d acc3 = _mm256_setzero_pd();
+
+    for (; i < head; i++) {
+        tmp += (double)x[i] * (double)x[i];
+    }
+    for (; i + 16 <= n; i += 16) {
+        __m256d d0 = _mm256_cvtps_pd(_mm_load_ps(x + i));
+        __m256d d1 = _mm256_cvtps_pd(_mm_load_ps(x + i + 4));
+        __m256d d2 = _mm256_cvtps_pd(_mm_load_ps(x + i + 8));
+        __m256d d3 = _mm256_cvtps_pd(_mm_load_ps(x + i + 12));
+        acc0 = _mm256_fmadd_pd(d0, d0, acc0);
+        acc1 = _mm256_fmadd_pd(d1, d1, acc1);
+        acc2 = _mm256_fmadd_pd(d2, d2, acc2);
+        acc3 = _mm256_fmadd_pd(d3, d3, acc3);
+    }
+    for (; i + 4 <= n; i += 4) {
+        __m256d d0 = _mm256_cvtps_pd(_mm_load_ps(x + i));
+        acc0 = _mm256_fmadd_pd(d0, d0, acc0);
+    }
+
+    acc0 = _mm256_add_pd(_mm256_add_pd(acc0, acc1), _mm256_add_pd(acc2, acc3));
+    __m128d lo = _mm_add_pd(
+        _mm256_castpd256_pd128(acc0), _mm256_extractf128_pd(acc0, 1));
+    tmp += _mm_cvtsd_f64(_mm_add_sd(lo, _mm_unpackhi_pd(lo, lo)));
+    for (; i < n; i++) {
+        tmp += (double)x[i] * (double)x[i];
+    }
+    return (float)sqrt(tmp);
+}
+
+
+/*
+ * isamax (or isamin, if is_min) for inc_x = 1. Each lane keeps the best
+ * magnitude it has seen and the index it was found at. A lane only moves
+ * on a strict improvement, so it holds the first occurrence of its best
+ * value. Two sets of lanes hide the latency of the compare-and-blend
+ * chain. NaN never compares better, except that a NaN in x[0] is returned
+ * as in the scalar kernels.
+ */
+static inline len_t
+iamax(
+    len_t n,
+    const float * const x,
+    bool is_min)
+{
+    if (x[0] != x[0]) {
+        return 0;
+    }
+
+    __m256 init = _mm256_set1_ps(is_min ? INFINITY : -1.0f);
+    __m256 best0 = init, best1 = init;
+    __m256i idx0 = _mm256_setzero_si256(), idx1 = _mm256_setzero_si256();
+    __m256i cur = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    len_t i = 0;
+
+    for (; i + 16 <= n; i += 16) {
+        __m256 v0 = vabs(_mm256_loadu_ps(x + i));
+        __m256 v1 = vabs(_mm256_loadu_ps(x + i + 8));
+        __m256 m0 = is_min ? _mm256_cmp_ps(v0, best0, _CMP_LT_OQ) :
+            _mm256_cmp_ps(best0, v0, _CMP_LT_OQ);
+        __m256 m1 = is_min ? _mm256_cmp_ps(v1, best1, _CMP_LT_OQ) :
+            _mm256_cmp_ps(best1, v1, _CMP_LT_OQ);
+        best0 = _mm256_blendv_ps(best0, v0, m0);
+        best1 = _mm256_blendv_ps(best1, v1, m1);
+        idx0 = _mm256_blendv_epi8(idx0, cur, _mm256_castps_si256(m0));
+        idx1 = _mm256_blendv_epi8(idx1,
+            _mm256_add_epi32(cur, _mm256_set1_epi32(8)),
+            _mm256_castps_si256(m1));
+        cur = _mm256_add_epi32(cur, _mm256_set1_epi32(16));
+    }
+
+    float val[16];
+    int32_t idx[16];
+    _mm256_storeu_ps(val, best0);
+    _mm256_storeu_ps(val + 8, best1);
+    _mm256_storeu_si256((__m256i *)idx, idx0);
+    _mm256_storeu_si256((__m256i *)(idx + 8), idx1);
+    float b;
+    len_t ib = sp_simd_pick_lane(val, idx, 16, is_min, &b);
+    for (; i < n; i++) {
+        float a = fabsf(x[i]);
+        if (is_min ? a < b : a > b) {
+            b = a;
+            ib = i;
+        }
+    }
+    return ib;
+}
+
+
+/* isamax for inc_x = 1 */
+len_t
+sp_blas_isamax_inc1_avx2(
+    len_t n,
+    const float * const x)
+{
+    return iamax(n, x, false);
+}
+
+
+/* isamin for inc_x = 1 */
+len_t
+sp_blas_isamin_inc1_avx2(
+    len_t n,
+    const float * const x)
+{
+    return iamax(n, x, true);
+}
+
+/* saxpy_dot for inc_x = inc_y = inc_z = 1 */
+float
+sp_blas_saxpy_dot_inc1_avx2(
+    len_t n,
+    float alpha,
+    const float * const x,
+    float * const y,
+    const float * const z)
+{
+    float tmp = 0.0f;
+    len_t i = 0;
+    len_t head = sp_simd_align_head(y, 32, n);
+    __m256 a = _mm256_set1_ps(alpha);
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    __m256 acc2 = _mm256_setzero_ps();
+    __m256 acc3 = _mm256_setzero_ps();
+
+    for (; i < head; i++) {
+        y[i] += alpha * x[i];
+        tmp += y[i] * z[i];
+    }
+    for (; i + 32 <= n; i += 32) {
+        __m256 y0 = _mm256_fmadd_ps(
+            a, _mm256_loadu_ps(x + i), _mm256_load_ps(y + i));
+        __m256 y1 = _mm256_fmadd_ps(
+            a, _mm256_loadu_ps(x + i + 8), _mm256_load_ps(y + i + 8));
+        __m256 y2 = _mm256_fmadd_ps(
+            a, _mm256_loadu_ps(x + i + 16), _mm256_load_ps(y + i + 16));
+        __m256 y3 = _mm256_fmadd_ps(
+            a, _mm256_loadu_ps(x + i + 24), _mm256_load_ps(y + i + 24));
+        _mm256_store_ps(y + i, y0);
+        _mm256_store_ps(y + i + 8, y1);
+        _mm256_store_ps(y + i + 16, y2);
+        _mm256_store_ps(y + i + 24, y3);
+        acc0 = _mm256_fmadd_ps(y0, _mm256_loadu_ps(z + i), acc0);
+        acc1 = _mm256_fmadd_ps(y1, _mm256_loadu_ps(z + i + 8), acc1);
+        acc2 = _mm256_fmadd_ps(y2, _mm256_loadu_ps(z + i + 16), acc2);
+        acc3 = _mm256_fmadd_ps(y3, _mm256_loadu_ps(z + i + 24), acc3);
+    }
+    for (; i + 8 <= n; i += 8) {
+        __m256 y0 = _mm256_fmadd_ps(
+            a, _mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i));
+        _mm256_storeu_ps(y + i, y0);
+        acc0 = _mm256_fmadd_ps(y0, _mm256_loadu_ps(z + i), acc0);
+    }
+    if (i < n) {
+        __m256i mask = tail_mask(n - i);
+        __m256 yt = _mm256_fmadd_ps(
+            a, _mm256_maskload_ps(x + i, mask),
+            _mm256_maskload_ps(y + i, mask));
+        _mm256_maskstore_ps(y + i, mask, yt);
+        acc1 = _mm256_fmadd_ps(yt, _mm256_maskload_ps(z + i, mask), acc1);
+    }
+
+    acc0 = _mm256_add_ps(_mm256_add_ps(acc0, acc1), _mm256_add_ps(acc2, acc3));
+    return tmp + hsum(acc0);
+}
+
+
+/* scopy_scal for inc_x = inc_y = 1 */
+void
+sp_blas_scopy_scal_inc1_avx2(
+    len_t n,
+    float alpha,
+    const float * const x,
+    float * const y)
+{
+    len_t i = 0;
+    len_t head = sp_simd_align_head(y, 32, n);
+    __m256 a = _mm256_set1_ps(alpha);
+
+    for (; i < head; i++) {
+        y[i] = alpha * x[i];
+    }
+    for (; i + 32 <= n; i += 32) {
+        __m256 v0 = _mm256_mul_ps(a, _mm256_loadu_ps(x + i));
+        __m256 v1 = _mm256_mul_ps(a, _mm256_loadu_ps(x + i + 8));
+        __m256 v2 = _mm256_mul_ps(a, _mm256_loadu_ps(x + i + 16));
+        __m256 v3 = _mm256_mul_ps(a, _mm256_loadu_ps(x + i + 24));
+        _mm256_store_ps(y + i, v0);
+        _mm256_store_ps(y + i + 8, v1);
+        _mm256_store_ps(y + i + 16, v2);
+        _mm256_store_ps(y + i + 24, v3);
+    }
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(y + i, _mm256_mul_ps(a, _mm256_loadu_ps(x + i)));
+    }
+    if (i < n) {
+        __m256i mask = tail_mask(n - i);
+        _mm256_maskstore_ps(y + i, mask,
+            _mm256_mul_ps(a, _mm256_maskload_ps(x + i, mask)));
+    }
+}
+
+#endif
@@ -0,0 +1,540 @@
+/*
+ * AVX-512F versions of the unit-stride level 1 kernels. This file is
+ * compiled with -mavx512f -mfma. Both the alignment peel and the tail are
+ * done with masked loads and stores, so there is no scalar cleanup code.
+ */
+#if defined(__AVX512F__)
+
+#include <math.h>
+#include <immintrin.h>
+
+#include "snackpack/snackpack.h"
+#include "snackpack/internal/blas1_real_simd.h"
+
+
+/* Mask with the first rem (< 16) lanes set. */
+static inline __mmask16
+lane_mask(len_t rem)
+{
+    return (__mmask16)((1u << rem) - 1u);
+}
+
+
+static inline __m512
+vabs(__m512 v)
+{
+    return _mm512_castsi512_ps(_mm512_and_si512(
+        _mm512_castps_si512(v), _mm512_set1_epi32(0x7fffffff)));
+}
+
+
+/* sasum for inc_x = 1 */
+float
+sp_blas_sasum_inc1_avx512(
+    len_t n,
+    const float * const x)
+{
+    len_t i = sp_simd_align_head(x, 64, n);
+    __m512 acc0 = vabs(_mm512_maskz_loadu_ps(lane_mask(i), x));
+    __m512 acc1 = _mm512_setzero_ps();
+    __m512 acc2 = _mm512_setzero_ps();
+    __m512 acc3 = _mm512_setzero_ps();
+
+    for (; i + 64 <= n; i += 64) {
+        acc0 = _mm512_add_ps(acc0, vabs(_mm512_load_ps(x + i)));
+        acc1 = _mm512_add_ps(acc1, vabs(_mm512_load_ps(x + i + 16)));
+        acc2 = _mm512_add_ps(acc2, vabs(_mm512_load_ps(x + i + 32)));
+        acc3 = _mm512_add_ps(acc3, vabs(_mm512_load_ps(x + i + 48)));
+    }
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm512_add_ps(acc0, vabs(_mm512_loadu_ps(x + i)));
+    }
+    if (i < n) {
+        acc1 = _mm512_add_ps(acc1,
+            vabs(_mm512_maskz_loadu_ps(lane_mask(n - i), x + i)));
+    }
+
+    acc0 = _mm512_add_ps(_mm512_add_ps(acc0, acc1), _mm512_add_ps(acc2, acc3));
+    return _mm512_reduce_add_ps(acc0);
+}
+
+
+/* saxpy for inc_x = inc_y = 1 */
+void
+sp_blas_saxpy_inc1_avx512(
+    len_t n,
+    float alpha,
+    const float * const x,
+    float * const y)
+{
+    /* If alpha == 0, nothing to do */
+    if (alpha == 0.0f) {
+        return;
+    }
+
+    len_t i = sp_simd_align_head(y, 64, n);
+    __m512 a = _mm512_set1_ps(alpha);
+
+    if (i > 0) {
+        __mmask16 mask = lane_mask(i);
+        _mm512_mask_storeu_ps(y, mask, _mm512_fmadd_ps(a,
+            _mm512_maskz_loadu_ps(mask, x), _mm512_maskz_loadu_ps(mask, y)));
+    }
+    for (; i + 64 <= n; i += 64) {
+        __m512 y0 = _mm512_fmadd_ps(
+            a, _mm512_loadu_ps(x + i), _mm512_load_ps(y + i));
+        __m512 y1 = _mm512_fmadd_ps(
+            a, _mm512_loadu_ps(x + i + 16), _mm512_load_ps(y + i + 16));
+        __m512 y2 = _mm512_fmadd_ps(
+            a, _mm512_loadu_ps(x + i + 32), _mm512_load_ps(y + i + 32));
+        __m512 y3 = _mm512_fmadd_ps(
+            a, _mm512_loadu_ps(x + i + 48), _mm512_load_ps(y + i + 48));
+        _mm512_store_ps(y + i, y0);
+        _mm512_store_ps(y + i + 16, y1);
+        _mm512_store_ps(y + i + 32, y2);
+        _mm512_store_ps(y + i + 48, y3);
+    }
+    for (; i + 16 <= n; i += 16) {
+        _mm512_storeu_ps(y + i, _mm512_fmadd_ps(
+            a, _mm512_loadu_ps(x + i), _mm512_loadu_ps(y + i)));
+    }
+    if (i < n) {
+        __mmask16 mask = lane_mask(n - i);
+        _mm512_mask_storeu_ps(y + i, mask, _mm512_fmadd_ps(a,
+            _mm512_maskz_loadu_ps(mask, x + i),
+            _mm512_maskz_loadu_ps(mask, y + i)));
+    }
+}
+
+
+/* sdot for inc_x = inc_y = 1 */
+float
+sp_blas_sdot_inc1_avx512(
+    len_t n,
+    const float * const x,
+    const float * const y)
+{
+    len_t i = sp_simd_align_head(x, 64, n);
+    __mmask16 head = lane_mask(i);
+    __m512 acc0 = _mm512_mul_ps(
+        _mm512_maskz_loadu_ps(head, x), _mm512_maskz_loadu_ps(head, y));
+    __m512 acc1 = _mm512_setzero_ps();
+    __m512 acc2 = _mm512_setzero_ps();
+    __m512 acc3 = _mm512_setzero_ps();
+
+    for (; i + 64 <= n; i += 64) {
+        acc0 = _mm512_fmadd_ps(
+            _mm512_load_ps(x + i), _mm512_loadu_ps(y + i), acc0);
+        acc1 = _mm512_fmadd_ps(
+            _mm512_load_ps(x + i + 16), _mm512_loadu_ps(y + i + 16), acc1);
+        acc2 = _mm512_fmadd_ps(
+            _mm512_load_ps(x + i + 32), _mm512_loadu_ps(y + i + 32), acc2);
+        acc3 = _mm512_fmadd_ps(
+            _mm512_load_ps(x + i + 48), _mm512_loadu_ps(y + i + 48), acc3);
+    }
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm512_fmadd_ps(
+            _mm512_loadu_ps(x + i), _mm512_loadu_ps(y + i), acc0);
+    }
+    if (i < n) {
+        __mmask16 mask = lane_mask(n - i);
+        acc1 = _mm512_fmadd_ps(
+            _mm512_maskz_loadu_ps(mask, x + i),
+            _mm512_maskz_loadu_ps(mask, y + i), acc1);
+    }
+
+    acc0 = _mm512_add_ps(_mm512_add_ps(acc0, acc1), _mm512_add_ps(acc2, acc3));
+    return _mm512_reduce_add_ps(acc0);
+}
+
+
+/* srot for inc_x = inc_y = 1 */
+void
+sp_blas_srot_inc1_avx512(
+    len_t n,
+    float * const x,
+    float * const y,
+    float c,
+    float s)
+{
+    len_t i = sp_simd_align_head(x, 64, n);
+    __m512 vc = _mm512_set1_ps(c);
+    __m512 vs = _mm512_set1_ps(s);
+
+    if (i > 0) {
+        __mmask16 mask = lane_mask(i);
+        __m512 x0 = _mm512_maskz_loadu_ps(mask, x);
+        __m512 y0 = _mm512_maskz_loadu_ps(mask, y);
+        _mm512_mask_storeu_ps(x, mask,
+            _mm512_fmadd_ps(vc, x0, _mm512_mul_ps(vs, y0)));
+        _mm512_mask_storeu_ps(y, mask,
+            _mm512_fmsub_ps(vc, y0, _mm512_mul_ps(vs, x0)));
+    }
+    for (; i + 32 <= n; i += 32) {
+        __m512 x0 = _mm512_load_ps(x + i);
+        __m512 x1 = _mm512_load_ps(x + i + 16);
+        __m512 y0 = _mm512_loadu_ps(y + i);
+        __m512 y1 = _mm512_loadu_ps(y + i + 16);
+        _mm512_store_ps(x + i,
+            _mm512_fmadd_ps(vc, x0, _mm512_mul_ps(vs, y0)));
+        _mm512_store_ps(x + i + 16,
+            _mm512_fmadd_ps(vc, x1, _mm512_mul_ps(vs, y1)));
+        _mm512_storeu_ps(y + i,
+            _mm512_fmsub_ps(vc, y0, _mm512_mul_ps(vs, x0)));
+        _mm512_storeu_ps(y + i + 16,
+            _mm512_fmsub_ps(vc, y1, _mm512_mul_ps(vs, x1)));
+    }
+    for (; i < n; i += 16) {
+        __mmask16 mask = n - i >= 16 ? (__mmask16)0xffff : lane_mask(n - i);
+        __m512 x0 = _mm512_maskz_loadu_ps(mask, x + i);
+        __m512 y0 = _mm512_maskz_loadu_ps(mask, y + i);
+        _mm512_mask_storeu_ps(x + i, mask,
+            _mm512_fmadd_ps(vc, x0, _mm512_mul_ps(vs, y0)));
+        _mm512_mask_storeu_ps(y + i, mask,
+            _mm512_fmsub_ps(vc, y0, _mm512_mul_ps(vs, x0)));
+    }
+}
+
+
+/* sscal for inc = 1 */
+void
+sp_blas_sscal_inc1_avx512(
+    len_t n,
+    float alpha,
+    float * const x)
+{
+    len_t i = sp_simd_align_head(x, 64, n);
+
+    /* alpha == 0 stores zeros rather than multiplying, so that NaN and Inf
+     * are cleared the same way as in the reference kernel.
+     */
+    if (alpha == 0.0f) {
+        __m512 zero = _mm512_setzero_ps();
+        _mm512_mask_storeu_ps(x, lane_mask(i), zero);
+        for (; i + 16 <= n; i += 16) {
+            _mm512_store_ps(x + i, zero);
+        }
+        if (i < n) {
+            _mm512_mask_storeu_ps(x + i, lane_mask(n - i), zero);
+        }
+        return;
+    }
+
+    __m512 a = _mm512_set1_ps(alpha);
+    if (i > 0) {
+        __mmask16 mask = lane_mask(i);
+        _mm512_mask_storeu_ps(x, mask,
+            _mm512_mul_ps(a, _mm512_maskz_loadu_ps(mask, x)));
+    }
+    for (; i + 64 <= n; i += 64) {
+        _mm512_store_ps(x + i, _mm512_mul_ps(a, _mm512_load_ps(x + i)));
+        _mm512_store_ps(x + i + 16,
+            _mm512_mul_ps(a, _mm512_load_ps(x + i + 16)));
+        _mm512_store_ps(x + i + 32,
+            _mm512_mul_ps(a, _mm512_load_ps(x + i + 32)));
+        _mm512_store_ps(x + i + 48,
+            _mm512_mul_ps(a, _mm512_load_ps(x + i + 48)));
+    }
+    for (; i + 16 <= n; i += 16) {
+        _mm512_store_ps(x + i, _mm512_mul_ps(a, _mm512_load_ps(x + i)));
+    }
+    if (i < n) {
+        __mmask16 mask = lane_mask(n - i);
+        _mm512_mask_storeu_ps(x + i, mask,
+            _mm512_mul_ps(a, _mm512_maskz_loadu_ps(mask, x + i)));
+    }
+}
+
+
+/* scopy for inc_x, inc_y = 1 */
+void
+sp_blas_scopy_inc1_avx512(
+    len_t n,
+    const float * const x,
+    float * const y)
+{
+    len_t i = sp_simd_align_head(y, 64, n);
+
+    if (i > 0) {
+        __mmask16 mask = lane_mask(i);
+        _mm512_mask_storeu_ps(y, mask, _mm512_maskz_loadu_ps(mask, x));
+    }
+    for (; i + 64 <= n; i += 64) {
+        __m512 v0 = _mm512_loadu_ps(x + i);
+        __m512 v1 = _mm512_loadu_ps(x + i + 16);
+        __m512 v2 = _mm512_loadu_ps(x + i + 32);
+        __m512 v3 = _mm512_loadu_ps(x + i + 48);
+        _mm512_store_ps(y + i, v0);
+        _mm512_store_ps(y + i + 16, v1);
+        _mm512_store_ps(y + i + 32, v2);
+        _mm512_store_ps(y + i + 48, v3);
+    }
+    for (; i + 16 <= n; i += 16) {
+        _mm512_store_ps(y + i, _mm512_loadu_ps(x + i));
+    }
+    if (i < n) {
+        __mmask16 mask = lane_mask(n - i);
+        _mm512_mask_storeu_ps(y + i, mask, _mm512_maskz_loadu_ps(mask, x + i));
+    }
+}
+
+
+/* sswap for inc_x = inc_y = 1 */
+void
+sp_blas_sswap_inc1_avx512(
+    len_t n,
+    float * const x,
+    float * const y)
+{
+    len_t i = sp_simd_align_head(x, 64, n);
+
+    if (i > 0) {
+        __mmask16 mask = lane_mask(i);
+        __m512 x0 = _mm512_maskz_loadu_ps(mask, x);
+        _mm512_mask_storeu_ps(x, mask, _mm512_maskz_loadu_ps(mask, y));
+        _mm512_mask_storeu_ps(y, mask, x0);
+    }
+    for (; i + 32 <= n; i += 32) {
+        __m512 x0 = _mm512_load_ps(x + i);
+        __m512 x1 = _mm512_load_ps(x + i + 16);
+        __m512 y0 = _mm512_loadu_ps(y + i);
+        __m512 y1 = _mm512_loadu_ps(y + i + 16);
+        _mm512_store_ps(x + i, y0);
+        _mm512_store_ps(x + i + 16, y1);
+        _mm512_storeu_ps(y + i, x0);
+        _mm512_storeu_ps(y + i + 16, x1);
+    }
+    for (; i < n; i += 16) {
+        __mmask16 mask = n - i >= 16 ? (__mmask16)0xffff : lane_mask(n - i);
+        __m512 x0 = _mm512_maskz_loadu_ps(mask, x + i);
+        _mm512_mask_storeu_ps(x + i, mask, _mm512_maskz_loadu_ps(mask, y + i));
+        _mm512_mask_storeu_ps(y + i, mask, x0);
+    }
+}
+
+
+/* Widen the low or high eight floats of v to double. */
+static inline __m512d
+cvt_lo(__m512 v)
+{
+    return _mm512_cvtps_pd(_mm512_castps512_ps256(v));
+}
+
+
+static inline __m512d
+cvt_hi(__m512 v)
+{
+    return _mm512_cvtps_pd(_mm256_castpd_ps(
+        _mm512_extractf64x4_pd(_mm512_castps_pd(v), 1)));
+}
+
+
+/* snrm2 for inc_x = 1, summing squares in double precision */
+float
+sp_blas_snrm2_inc1_avx512(
+    len_t n,
+    const float * const x)
+{
+    len_t i = sp_simd_align_head(x, 64, n);
+    __m512 v = _mm512_maskz_loadu_ps(lane_mask(i), x);
+    __m512d acc0 = _mm512_mul_pd(cvt_lo(v), cvt_lo(v));
+    __m512d acc1 = _mm512_mul_pd(cvt_hi(v), cvt_hi(v));
+    __m512d acc2 = _mm512_setzero_pd();
+    __m512d acc3 = _mm512_setzero_pd();
+
+    for (; i + 32 <= n; i += 32) {
+        __m512 v0 = _mm512_load_ps(x + i);
+        __m512 v1 = _mm512_load_ps(x + i + 16);
+        __m512d d0 = cvt_lo(v0), d1 = cvt_hi(v0);
+        __m512d d2 = cvt_lo(v1), d3 = cvt_hi(v1);
+        acc0 = _mm512_fmadd_pd(d0, d0, acc0);
+        acc1 = _mm512_fmadd_pd(d1, d1, acc1);
+        acc2 = _mm512_fmadd_pd(d2, d2, acc2);
+        acc3 = _mm512_fmadd_pd(d3, d3, acc3);
+    }
+    for (; i + 16 <= n; i += 16) {
+        v = _mm512_loadu_ps(x + i);
+        acc0 = _mm512_fmadd_pd(cvt_lo(v), cvt_lo(v), acc0);
+        acc1 = _mm512_fmadd_pd(cvt_hi(v), cvt_hi(v), acc1);
+    }
+    if (i < n) {
+        v = _mm512_maskz_loadu_ps(lane_mask(n - i), x + i);
+        acc2 = _mm512_fmadd_pd(cvt_lo(v), cvt_lo(v), acc2);
+        acc3 = _mm512_fmadd_pd(cvt_hi(v), cvt_hi(v), acc3);
+    }
+
+    acc0 = _mm512_add_pd(_mm512_add_pd(acc0, acc1), _mm512_add_pd(acc2, acc3));
+    return (float)sqrt(_mm512_reduce_add_pd(acc0));
+}
+
+
+/*
+ * isamax (or isamin, if is_min) for inc_x = 1. Each lane keeps the best
+ * magnitude it has seen and the index it was found at. A lane only moves
+ * on a strict improvement, so it holds the first occurrence of its best
+ * value. Two sets of lanes hide the latency of the compare-and-blend
+ * chain. NaN never compares better, except that a NaN in x[0] is returned
+ * as in the scalar kernels.
+ */
+static inline len_t
+iamax(
+    len_t n,
+    const float * const x,
+    bool is_min)
+{
+    if (x[0] != x[0]) {
+        return 0;
+    }
+
+    __m512 init = _mm512_set1_ps(is_min ? INFINITY : -1.0f);
+    __m512 best0 = init, best1 = init;
+    __m512i idx0 = _mm512_setzero_si512(), idx1 = _mm512_setzero_si512();
+    __m512i cur = _mm512_setr_epi32(
+        0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    len_t i = 0;
+
+    for (; i + 32 <= n; i += 32) {
+        __m512 v0 = vabs(_mm512_loadu_ps(x + i));
+        __m512 v1 = vabs(_mm512_loadu_ps(x + i + 16));
+        __mmask16 m0 = is_min ? _mm512_cmp_ps_mask(v0, best0, _CMP_LT_OQ) :
+            _mm512_cmp_ps_mask(best0, v0, _CMP_LT_OQ);
+        __mmask16 m1 = is_min ? _mm512_cmp_ps_mask(v1, best1, _CMP_LT_OQ) :
+            _mm512_cmp_ps_mask(best1, v1, _CMP_LT_OQ);
+        best0 = _mm512_mask_mov_ps(best0, m0, v0);
+        best1 = _mm512_mask_mov_ps(best1, m1, v1);
+        idx0 = _mm512_mask_mov_epi32(idx0, m0, cur);
+        idx1 = _mm512_mask_mov_epi32(idx1, m1,
+            _mm512_add_epi32(cur, _mm512_set1_epi32(16)));
+        cur = _mm512_add_epi32(cur, _mm512_set1_epi32(32));
+    }
+
+    float val[32];
+    int32_t idx[32];
+    _mm512_storeu_ps(val, best0);
+    _mm512_storeu_ps(val + 16, best1);
+    _mm512_storeu_si512(idx, idx0);
+    _mm512_storeu_si512(idx + 16, idx1);
+    float b;
+    len_t ib = sp_simd_pick_lane(val, idx, 32, is_min, &b);
+    for (; i < n; i++) {
+        float a = fabsf(x[i]);
+        if (is_min ? a < b : a > b) {
+            b = a;
+            ib = i;
+        }
+    }
+    return ib;
+}
+
+
+/* isamax for inc_x = 1 */
+len_t
+sp_blas_isamax_inc1_avx512(
+    len_t n,
+    const float * const x)
+{
+    return iamax(n, x, false);
+}
+
+
+/* isamin for inc_x = 1 */
+len_t
+sp_blas_isamin_inc1_avx512(
+    len_t n,
+    const float * const x)
+{
+    return iamax(n, x, true);
+}
+
+/* saxpy_dot for inc_x = inc_y = inc_z = 1 */
+float
+sp_blas_saxpy_dot_inc1_avx512(
+    len_t n,
+    float alpha,
+    const float * const x,
+    float * const y,
+    const float * const z)
+{
+    len_t i = sp_simd_align_head(y, 64, n);
+    __mmask16 head = lane_mask(i);
+    __m512 a = _mm512_set1_ps(alpha);
+    __m512 yh = _mm512_fmadd_ps(a, _mm512_maskz_loadu_ps(head, x),
+        _mm512_maskz_loadu_ps(head, y));
+    _mm512_mask_storeu_ps(y, head, yh);
+    __m512 acc0 = _mm512_mul_ps(yh, _mm512_maskz_loadu_ps(head, z));
+    __m512 acc1 = _mm512_setzero_ps();
+    __m512 acc2 = _mm512_setzero_ps();
+    __m512 acc3 = _mm512_setzero_ps();
+
+    for (; i + 64 <= n; i += 64) {
+        __m512 y0 = _mm512_fmadd_ps(
+            a, _mm512_loadu_ps(x + i), _mm512_load_ps(y + i));
+        __m512 y1 = _mm512_fmadd_ps(
+            a, _mm512_loadu_ps(x + i + 16), _mm512_load_ps(y + i + 16));
+        __m512 y2 = _mm512_fmadd_ps(
+            a, _mm512_loadu_ps(x + i + 32), _mm512_load_ps(y + i + 32));
+        __m512 y3 = _mm512_fmadd_ps(
+            a, _mm512_loadu_ps(x + i + 48), _mm512_load_ps(y + i + 48));
+        _mm512_store_ps(y + i, y0);
+        _mm512_store_ps(y + i + 16, y1);
+        _mm512_store_ps(y + i + 32, y2);
+        _mm512_store_ps(y + i + 48, y3);
+        acc0 = _mm512_fmadd_ps(y0, _mm512_loadu_ps(z + i), acc0);
+        acc1 = _mm512_fmadd_ps(y1, _mm512_loadu_ps(z + i + 16), acc1);
+        acc2 = _mm512_fmadd_ps(y2, _mm512_loadu_ps(z + i + 32), acc2);
+        acc3 = _mm512_fmadd_ps(y3, _mm512_loadu_ps(z + i + 48), acc3);
+    }
+    for (; i + 16 <= n; i += 16) {
+        __m512 y0 = _mm512_fmadd_ps(
+            a, _mm512_loadu_ps(x + i), _mm512_loadu_ps(y + i));
+        _mm512_storeu_ps(y + i, y0);
+        acc0 = _mm512_fmadd_ps(y0, _mm512_loadu_ps(z + i), acc0);
+    }
+    if (i < n) {
+        __mmask16 mask = lane_mask(n - i);
+        __m512 yt = _mm512_fmadd_ps(a, _mm512_maskz_loadu_ps(mask, x + i),
+            _mm512_maskz_loadu_ps(mask, y + i));
+        _mm512_mask_storeu_ps(y + i, mask, yt);
+        acc1 = _mm512_fmadd_ps(yt, _mm512_maskz_loadu_ps(mask, z + i), acc1);
+    }
+
+    acc0 = _mm512_add_ps(_mm512_add_ps(acc0, acc1), _mm512_add_ps(acc2, acc3));
+    return _mm512_reduce_add_ps(acc0);
+}
+
+
+/* scopy_scal for inc_x = inc_y = 1 */
+void
+sp_blas_scopy_scal_inc1_avx512(
+    len_t n,
+    float alpha,
+    const float * const x,
+    float * const y)
+{
+    len_t i = sp_simd_align_head(y, 64, n);
+    __mmask16 head = lane_mask(i);
+    __m512 a = _mm512_set1_ps(alpha);
+
+    _mm512_mask_storeu_ps(y, head,
+        _mm512_mul_ps(a, _mm512_maskz_loadu_ps(head, x)));
+    for (; i + 64 <= n; i += 64) {
+        __m512 v0 = _mm512_mul_ps(a, _mm512_loadu_ps(x + i));
+        __m512 v1 = _mm512_mul_ps(a, _mm512_loadu_ps(x + i + 16));
+        __m512 v2 = _mm512_mul_ps(a, _mm512_loadu_ps(x + i + 32));
+        __m512 v3 = _mm512_mul_ps(a, _mm512_loadu_ps(x + i + 48));
+        _mm512_store_ps(y + i, v0);
+        _mm512_store_ps(y + i + 16, v1);
+        _mm512_store_ps(y + i + 32, v2);
+        _mm512_store_ps(y + i + 48, v3);
+    }
+    for (; i + 16 <= n; i += 16) {
+        _mm512_storeu_ps(y + i, _mm512_mul_ps(a, _mm512_loadu_ps(x + i)));
+    }
+    if (i < n) {
+        __mmask16 mask = lane_mask(n - i);
+        _mm512_mask_storeu_ps(y + i, mask,
+            _mm512_mul_ps(a, _mm512_maskz_loadu_ps(mask, x + i)));
+    }
+}
+
+#endif
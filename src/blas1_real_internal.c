@@ -76,6 +76,52 @@ sp_blas_saxpy_incxy(
 }
 
 
+/* saxpy_dot for inc_x = inc_y = inc_z = 1 */
+float
+sp_blas_saxpy_dot_inc1(
+    len_t n,
+    float alpha,
+    const float * const x,
+    float * const y,
+    const float * const z)
+{
+    float tmp = 0.0f;
+    for (len_t i = 0; i < n; i++) {
+        y[i] += alpha * x[i];
+        tmp += y[i] * z[i];
+    }
+    return tmp;
+}
+
+
+/* saxpy_dot for any increments */
+float
+sp_blas_saxpy_dot_incxyz(
+    len_t n,
+    float alpha,
+    const float * const x,
+    len_t inc_x,
+    float * const y,
+    len_t inc_y,
+    const float * const z,
+    len_t inc_z)
+{
+    float tmp = 0.0f;
+    len_t ix = inc_x < 0 ? (len_t)((1 - n) * inc_x) : 0;
+    len_t iy = inc_y < 0 ? (len_t)((1 - n) * inc_y) : 0;
+    len_t iz = inc_z < 0 ? (len_t)((1 - n) * inc_z) : 0;
+
+    for (len_t i = 0; i < n; i++) {
+        y[iy] += alpha * x[ix];
+        tmp += y[iy] * z[iz];
+        ix += inc_x;
+        iy += inc_y;
+        iz += inc_z;
+    }
+    return tmp;
+}
+
+
 /* srot for inc_x = inc_y = 1 */
 void
 sp_blas_srot_inc1(
@@ -187,29 +233,70 @@ sp_blas_scopy_incxy(
 }
 
 
-/* snrm2 for inc_x = 1 */
+/* scopy_scal for inc_x = inc_y = 1 */
+void
+sp_blas_scopy_scal_inc1(
+    len_t n,
+    float alpha,
+    const float * const x,
+    float * const y)
+{
+    for (len_t i = 0; i < n; i++) {
+        y[i] = alpha * x[i];
+    }
+}
+
+
+/* scopy_scal for inc_x != 1 or inc_y != 1 */
+void
+sp_blas_scopy_scal_incxy(
+    len_t n,
+    float alpha,
+    const float * const x,
+    len_t inc_x,
+    float * const y,
+    len_t inc_y)
+{
+    len_t ix = inc_x < 0 ? (len_t)((1 - n) * inc_x) : 0;
+    len_t iy = inc_y < 0 ? (len_t)((1 - n) * inc_y) : 0;
+
+    for (len_t i = 0; i < n; i++) {
+        y[iy] = alpha * x[ix];
+        ix += inc_x;
+        iy += inc_y;
+    }
+}
+
+
+/*
+ * snrm2 for inc_x = 1
+ *
+ * The squares are summed in double precision. The square of any float is
+ * well inside the range of a double, so nothing can overflow or underflow
+ * and no scaling is needed. The eight partial sums let the compiler
+ * vectorize the loop.
+ */
 float
 sp_blas_snrm2_inc1(
     len_t n,
     const float * const x)
 {
-    float scale = 0.0f;
-    float sq = 1.0f;
+    double acc[8] = {0.0};
+    double sum = 0.0;
+    len_t i = 0;
 
-    for (len_t i = 0; i < n; i++) {
-        if (x[i] != 0.0f) {
-            float absx = fabsf(x[i]);
-            if (scale < absx) {
-                float tmp = scale / absx;
-                sq = 1.0f + sq * tmp * tmp;
-                scale = absx;
-            } else {
-                float tmp = absx / scale;
-                sq += tmp * tmp;
-            }
+    for (; i + 8 <= n; i += 8) {
+        for (len_t k = 0; k < 8; k++) {
+            acc[k] += (double)x[i + k] * (double)x[i + k];
         }
     }
-    return scale * sqrtf(sq);
+    for (; i < n; i++) {
+        sum += (double)x[i] * (double)x[i];
+    }
+    for (len_t k = 0; k < 8; k++) {
+        sum += acc[k];
+    }
+    return (float)sqrt(sum);
 }
 
 
@@ -221,24 +308,13 @@ sp_blas_snrm2_incx(
     len_t inc_x)
 {
     len_t ix = inc_x < 0 ? (len_t)((1 - n) * inc_x) : 0;
-    float scale = 0.0f;
-    float sq = 1.0f;
+    double sum = 0.0;
 
     for (len_t i = 0; i < n; i++) {
-        if (x[ix] != 0.0f) {
-            float absx = fabsf(x[ix]);
-            if (scale < absx) {
-                float tmp = scale / absx;
-                sq = 1.0f + sq * tmp * tmp;
-                scale = absx;
-            } else {
-                float tmp = absx / scale;
-                sq += tmp * tmp;
-            }
-        }
+        sum += (double)x[ix] * (double)x[ix];
         ix += inc_x;
     }
-    return scale * sqrtf(sq);
+    return (float)sqrt(sum);
 }
 
 
@@ -0,0 +1,433 @@
+#include <math.h>
+
+#include "snackpack/snackpack.h"
+#include "snackpack/internal/blas1_real_reduce.h"
+#include "snackpack/internal/threadpool.h"
+
+
+/* Number of chunks a reduction runs on the thread pool at the least. */
+#define SP_REDUCE_GRAIN (4)
+
+
+/*
+ * Arguments shared by the threads of one reduction. Chunk c covers
+ * elements [c * chunk, min((c + 1) * chunk, n)) and writes its result to
+ * entry c of the partial arrays. The fused saxpy_dot updates w += alpha*x
+ * and reduces w^T*y.
+ */
+typedef struct {
+    len_t n;
+    len_t chunk;
+    const float * x;
+    len_t inc_x;
+    const float * y;
+    len_t inc_y;
+    float * part;
+    double * dpart;
+    float alpha;
+    float * w;
+    len_t inc_w;
+} reduce_args;
+
+
+/* Chunk size for a vector of length n; a multiple of 16. */
+static len_t
+chunk_size(
+    len_t n)
+{
+    len_t chunk = (len_t)(((int64_t)n + SP_REDUCE_MAX_CHUNKS - 1) /
+        SP_REDUCE_MAX_CHUNKS);
+    chunk = (chunk + 15) / 16 * 16;
+    return chunk > SP_REDUCE_CHUNK ? chunk : SP_REDUCE_CHUNK;
+}
+
+
+/* Pointer to element i of a strided vector v of length n. */
+static inline const float *
+element(
+    const float * const v,
+    len_t n,
+    len_t inc,
+    len_t i)
+{
+    return v + (inc < 0 ? (len_t)((i + 1 - n) * inc) : i * inc);
+}
+
+
+/* Sum of 16 lanes, in a fixed order. */
+static inline float
+sum_lanes(
+    float acc[16])
+{
+    for (len_t s = 8; s > 0; s /= 2) {
+        for (len_t k = 0; k < s; k++) {
+            acc[k] += acc[k + s];
+        }
+    }
+    return acc[0];
+}
+
+
+static inline double
+sum_lanes_d(
+    double acc[16])
+{
+    for (len_t s = 8; s > 0; s /= 2) {
+        for (len_t k = 0; k < s; k++) {
+            acc[k] += acc[k + s];
+        }
+    }
+    return acc[0];
+}
+
+
+/*
+ * Sum entries [0, num) of a partial array in a fixed binary tree: pairs of
+ * neighbours first, then pairs of pairs, and so on.
+ */
+static float
+sum_tree(
+    float * const part,
+    len_t num)
+{
+    for (len_t s = 1; s < num; s *= 2) {
+        for (len_t i = 0; i + s < num; i += 2 * s) {
+            part[i] += part[i + s];
+        }
+    }
+    return part[0];
+}
+
+
+static double
+sum_tree_d(
+    double * const part,
+    len_t num)
+{
+    for (len_t s = 1; s < num; s *= 2) {
+        for (len_t i = 0; i + s < num; i += 2 * s) {
+            part[i] += part[i + s];
+        }
+    }
+    return part[0];
+}
+
+
+/*
+ * Run task over the chunks of a reduction, on the thread pool if there
+ * are enough of them.
+ */
+static void
+run_chunks(
+    sp_task_fn task,
+    reduce_args * const args)
+{
+    len_t num_chunks = (args->n + args->chunk - 1) / args->chunk;
+    sp_parallel_for(num_chunks, SP_REDUCE_GRAIN, task, args);
+}
+
+
+/*
+ * The chunk kernels below put element j of a chunk in lane j % 16. Inside
+ * a lane the elements are added in order. Leftover elements are summed
+ * into the first lanes in the same way.
+ */
+
+
+static void
+sasum_task(
+    void * arg,
+    len_t begin,
+    len_t end)
+{
+    const reduce_args * p = arg;
+
+    for (len_t c = begin; c < end; c++) {
+        len_t i0 = c * p->chunk;
+        len_t m = p->n - i0 < p->chunk ? p->n - i0 : p->chunk;
+        float acc[16] = {0.0f};
+
+        if (p->inc_x == 1) {
+            const float * x = p->x + i0;
+            len_t j = 0;
+            for (; j + 16 <= m; j += 16) {
+                for (len_t k = 0; k < 16; k++) {
+                    acc[k] += fabsf(x[j + k]);
+                }
+            }
+            for (len_t k = 0; j + k < m; k++) {
+                acc[k] += fabsf(x[j + k]);
+            }
+        } else {
+            for (len_t j = 0; j < m; j++) {
+                acc[j % 16] += fabsf(
+                    *element(p->x, p->n, p->inc_x, i0 + j));
+            }
+        }
+        p->part[c] = sum_lanes(acc);
+    }
+}
+
+
+static void
+sdot_task(
+    void * arg,
+    len_t begin,
+    len_t end)
+{
+    const reduce_args * p = arg;
+
+    for (len_t c = begin; c < end; c++) {
+        len_t i0 = c * p->chunk;
+        len_t m = p->n - i0 < p->chunk ? p->n - i0 : p->chunk;
+        float acc[16] = {0.0f};
+
+        if (p->inc_x == 1 && p->inc_y == 1) {
+            const float * x = p->x + i0;
+            const float * y = p->y + i0;
+            len_t j = 0;
+            for (; j + 16 <= m; j += 16) {
+                for (len_t k = 0; k < 16; k++) {
+                    acc[k] += x[j + k] * y[j + k];
+                }
+            }
+            for (len_t k = 0; j + k < m; k++) {
+                acc[k] += x[j + k] * y[j + k];
+            }
+        } else {
+            for (len_t j = 0; j < m; j++) {
+                acc[j % 16] += *element(p->x, p->n, p->inc_x, i0 + j) *
+                    *element(p->y, p->n, p->inc_y, i0 + j);
+            }
+        }
+        p->part[c] = sum_lanes(acc);
+    }
+}
+
+
+static void
+sdsdot_task(
+    void * arg,
+    len_t begin,
+    len_t end)
+{
+    const reduce_args * p = arg;
+
+    for (len_t c = begin; c < end; c++) {
+        len_t i0 = c * p->chunk;
+        len_t m = p->n - i0 < p->chunk ? p->n - i0 : p->chunk;
+        double acc[16] = {0.0};
+
+        if (p->inc_x == 1 && p->inc_y == 1) {
+            const float * x = p->x + i0;
+            const float * y = p->y + i0;
+            len_t j = 0;
+            for (; j + 16 <= m; j += 16) {
+                for (len_t k = 0; k < 16; k++) {
+                    acc[k] += (double)x[j + k] * (double)y[j + k];
+                }
+            }
+            for (len_t k = 0; j + k < m; k++) {
+                acc[k] += (double)x[j + k] * (double)y[j + k];
+            }
+        } else {
+            for (len_t j = 0; j < m; j++) {
+                acc[j % 16] +=
+                    (double)*element(p->x, p->n, p->inc_x, i0 + j) *
+                    (double)*element(p->y, p->n, p->inc_y, i0 + j);
+            }
+        }
+        p->dpart[c] = sum_lanes_d(acc);
+    }
+}
+
+
+static void
+saxpy_dot_task(
+    void * arg,
+    len_t begin,
+    len_t end)
+{
+    const reduce_args * p = arg;
+
+    for (len_t c = begin; c < end; c++) {
+        len_t i0 = c * p->chunk;
+        len_t m = p->n - i0 < p->chunk ? p->n - i0 : p->chunk;
+        float acc[16] = {0.0f};
+
+        if (p->inc_x == 1 && p->inc_w == 1 && p->inc_y == 1) {
+            const float * x = p->x + i0;
+            float * w = p->w + i0;
+            const float * y = p->y + i0;
+            len_t j = 0;
+            for (; j + 16 <= m; j += 16) {
+                for (len_t k = 0; k < 16; k++) {
+                    w[j + k] += p->alpha * x[j + k];
+                    acc[k] += w[j + k] * y[j + k];
+                }
+            }
+            for (len_t k = 0; j + k < m; k++) {
+                w[j + k] += p->alpha * x[j + k];
+                acc[k] += w[j + k] * y[j + k];
+            }
+        } else {
+            for (len_t j = 0; j < m; j++) {
+                float * w = (float *)element(p->w, p->n, p->inc_w, i0 + j);
+                *w += p->alpha * *element(p->x, p->n, p->inc_x, i0 + j);
+                acc[j % 16] += *w * *element(p->y, p->n, p->inc_y, i0 + j);
+            }
+        }
+        p->part[c] = sum_lanes(acc);
+    }
+}
+
+
+/* snrm2 chunks sum the squares in double precision, as sp_blas_snrm2_inc1. */
+static void
+snrm2_task(
+    void * arg,
+    len_t begin,
+    len_t end)
+{
+    const reduce_args * p = arg;
+
+    for (len_t c = begin; c < end; c++) {
+        len_t i0 = c * p->chunk;
+        len_t m = p->n - i0 < p->chunk ? p->n - i0 : p->chunk;
+        double acc[16] = {0.0};
+
+        if (p->inc_x == 1) {
+            const float * x = p->x + i0;
+            len_t j = 0;
+            for (; j + 16 <= m; j += 16) {
+                for (len_t k = 0; k < 16; k++) {
+                    acc[k] += (double)x[j + k] * (double)x[j + k];
+                }
+            }
+            for (len_t k = 0; j + k < m; k++) {
+                acc[k] += (double)x[j + k] * (double)x[j + k];
+            }
+        } else {
+            for (len_t j = 0; j < m; j++) {
+                double t = (double)*element(p->x, p->n, p->inc_x, i0 + j);
+                acc[j % 16] += t * t;
+            }
+        }
+        p->dpart[c] = sum_lanes_d(acc);
+    }
+}
+
+
+float
+sp_blas_sasum_reduce(
+    len_t n,
+    const float * const x,
+    len_t inc_x)
+{
+    float part[SP_REDUCE_MAX_CHUNKS];
+    reduce_args args = {
+        .n = n,
+        .chunk = chunk_size(n),
+        .x = x,
+        .inc_x = inc_x,
+        .part = part,
+    };
+    run_chunks(sasum_task, &args);
+    return sum_tree(part, (n + args.chunk - 1) / args.chunk);
+}
+
+
+float
+sp_blas_sdot_reduce(
+    len_t n,
+    const float * const x,
+    len_t inc_x,
+    const float * const y,
+    len_t inc_y)
+{
+    float part[SP_REDUCE_MAX_CHUNKS];
+    reduce_args args = {
+        .n = n,
+        .chunk = chunk_size(n),
+        .x = x,
+        .inc_x = inc_x,
+        .y = y,
+        .inc_y = inc_y,
+        .part = part,
+    };
+    run_chunks(sdot_task, &args);
+    return sum_tree(part, (n + args.chunk - 1) / args.chunk);
+}
+
+
+float
+sp_blas_sdsdot_reduce(
+    len_t n,
+    float sb,
+    const float * const x,
+    len_t inc_x,
+    const float * const y,
+    len_t inc_y)
+{
+    double dpart[SP_REDUCE_MAX_CHUNKS];
+    reduce_args args = {
+        .n = n,
+        .chunk = chunk_size(n),
+        .x = x,
+        .inc_x = inc_x,
+        .y = y,
+        .inc_y = inc_y,
+        .dpart = dpart,
+    };
+    run_chunks(sdsdot_task, &args);
+    return (float)((double)sb +
+        sum_tree_d(dpart, (n + args.chunk - 1) / args.chunk));
+}
+
+
+float
+sp_blas_snrm2_reduce(
+    len_t n,
+    const float * const x,
+    len_t inc_x)
+{
+    double dpart[SP_REDUCE_MAX_CHUNKS];
+    reduce_args args = {
+        .n = n,
+        .chunk = chunk_size(n),
+        .x = x,
+        .inc_x = inc_x,
+        .dpart = dpart,
+    };
+    run_chunks(snrm2_task, &args);
+    return (float)sqrt(sum_tree_d(dpart, (n + args.chunk - 1) / args.chunk));
+}
+
+
+float
+sp_blas_saxpy_dot_reduce(
+    len_t n,
+    float alpha,
+    const float * const x,
+    len_t inc_x,
+    float * const y,
+    len_t inc_y,
+    const float * const z,
+    len_t inc_z)
+{
+    float part[SP_REDUCE_MAX_CHUNKS];
+    reduce_args args = {
+        .n = n,
+        .chunk = chunk_size(n),
+        .x = x,
+        .inc_x = inc_x,
+        .y = z,
+        .inc_y = inc_z,
+        .part = part,
+        .alpha = alpha,
+        .w = y,
+        .inc_w = inc_y,
+    };
+    run_chunks(saxpy_dot_task, &args);
+    return sum_tree(part, (n + args.chunk - 1) / args.chunk);
+}
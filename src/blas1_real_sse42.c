@@ -0,0 +1,485 @@
+/*
+ * SSE4.2 versions of the unit-stride level 1 kernels. This file is compiled
+ * with -msse4.2. There is no masked load/store before AVX, so the tails are
+ * finished with scalar code.
+ */
+#if defined(__SSE4_2__)
+
+#include <math.h>
+#include <nmmintrin.h>
+
+#include "snackpack/snackpack.h"
+#include "snackpack/internal/blas1_real_simd.h"
+
+
+static inline float
+hsum(__m128 v)
+{
+    v = _mm_add_ps(v, _mm_movehl_ps(v, v));
+    v = _mm_add_ss(v, _mm_movehdup_ps(v));
+    return _mm_cvtss_f32(v);
+}
+
+
+static inline __m128
+vabs(__m128 v)
+{
+    return _mm_andnot_ps(_mm_set1_ps(-0.0f), v);
+}
+
+
+/* sasum for inc_x = 1 */
+float
+sp_blas_sasum_inc1_sse42(
+    len_t n,
+    const float * const x)
+{
+    float tmp = 0.0f;
+    len_t i = 0;
+    len_t head = sp_simd_align_head(x, 16, n);
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    __m128 acc2 = _mm_setzero_ps();
+    __m128 acc3 = _mm_setzero_ps();
+
+    for (; i < head; i++) {
+        tmp += fabsf(x[i]);
+    }
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm_add_ps(acc0, vabs(_mm_load_ps(x + i)));
+        acc1 = _mm_add_ps(acc1, vabs(_mm_load_ps(x + i + 4)));
+        acc2 = _mm_add_ps(acc2, vabs(_mm_load_ps(x + i + 8)));
+        acc3 = _mm_add_ps(acc3, vabs(_mm_load_ps(x + i + 12)));
+    }
+    for (; i + 4 <= n; i += 4) {
+        acc0 = _mm_add_ps(acc0, vabs(_mm_load_ps(x + i)));
+    }
+
+    acc0 = _mm_add_ps(_mm_add_ps(acc0, acc1), _mm_add_ps(acc2, acc3));
+    tmp += hsum(acc0);
+    for (; i < n; i++) {
+        tmp += fabsf(x[i]);
+    }
+    return tmp;
+}
+
+
+/* saxpy for inc_x = inc_y = 1 */
+void
+sp_blas_saxpy_inc1_sse42(
+    len_t n,
+    float alpha,
+    const float * const x,
+    float * const y)
+{
+    /* If alpha == 0, nothing to do */
+    if (alpha == 0.0f) {
+        return;
+    }
+
+    len_t i = 0;
+    len_t head = sp_simd_align_head(y, 16, n);
+    __m128 a = _mm_set1_ps(alpha);
+
+    for (; i < head; i++) {
+        y[i] += alpha * x[i];
+    }
+    for (; i + 16 <= n; i += 16) {
+        __m128 y0 = _mm_add_ps(_mm_load_ps(y + i),
+            _mm_mul_ps(a, _mm_loadu_ps(x + i)));
+        __m128 y1 = _mm_add_ps(_mm_load_ps(y + i + 4),
+            _mm_mul_ps(a, _mm_loadu_ps(x + i + 4)));
+        __m128 y2 = _mm_add_ps(_mm_load_ps(y + i + 8),
+            _mm_mul_ps(a, _mm_loadu_ps(x + i + 8)));
+        __m128 y3 = _mm_add_ps(_mm_load_ps(y + i + 12),
+            _mm_mul_ps(a, _mm_loadu_ps(x + i + 12)));
+        _mm_store_ps(y + i, y0);
+        _mm_store_ps(y + i + 4, y1);
+        _mm_store_ps(y + i + 8, y2);
+        _mm_store_ps(y + i + 12, y3);
+    }
+    for (; i + 4 <= n; i += 4) {
+        _mm_store_ps(y + i, _mm_add_ps(_mm_load_ps(y + i),
+            _mm_mul_ps(a, _mm_loadu_ps(x + i))));
+    }
+    for (; i < n; i++) {
+        y[i] += alpha * x[i];
+    }
+}
+
+
+/* sdot for inc_x = inc_y = 1 */
+float
+sp_blas_sdot_inc1_sse42(
+    len_t n,
+    const float * const x,
+    const float * const y)
+{
+    float tmp = 0.0f;
+    len_t i = 0;
+    len_t head = sp_simd_align_head(x, 16, n);
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    __m128 acc2 = _mm_setzero_ps();
+    __m128 acc3 = _mm_setzero_ps();
+
+    for (; i < head; i++) {
+        tmp += x[i] * y[i];
+    }
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm_add_ps(acc0,
+            _mm_mul_ps(_mm_load_ps(x + i), _mm_loadu_ps(y + i)));
+        acc1 = _mm_add_ps(acc1,
+            _mm_mul_ps(_mm_load_ps(x + i + 4), _mm_loadu_ps(y + i + 4)));
+        acc2 = _mm_add_ps(acc2,
+            _mm_mul_ps(_mm_load_ps(x + i + 8), _mm_loadu_ps(y + i + 8)));
+        acc3 = _mm_add_ps(acc3,
+            _mm_mul_ps(_mm_load_ps(x + i + 12), _mm_loadu_ps(y + i + 12)));
+    }
+    for (; i + 4 <= n; i += 4) {
+        acc0 = _mm_add_ps(acc0,
+            _mm_mul_ps(_mm_load_ps(x + i), _mm_loadu_ps(y + i)));
+    }
+
+    acc0 = _mm_add_ps(_mm_add_ps(acc0, acc1), _mm_add_ps(acc2, acc3));
+    tmp += hsum(acc0);
+    for (; i < n; i++) {
+        tmp += x[i] * y[i];
+    }
+    return tmp;
+}
+
+
+/* srot for inc_x = inc_y = 1 */
+void
+sp_blas_srot_inc1_sse42(
+    len_t n,
+    float * const x,
+    float * const y,
+    float c,
+    float s)
+{
+    len_t i = 0;
+    len_t head = sp_simd_align_head(x, 16, n);
+    __m128 vc = _mm_set1_ps(c);
+    __m128 vs = _mm_set1_ps(s);
+
+    for (; i < head; i++) {
+        float tmp = c * x[i] + s * y[i];
+        y[i] = c * y[i] - s * x[i];
+        x[i] = tmp;
+    }
+    for (; i + 8 <= n; i += 8) {
+        __m128 x0 = _mm_load_ps(x + i);
+        __m128 x1 = _mm_load_ps(x + i + 4);
+        __m128 y0 = _mm_loadu_ps(y + i);
+        __m128 y1 = _mm_loadu_ps(y + i + 4);
+        _mm_store_ps(x + i,
+            _mm_add_ps(_mm_mul_ps(vc, x0), _mm_mul_ps(vs, y0)));
+        _mm_store_ps(x + i + 4,
+            _mm_add_ps(_mm_mul_ps(vc, x1), _mm_mul_ps(vs, y1)));
+        _mm_storeu_ps(y + i,
+            _mm_sub_ps(_mm_mul_ps(vc, y0), _mm_mul_ps(vs, x0)));
+        _mm_storeu_ps(y + i + 4,
+            _mm_sub_ps(_mm_mul_ps(vc, y1), _mm_mul_ps(vs, x1)));
+    }
+    for (; i < n; i++) {
+        float tmp = c * x[i] + s * y[i];
+        y[i] = c * y[i] - s * x[i];
+        x[i] = tmp;
+    }
+}
+
+
+/* sscal for inc = 1 */
+void
+sp_blas_sscal_inc1_sse42(
+    len_t n,
+    float alpha,
+    float * const x)
+{
+    len_t i = 0;
+    len_t head = sp_simd_align_head(x, 16, n);
+
+    if (alpha == 0.0f) {
+        __m128 zero = _mm_setzero_ps();
+        for (; i < head; i++) {
+            x[i] = 0.0f;
+        }
+        for (; i + 4 <= n; i += 4) {
+            _mm_store_ps(x + i, zero);
+        }
+        for (; i < n; i++) {
+            x[i] = 0.0f;
+        }
+        return;
+    }
+
+    __m128 a = _mm_set1_ps(alpha);
+    for (; i < head; i++) {
+        x[i] *= alpha;
+    }
+    for (; i + 16 <= n; i += 16) {
+        _mm_store_ps(x + i, _mm_mul_ps(a, _mm_load_ps(x + i)));
+        _mm_store_ps(x + i + 4, _mm_mul_ps(a, _mm_load_ps(x + i + 4)));
+        _mm_store_ps(x + i + 8, _mm_mul_ps(a, _mm_load_ps(x + i + 8)));
+        _mm_store_ps(x + i + 12, _mm_mul_ps(a, _mm_load_ps(x + i + 12)));
+    }
+    for (; i + 4 <= n; i += 4) {
+        _mm_store_ps(x + i, _mm_mul_ps(a, _mm_load_ps(x + i)));
+    }
+    for (; i < n; i++) {
+        x[i] *= alpha;
+    }
+}
+
+
+/* scopy for inc_x, inc_y = 1 */
+void
+sp_blas_scopy_inc1_sse42(
+    len_t n,
+    const float * const x,
+    float * const y)
+{
+    len_t i = 0;
+    len_t head = sp_simd_align_head(y, 16, n);
+
+    for (; i < head; i++) {
+        y[i] = x[i];
+    }
+    for (; i + 16 <= n; i += 16) {
+        __m128 v0 = _mm_loadu_ps(x + i);
+        __m128 v1 = _mm_loadu_ps(x + i + 4);
+        __m128 v2 = _mm_loadu_ps(x + i + 8);
+        __m128 v3 = _mm_loadu_ps(x + i + 12);
+        _mm_store_ps(y + i, v0);
+        _mm_store_ps(y + i + 4, v1);
+        _mm_store_ps(y + i + 8, v2);
+        _mm_store_ps(y + i + 12, v3);
+    }
+    for (; i + 4 <= n; i += 4) {
+        _mm_store_ps(y + i, _mm_loadu_ps(x + i));
+    }
+    for (; i < n; i++) {
+        y[i] = x[i];
+    }
+}
+
+
+/* sswap for inc_x = inc_y = 1 */
+void
+sp_blas_sswap_inc1_sse42(
+    len_t n,
+    float * const x,
+    float * const y)
+{
+    len_t i = 0;
+    len_t head = sp_simd_align_head(x, 16, n);
+
+    for (; i < head; i++) {
+        float tmp = x[i];
+        x[i] = y[i];
+        y[i] = tmp;
+    }
+    for (; i + 8 <= n; i += 8) {
+        __m128 x0 = _mm_load_ps(x + i);
+        __m128 x1 = _mm_load_ps(x + i + 4);
+        __m128 y0 = _mm_loadu_ps(y + i);
+        __m128 y1 = _mm_loadu_ps(y + i + 4);
+        _mm_store_ps(x + i, y0);
+        _mm_store_ps(x + i + 4, y1);
+        _mm_storeu_ps(y + i, x0);
+        _mm_storeu_ps(y + i + 4, x1);
+    }
+    for (; i < n; i++) {
+        float tmp = x[i];
+        x[i] = y[i];
+        y[i] = tmp;
+    }
+}
+
+
+/* snrm2 for inc_x = 1, summing squares in double precision */
+float
+sp_blas_snrm2_inc1_sse42(
+    len_t n,
+    const float * const x)
+{
+    double tmp = 0.0;
+    len_t i = 0;
+    len_t head = sp_simd_align_head(x, 16, n);
+    __m128d acc0 = _mm_setzero_pd();
+    __m128d acc1 = _mm_setzero_pd();
+    __m128d acc2 = _mm_setzero_pd();
+    __m128d acc3 = _mm_setzero_pd();
+
+    for (; i < head; i++) {
+        tmp += (double)x[i] * (double)x[i];
+    }
+    for (; i + 8 <= n; i += 8) {
+        __m128 v0 = _mm_load_ps(x + i);
+        __m128 v1 = _mm_load_ps(x + i + 4);
+        __m128d d0 = _mm_cvtps_pd(v0);
+        __m128d d1 = _mm_cvtps_pd(_mm_movehl_ps(v0, v0));
+        __m128d d2 = _mm_cvtps_pd(v1);
+        __m128d d3 = _mm_cvtps_pd(_mm_movehl_ps(v1, v1));
+        acc0 = _mm_add_pd(acc0, _mm_mul_pd(d0, d0));
+        acc1 = _mm_add_pd(acc1, _mm_mul_pd(d1, d1));
+        acc2 = _mm_add_pd(acc2, _mm_mul_pd(d2, d2));
+        acc3 = _mm_add_pd(acc3, _mm_mul_pd(d3, d3));
+    }
+
+    acc0 = _mm_add_pd(_mm_add_pd(acc0, acc1), _mm_add_pd(acc2, acc3));
+    tmp += _mm_cvtsd_f64(_mm_add_sd(acc0, _mm_unpackhi_pd(acc0, acc0)));
+    for (; i < n; i++) {
+        tmp += (double)x[i] * (double)x[i];
+    }
+    return (float)sqrt(tmp);
+}
+
+
+/*
+ * isamax (or isamin, if is_min) for inc_x = 1. Each lane keeps the best
+ * magnitude it has seen and the index it was found at. A lane only moves
+ * on a strict improvement, so it holds the first occurrence of its best
+ * value. Two sets of lanes hide the latency of the compare-and-blend
+ * chain. NaN never compares better, except that a NaN in x[0] is returned
+ * as in the scalar kernels.
+ */
+static inline len_t
+iamax(
+    len_t n,
+    const float * const x,
+    bool is_min)
+{
+    if (x[0] != x[0]) {
+        return 0;
+    }
+
+    __m128 init = _mm_set1_ps(is_min ? INFINITY : -1.0f);
+    __m128 best0 = init, best1 = init;
+    __m128i idx0 = _mm_setzero_si128(), idx1 = _mm_setzero_si128();
+    __m128i cur = _mm_setr_epi32(0, 1, 2, 3);
+    len_t i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        __m128 v0 = vabs(_mm_loadu_ps(x + i));
+        __m128 v1 = vabs(_mm_loadu_ps(x + i + 4));
+        __m128 m0 = is_min ? _mm_cmplt_ps(v0, best0) : _mm_cmplt_ps(best0, v0);
+        __m128 m1 = is_min ? _mm_cmplt_ps(v1, best1) : _mm_cmplt_ps(best1, v1);
+        best0 = _mm_blendv_ps(best0, v0, m0);
+        best1 = _mm_blendv_ps(best1, v1, m1);
+        idx0 = _mm_blendv_epi8(idx0, cur, _mm_castps_si128(m0));
+        idx1 = _mm_blendv_epi8(idx1, _mm_add_epi32(cur, _mm_set1_epi32(4)),
+            _mm_castps_si128(m1));
+        cur = _mm_add_epi32(cur, _mm_set1_epi32(8));
+    }
+
+    float val[8];
+    int32_t idx[8];
+    _mm_storeu_ps(val, best0);
+    _mm_storeu_ps(val + 4, best1);
+    _mm_storeu_si128((__m128i *)idx, idx0);
+    _mm_storeu_si128((__m128i *)(idx + 4), idx1);
+    float b;
+    len_t ib = sp_simd_pick_lane(val, idx, 8, is_min, &b);
+    for (; i < n; i++) {
+        float a = fabsf(x[i]);
+        if (is_min ? a < b : a > b) {
+            b = a;
+            ib = i;
+        }
+    }
+    return ib;
+}
+
+
+/* isamax for inc_x = 1 */
+len_t
+sp_blas_isamax_inc1_sse42(
+    len_t n,
+    const float * const x)
+{
+    return iamax(n, x, false);
+}
+
+
+/* isamin for inc_x = 1 */
+len_t
+sp_blas_isamin_inc1_sse42(
+    len_t n,
+    const float * const x)
+{
+    return iamax(n, x, true);
+}
+
+/* saxpy_dot for inc_x = inc_y = inc_z = 1 */
+float
+sp_blas_saxpy_dot_inc1_sse42(
+    len_t n,
+    float alpha,
+    const float * const x,
+    float * const y,
+    const float * const z)
+{
+    float tmp = 0.0f;
+    len_t i = 0;
+    len_t head = sp_simd_align_head(y, 16, n);
+    __m128 a = _mm_set1_ps(alpha);
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+
+    for (; i < head; i++) {
+        y[i] += alpha * x[i];
+        tmp += y[i] * z[i];
+    }
+    for (; i + 8 <= n; i += 8) {
+        __m128 y0 = _mm_add_ps(_mm_load_ps(y + i),
+            _mm_mul_ps(a, _mm_loadu_ps(x + i)));
+        __m128 y1 = _mm_add_ps(_mm_load_ps(y + i + 4),
+            _mm_mul_ps(a, _mm_loadu_ps(x + i + 4)));
+        _mm_store_ps(y + i, y0);
+        _mm_store_ps(y + i + 4, y1);
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(y0, _mm_loadu_ps(z + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(y1, _mm_loadu_ps(z + i + 4)));
+    }
+
+    tmp += hsum(_mm_add_ps(acc0, acc1));
+    for (; i < n; i++) {
+        y[i] += alpha * x[i];
+        tmp += y[i] * z[i];
+    }
+    return tmp;
+}
+
+
+/* scopy_scal for inc_x = inc_y = 1 */
+void
+sp_blas_scopy_scal_inc1_sse42(
+    len_t n,
+    float alpha,
+    const float * const x,
+    float * const y)
+{
+    len_t i = 0;
+    len_t head = sp_simd_align_head(y, 16, n);
+    __m128 a = _mm_set1_ps(alpha);
+
+    for (; i < head; i++) {
+        y[i] = alpha * x[i];
+    }
+    for (; i + 16 <= n; i += 16) {
+        _mm_store_ps(y + i, _mm_mul_ps(a, _mm_loadu_ps(x + i)));
+        _mm_store_ps(y + i + 4, _mm_mul_ps(a, _mm_loadu_ps(x + i + 4)));
+        _mm_store_ps(y + i + 8, _mm_mul_ps(a, _mm_loadu_ps(x + i + 8)));
+        _mm_store_ps(y + i + 12, _mm_mul_ps(a, _mm_loadu_ps(x + i + 12)));
+    }
+    for (; i + 4 <= n; i += 4) {
+        _mm_store_ps(y + i, _mm_mul_ps(a, _mm_loadu_ps(x + i)));
+    }
+    for (; i < n; i++) {
+        y[i] = alpha * x[i];
+    }
+}
+
+#endif
@@ -1,9 +1,287 @@
 #include "snackpack/blas2_real.h"
 #include "snackpack/blas1_real.h"
 #include "snackpack/internal/blas1_real_internal.h"
+#include "snackpack/internal/blas2_real_internal.h"
+#include "snackpack/internal/dispatch.h"
+#include "snackpack/internal/threadpool.h"
 #include "snackpack/error.h"
 
 
+/*
+ * Pointer to the part of a strided vector v of length len that holds
+ * elements [begin, end), such that it can be passed on as a vector of
+ * length end - begin with the same increment.
+ */
+static inline float *
+sub_vector(
+    float * const v,
+    len_t len,
+    len_t inc,
+    len_t begin,
+    len_t end)
+{
+    return v + (inc < 0 ? (len_t)((end - len) * inc) : begin * inc);
+}
+
+
+/* Single-threaded sgemv for A*x, any increments. */
+void
+sp_blas_sgemv_n_incxy(
+    len_t rows,
+    len_t cols,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    const float * const x,
+    len_t inc_x,
+    float beta,
+    float * const y,
+    len_t inc_y)
+{
+    /* beta is applied by the kernel in the same pass as A*x. */
+    if (inc_y == 1) {
+        sp_kernels.sgemv_n_inc1(
+            rows, cols, alpha, A, lda, x, inc_x, beta, y);
+        return;
+    }
+
+    /* Gather y into a contiguous block, run the unit-stride kernel on the
+     * matching rows of A and scatter the result back.
+     */
+    float y_block[SP_SGEMV_ROW_BLOCK];
+    len_t iy = inc_y < 0 ? (len_t)((1 - rows) * inc_y) : 0;
+    for (len_t r0 = 0; r0 < rows; r0 += SP_SGEMV_ROW_BLOCK) {
+        len_t mb = rows - r0 < SP_SGEMV_ROW_BLOCK ?
+            rows - r0 : SP_SGEMV_ROW_BLOCK;
+        for (len_t j = 0; j < mb; j++) {
+            y_block[j] = y[iy + j * inc_y];
+        }
+        sp_kernels.sgemv_n_inc1(
+            mb, cols, alpha, A + r0, lda, x, inc_x, beta, y_block);
+        for (len_t j = 0; j < mb; j++) {
+            y[iy + j * inc_y] = y_block[j];
+        }
+        iy += mb * inc_y;
+    }
+}
+
+
+/* Single-threaded sgemv for A^T*x, any increments. */
+void
+sp_blas_sgemv_t_incxy(
+    len_t rows,
+    len_t cols,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    const float * const x,
+    len_t inc_x,
+    float beta,
+    float * const y,
+    len_t inc_y)
+{
+    /* beta is applied by the kernel in the same pass as A^T*x. */
+    if (inc_x == 1) {
+        sp_kernels.sgemv_t_inc1(
+            rows, cols, alpha, A, lda, x, beta, y, inc_y);
+        return;
+    }
+
+    /* Pack x into a contiguous block and accumulate the dot products one
+     * block of rows at a time. beta only applies to the first block.
+     */
+    float x_block[SP_SGEMV_ROW_BLOCK];
+    len_t ix = inc_x < 0 ? (len_t)((1 - rows) * inc_x) : 0;
+    float b = beta;
+    for (len_t r0 = 0; r0 < rows; r0 += SP_SGEMV_ROW_BLOCK) {
+        len_t mb = rows - r0 < SP_SGEMV_ROW_BLOCK ?
+            rows - r0 : SP_SGEMV_ROW_BLOCK;
+        for (len_t j = 0; j < mb; j++) {
+            x_block[j] = x[ix + j * inc_x];
+        }
+        sp_kernels.sgemv_t_inc1(
+            mb, cols, alpha, A + r0, lda, x_block, b, y, inc_y);
+        ix += mb * inc_x;
+        b = 1.0f;
+    }
+}
+
+
+/* Arguments to sgemv shared by all threads. */
+typedef struct {
+    len_t rows;
+    len_t cols;
+    float alpha;
+    const float * A;
+    len_t lda;
+    const float * x;
+    len_t inc_x;
+    float beta;
+    float * y;
+    len_t inc_y;
+} sgemv_args;
+
+
+/*
+ * Threaded A*x: each thread computes a block of rows of y, counted in
+ * units of SP_SGEMV_PARALLEL_ROWS.
+ */
+static void
+sgemv_n_task(
+    void * arg,
+    len_t begin,
+    len_t end)
+{
+    const sgemv_args * p = arg;
+    len_t r0 = begin * SP_SGEMV_PARALLEL_ROWS;
+    len_t r1 = end * SP_SGEMV_PARALLEL_ROWS;
+    if (r1 > p->rows) {
+        r1 = p->rows;
+    }
+
+    sp_blas_sgemv_n_incxy(r1 - r0, p->cols, p->alpha, p->A + r0, p->lda,
+        p->x, p->inc_x, p->beta, sub_vector(p->y, p->rows, p->inc_y, r0, r1),
+        p->inc_y);
+}
+
+
+/* Threaded A^T*x: each thread computes a range of entries of y. */
+static void
+sgemv_t_task(
+    void * arg,
+    len_t begin,
+    len_t end)
+{
+    const sgemv_args * p = arg;
+
+    sp_blas_sgemv_t_incxy(p->rows, end - begin, p->alpha,
+        p->A + begin * p->lda, p->lda, p->x, p->inc_x, p->beta,
+        sub_vector(p->y, p->cols, p->inc_y, begin, end), p->inc_y);
+}
+
+
+/*
+ * y = beta*y. A zero beta stores zeros rather than scaling, so that NaN in
+ * y is cleared.
+ */
+void
+sp_blas_scale_y(
+    len_t len_y,
+    float beta,
+    float * const y,
+    len_t inc_y)
+{
+    if (beta == 1.0f) {
+        return;
+    } else if (beta != 0.0f) {
+        if (inc_y == 1) {
+            sp_kernels.sscal_inc1(len_y, beta, y);
+        } else {
+            sp_blas_sscal_incx(len_y, beta, y, inc_y);
+        }
+        return;
+    }
+
+    len_t iy = inc_y < 0 ? (len_t)((1 - len_y) * inc_y) : 0;
+    for (len_t i = 0; i < len_y; i++) {
+        y[iy] = 0.0f;
+        iy += inc_y;
+    }
+}
+
+
+/*
+ * sgemv after argument checks. Also used for the panel updates of the
+ * blocked triangular routines, which may pass an empty A.
+ */
+static void
+sgemv(
+    bool is_trans,
+    len_t rows,
+    len_t cols,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    const float * const x,
+    len_t inc_x,
+    float beta,
+    float * const y,
+    len_t inc_y)
+{
+    /* Determine the length of the y vector.*/
+    len_t len_y = is_trans ? cols : rows;
+
+    /* An empty product leaves beta * y. */
+    if (rows == 0 || cols == 0) {
+        alpha = 0.0f;
+    }
+
+    /* If alpha is 0, all that's left is beta * y. */
+    if (alpha == 0.0f) {
+        sp_blas_scale_y(len_y, beta, y, inc_y);
+        return;
+    }
+
+    if ((int64_t)rows * cols < SP_SGEMV_PARALLEL_MIN) {
+        if (is_trans) {
+            sp_blas_sgemv_t_incxy(
+                rows, cols, alpha, A, lda, x, inc_x, beta, y, inc_y);
+        } else {
+            sp_blas_sgemv_n_incxy(
+                rows, cols, alpha, A, lda, x, inc_x, beta, y, inc_y);
+        }
+        return;
+    }
+
+    sp_blas_sgemv_parallel(
+        is_trans, rows, cols, alpha, A, lda, x, inc_x, beta, y, inc_y);
+}
+
+
+/*
+ * Threaded sgemv. Each thread gets at least SP_SGEMV_PARALLEL_MIN of work,
+ * so small products run on the calling thread.
+ */
+void
+sp_blas_sgemv_parallel(
+    bool is_trans,
+    len_t rows,
+    len_t cols,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    const float * const x,
+    len_t inc_x,
+    float beta,
+    float * const y,
+    len_t inc_y)
+{
+    sgemv_args args = {
+        .rows = rows,
+        .cols = cols,
+        .alpha = alpha,
+        .A = A,
+        .lda = lda,
+        .x = x,
+        .inc_x = inc_x,
+        .beta = beta,
+        .y = y,
+        .inc_y = inc_y,
+    };
+    if (is_trans) {
+        len_t grain = SP_SGEMV_PARALLEL_MIN / rows + 1;
+        sp_parallel_for(cols, grain, sgemv_t_task, &args);
+    } else {
+        len_t num_pieces = (rows + SP_SGEMV_PARALLEL_ROWS - 1) /
+            SP_SGEMV_PARALLEL_ROWS;
+        /* At most SP_SGEMV_PARALLEL_MIN / SP_SGEMV_PARALLEL_ROWS + 1. */
+        len_t grain = (len_t)(SP_SGEMV_PARALLEL_MIN /
+            ((int64_t)SP_SGEMV_PARALLEL_ROWS * cols)) + 1;
+        sp_parallel_for(num_pieces, grain, sgemv_n_task, &args);
+    }
+}
+
+
 /**
  * Compute a general matrix-vector product.
  *
@@ -25,6 +303,11 @@
  * \param[in] beta      Scalar beta
  * \param[in,out] y     Vector y, stores result
  * \param[in] inc_y     Increment (stride) for y
+ *
+ * Products with at least SP_SGEMV_PARALLEL_MIN entries in A are split
+ * across the thread pool: by blocks of rows for A*x and by entries of y for
+ * A^T*x. Neither needs a reduction, so the result does not depend on the
+ * number of threads.
  */
 void
 sp_blas_sgemv(
@@ -46,95 +329,192 @@ sp_blas_sgemv(
     SP_ASSERT_VALID_INC(inc_x);
     SP_ASSERT_VALID_INC(inc_y);
 
-    /* Determine the lengths of the x and y vectors.*/
-    len_t len_x, len_y;
-    if (is_trans) {
-        len_x = rows;
-        len_y = cols;
-    } else {
-        len_x = cols;
-        len_y = rows;
-    }
+    sgemv(is_trans, rows, cols, alpha, A, lda, x, inc_x, beta, y, inc_y);
 
-    /* Save some flops if we're all 0. */
-    if (alpha == 0.0f && beta == 0.0f) {
-        if (inc_y == 1) {
-            for (len_t i = 0; i < len_y; i++) {
-                y[i] = 0.0f;
-            }
-            return;
-        } else {
-            len_t iy = inc_y < 0 ? (len_t)((1 - len_y) * inc_y) : 0;
-            for (len_t i = 0; i < len_y; i++) {
-                y[iy] = 0.0f;
-                iy += inc_y;
+fail:
+    return;
+}
+
+
+/* Arguments to sger shared by all threads. */
+typedef struct {
+    len_t rows;
+    len_t cols;
+    float alpha;
+    const float * x;
+    len_t inc_x;
+    const float * y;
+    len_t inc_y;
+    float * A;
+    len_t lda;
+} sger_args;
+
+
+/*
+ * Rank-1 update of columns [begin, end) of A. The columns are done
+ * SP_SGER_COL_BLOCK at a time: alpha * y for them is gathered into a
+ * contiguous buffer, and a strided x is packed SP_SGEMV_ROW_BLOCK rows at
+ * a time, so the dispatched kernel only ever sees unit strides.
+ */
+static void
+sger_task(
+    void * arg,
+    len_t begin,
+    len_t end)
+{
+    const sger_args * p = arg;
+    float t[SP_SGER_COL_BLOCK];
+    float x_block[SP_SGEMV_ROW_BLOCK];
+
+    len_t iy = p->inc_y < 0 ? (len_t)((1 - p->cols) * p->inc_y) : 0;
+
+    for (len_t c0 = begin; c0 < end; c0 += SP_SGER_COL_BLOCK) {
+        len_t nc = end - c0 < SP_SGER_COL_BLOCK ? end - c0 : SP_SGER_COL_BLOCK;
+        for (len_t j = 0; j < nc; j++) {
+            t[j] = p->alpha * p->y[iy + (c0 + j) * p->inc_y];
+        }
+
+        if (p->inc_x == 1) {
+            sp_kernels.sger_inc1(p->rows, nc, p->x, t, p->A + c0 * p->lda,
+                p->lda);
+            continue;
+        }
+
+        len_t ix = p->inc_x < 0 ? (len_t)((1 - p->rows) * p->inc_x) : 0;
+        for (len_t r0 = 0; r0 < p->rows; r0 += SP_SGEMV_ROW_BLOCK) {
+            len_t mb = p->rows - r0 < SP_SGEMV_ROW_BLOCK ?
+                p->rows - r0 : SP_SGEMV_ROW_BLOCK;
+            for (len_t i = 0; i < mb; i++) {
+                x_block[i] = p->x[ix + i * p->inc_x];
             }
-            return;
+            sp_kernels.sger_inc1(mb, nc, x_block, t,
+                p->A + r0 + c0 * p->lda, p->lda);
+            ix += mb * p->inc_x;
         }
     }
+}
 
-    /* First, find beta * y */
-    if (inc_y == 1) {
-        sp_blas_sscal_inc1(len_y, beta, y);
-    } else {
-        sp_blas_sscal_incx(len_y, beta, y, inc_y);
-    }
 
-    /* If alpha is 0, we're done. */
+/**
+ * Perform a rank-1 update of a general matrix.
+ *
+ * Performs the operation
+ *
+ *      A = alpha*x*y^T + A
+ *
+ * \param[in] rows      Number of rows in A
+ * \param[in] cols      Number of columns in A
+ * \param[in] alpha     Scalar alpha
+ * \param[in] x         Vector x, of length rows
+ * \param[in] inc_x     Increment (stride) for x
+ * \param[in] y         Vector y, of length cols
+ * \param[in] inc_y     Increment (stride) for y
+ * \param[in,out] A     Matrix A
+ * \param[in] lda       Leading dimension of A - must be at least
+ *                      max(1, rows)
+ *
+ * Updates with at least SP_SGEMV_PARALLEL_MIN entries in A are split
+ * across the thread pool by blocks of columns, so every entry of A is
+ * written by one thread only.
+ */
+void
+sp_blas_sger(
+    len_t rows,
+    len_t cols,
+    float alpha,
+    const float * const x,
+    len_t inc_x,
+    const float * const y,
+    len_t inc_y,
+    float * const A,
+    len_t lda)
+{
+    SP_ASSERT_VALID_DIM(rows);
+    SP_ASSERT_VALID_DIM(cols);
+    SP_ASSERT_VALID_LDA(lda, rows);
+    SP_ASSERT_VALID_INC(inc_x);
+    SP_ASSERT_VALID_INC(inc_y);
+
     if (alpha == 0.0f) {
         return;
     }
 
-    if (!is_trans) {
-        if (inc_x == 1 && inc_y == 1) {
-            for (len_t i = 0; i < len_x; i++) {
-                float tmp = x[i] * alpha;
-                len_t a_offset = i * lda;
-                for (len_t j = 0; j < len_y; j++) {
-                    y[j] += A[j + a_offset] * tmp;
-                }
+    sger_args args = {
+        .rows = rows,
+        .cols = cols,
+        .alpha = alpha,
+        .x = x,
+        .inc_x = inc_x,
+        .y = y,
+        .inc_y = inc_y,
+        .A = A,
+        .lda = lda,
+    };
+
+    /* Each thread gets at least SP_SGEMV_PARALLEL_MIN of work. */
+    len_t grain = SP_SGEMV_PARALLEL_MIN / rows + 1;
+    sp_parallel_for(cols, grain, sger_task, &args);
+
+fail:
+    return;
+}
+
+/*
+ * x = op(T)*x for a diagonal block T of order nb and a contiguous x. The
+ * loops run in the order that reads every entry of x before it is
+ * overwritten.
+ */
+static void
+strmv_block(
+    bool is_upper,
+    bool is_trans,
+    bool is_unit,
+    len_t nb,
+    const float * const A,
+    len_t lda,
+    float * const x)
+{
+    if (is_upper && !is_trans) {
+        for (len_t j = 0; j < nb; j++) {
+            const float * a = A + j * lda;
+            float t = x[j];
+            for (len_t i = 0; i < j; i++) {
+                x[i] += a[i] * t;
             }
-        } else {
-            len_t ix = inc_x < 0 ? (len_t)((1 - len_x) * inc_x) : 0;
-            for (len_t i = 0; i < len_x; i++) {
-                float tmp = x[ix] * alpha;
-                len_t a_offset = i * lda;
-                len_t iy = inc_y < 0 ? (len_t)((1 - len_y) * inc_y) : 0;
-                for (len_t j = 0; j < len_y; j++) {
-                    y[iy] += A[j + a_offset] * tmp;
-                    iy += inc_y;
-                }
-                ix += inc_x;
+            if (!is_unit) {
+                x[j] *= a[j];
             }
         }
-    } else {
-        if (inc_x == 1 && inc_y == 1) {
-            for (len_t i = 0; i < len_y; i++) {
-                float tmp = 0.0f;
-                len_t a_offset = i * lda;
-                for (len_t j = 0; j < len_x; j++) {
-                    tmp += A[j + a_offset] * x[j];
-                }
-                y[i] += alpha * tmp;
+    } else if (is_upper) {
+        for (len_t j = nb - 1; j >= 0; j--) {
+            const float * a = A + j * lda;
+            float s = is_unit ? x[j] : a[j] * x[j];
+            for (len_t i = 0; i < j; i++) {
+                s += a[i] * x[i];
             }
-        } else {
-            len_t iy = inc_y < 0 ? (len_t)((1 - len_y) * inc_y) : 0;
-            for (len_t i = 0; i < len_y; i++) {
-                float tmp = 0.0f;
-                len_t a_offset = i * lda;
-                len_t ix = inc_x < 0 ? (len_t)((1 - len_x) * inc_x) : 0;
-                for (len_t j = 0; j < len_x; j++) {
-                    tmp += A[j + a_offset] * x[ix];
-                    ix += inc_x;
-                }
-                y[iy] += alpha * tmp;
-                iy += inc_y;
+            x[j] = s;
+        }
+    } else if (!is_trans) {
+        for (len_t j = nb - 1; j >= 0; j--) {
+            const float * a = A + j * lda;
+            float t = x[j];
+            for (len_t i = j + 1; i < nb; i++) {
+                x[i] += a[i] * t;
+            }
+            if (!is_unit) {
+                x[j] *= a[j];
+            }
+        }
+    } else {
+        for (len_t j = 0; j < nb; j++) {
+            const float * a = A + j * lda;
+            float s = is_unit ? x[j] : a[j] * x[j];
+            for (len_t i = j + 1; i < nb; i++) {
+                s += a[i] * x[i];
             }
+            x[j] = s;
         }
     }
-
-fail:
-    return;
 }
 
 
@@ -155,6 +535,12 @@ fail:
  * \param[in,out] x     On enter, vector x to multiply. On exit, result.
  *                      Must have dimension at least 1 + (n - 1) * |inc_x|.
  * \param[in] inc_x     Increment of x
+ *
+ * x is cut into blocks of SP_STRMV_BLOCK. Each block is first multiplied
+ * by its diagonal block of A, then the rectangle of A beside the diagonal
+ * block adds in the blocks of x that have not been overwritten yet, using
+ * sgemv. The blocks are visited top-down when x_i depends on the entries
+ * below it (upper, or lower transposed) and bottom-up otherwise.
  */
 void
 sp_blas_strmv(
@@ -171,37 +557,40 @@ sp_blas_strmv(
     SP_ASSERT_VALID_LDA(lda, n);
     SP_ASSERT_VALID_INC(inc_x);
 
-    if (is_trans) {
-    } else {
-        if (is_upper) {
-            if (inc_x == 1) {
-                for (len_t i = 0; i < n; i++) {
-                    float tmp = x[i];
-                    len_t a_offset = i * lda;
-                    for (len_t j = 0; j < i; j++) {
-                        x[j] += A[j + a_offset] * tmp;
-                    }
-                    if (!is_unit) {
-                        x[i] *= A[i + a_offset];
-                    }
-                }
-            } else {
-                len_t ix = inc_x < 0 ? (len_t)((1 - n) * inc_x) : 0;
-                for (len_t i = 0; i < n; i++) {
-                    float tmp = x[ix];
-                    len_t a_offset = i * lda;
-                    len_t jx = inc_x < 0 ? (len_t)((1 - n) * inc_x) : 0;
-                    for (len_t j = 0; j < i; j++) {
-                        x[jx] += A[j + a_offset] * tmp;
-                        jx += inc_x;
-                    }
-                    if (!is_unit) {
-                        x[ix] *= A[i + a_offset];
-                    }
-                    ix += inc_x;
-                }
-            }
+    bool is_top_down = is_upper != is_trans;
+    len_t num_blocks = (n + SP_STRMV_BLOCK - 1) / SP_STRMV_BLOCK;
+    float x_block[SP_STRMV_BLOCK];
+
+    for (len_t b = 0; b < num_blocks; b++) {
+        len_t i0 = (is_top_down ? b : num_blocks - 1 - b) * SP_STRMV_BLOCK;
+        len_t i1 = i0 + SP_STRMV_BLOCK < n ? i0 + SP_STRMV_BLOCK : n;
+        len_t nb = i1 - i0;
+        float * xb = sub_vector(x, n, inc_x, i0, i1);
+        len_t ix = inc_x < 0 ? (len_t)((1 - nb) * inc_x) : 0;
+
+        /* Diagonal block, on a contiguous copy of x_i. */
+        for (len_t j = 0; j < nb; j++) {
+            x_block[j] = xb[ix + j * inc_x];
+        }
+        strmv_block(is_upper, is_trans, is_unit, nb, A + i0 + i0 * lda, lda,
+            x_block);
+        for (len_t j = 0; j < nb; j++) {
+            xb[ix + j * inc_x] = x_block[j];
+        }
+
+        /* Rectangle beside it, against the parts of x not yet updated. */
+        if (is_upper && !is_trans) {
+            sgemv(false, nb, n - i1, 1.0f, A + i0 + i1 * lda, lda,
+                sub_vector(x, n, inc_x, i1, n), inc_x, 1.0f, xb, inc_x);
+        } else if (is_upper) {
+            sgemv(true, i0, nb, 1.0f, A + i0 * lda, lda,
+                sub_vector(x, n, inc_x, 0, i0), inc_x, 1.0f, xb, inc_x);
+        } else if (!is_trans) {
+            sgemv(false, nb, i0, 1.0f, A + i0, lda,
+                sub_vector(x, n, inc_x, 0, i0), inc_x, 1.0f, xb, inc_x);
         } else {
+            sgemv(true, n - i1, nb, 1.0f, A + i1 + i0 * lda, lda,
+                sub_vector(x, n, inc_x, i1, n), inc_x, 1.0f, xb, inc_x);
         }
     }
 
@@ -210,41 +599,1121 @@ fail:
 }
 
 
-#if 0
-
-sp_blas_sgbmv
-
-sp_blas_sger
-
-sp_blas_ssbmv
-
-sp_blas_sspmv
-
-sp_blas_sspr
-
-sp_blas_sspr2
-
-sp_blas_ssymv
-
-sp_blas_ssyr
-
-sp_blas_ssyr2
-
-sp_blas_stbmv
-
-sp_blas_stbsv
-
-sp_blas_stpmv
-
-sp_blas_stbsv
-
-sp_blas_stpmv
-
-sp_blas_stpsv
+/*
+ * Solve op(T)*x = b for a diagonal block T of order nb, with b given in a
+ * contiguous x and overwritten by the solution.
+ */
+static void
+strsv_block(
+    bool is_upper,
+    bool is_trans,
+    bool is_unit,
+    len_t nb,
+    const float * const A,
+    len_t lda,
+    float * const x)
+{
+    if (is_upper && !is_trans) {
+        for (len_t j = nb - 1; j >= 0; j--) {
+            const float * a = A + j * lda;
+            if (!is_unit) {
+                x[j] /= a[j];
+            }
+            float t = x[j];
+            for (len_t i = 0; i < j; i++) {
+                x[i] -= a[i] * t;
+            }
+        }
+    } else if (is_upper) {
+        for (len_t j = 0; j < nb; j++) {
+            const float * a = A + j * lda;
+            float s = x[j];
+            for (len_t i = 0; i < j; i++) {
+                s -= a[i] * x[i];
+            }
+            x[j] = is_unit ? s : s / a[j];
+        }
+    } else if (!is_trans) {
+        for (len_t j = 0; j < nb; j++) {
+            const float * a = A + j * lda;
+            if (!is_unit) {
+                x[j] /= a[j];
+            }
+            float t = x[j];
+            for (len_t i = j + 1; i < nb; i++) {
+                x[i] -= a[i] * t;
+            }
+        }
+    } else {
+        for (len_t j = nb - 1; j >= 0; j--) {
+            const float * a = A + j * lda;
+            float s = x[j];
+            for (len_t i = j + 1; i < nb; i++) {
+                s -= a[i] * x[i];
+            }
+            x[j] = is_unit ? s : s / a[j];
+        }
+    }
+}
 
-sp_blas_strmv
 
-sp_blas_strsv
+/**
+ * Solve a triangular system of equations.
+ *
+ * Solves one of
+ *
+ *      A*x = b
+ * or
+ *      A^T*x = b
+ *
+ * No test for singularity is done.
+ *
+ * \param[in] is_upper  True if A is upper triangular, false otherwise
+ * \param[in] is_trans  True to use the transpose of A
+ * \param[in] is_unit   True if A is unit-triangular
+ * \param[in] n         Number of rows/columns in A
+ * \param[in] lda       Leading dimension of A
+ * \param[in,out] x     On enter, right-hand side b. On exit, solution x.
+ *                      Must have dimension at least 1 + (n - 1) * |inc_x|.
+ * \param[in] inc_x     Increment of x
+ *
+ * x is cut into blocks of SP_STRMV_BLOCK and solved by blocked forward or
+ * backward substitution. Each block first has the blocks already solved
+ * subtracted from it with sgemv against the rectangle of A beside the
+ * diagonal block, and is then solved against the diagonal block. The
+ * blocks are visited top-down when x_i depends on the entries above it
+ * (lower, or upper transposed) and bottom-up otherwise.
+ */
+void
+sp_blas_strsv(
+    bool is_upper,
+    bool is_trans,
+    bool is_unit,
+    len_t n,
+    const float * const A,
+    len_t lda,
+    float * const x,
+    len_t inc_x)
+{
+    SP_ASSERT_VALID_DIM(n);
+    SP_ASSERT_VALID_LDA(lda, n);
+    SP_ASSERT_VALID_INC(inc_x);
+
+    bool is_top_down = is_upper == is_trans;
+    len_t num_blocks = (n + SP_STRMV_BLOCK - 1) / SP_STRMV_BLOCK;
+    float x_block[SP_STRMV_BLOCK];
+
+    for (len_t b = 0; b < num_blocks; b++) {
+        len_t i0 = (is_top_down ? b : num_blocks - 1 - b) * SP_STRMV_BLOCK;
+        len_t i1 = i0 + SP_STRMV_BLOCK < n ? i0 + SP_STRMV_BLOCK : n;
+        len_t nb = i1 - i0;
+        float * xb = sub_vector(x, n, inc_x, i0, i1);
+        len_t ix = inc_x < 0 ? (len_t)((1 - nb) * inc_x) : 0;
+
+        /* Rectangle beside the diagonal block, against the solved parts. */
+        if (is_upper && !is_trans) {
+            sgemv(false, nb, n - i1, -1.0f, A + i0 + i1 * lda, lda,
+                sub_vector(x, n, inc_x, i1, n), inc_x, 1.0f, xb, inc_x);
+        } else if (is_upper) {
+            sgemv(true, i0, nb, -1.0f, A + i0 * lda, lda,
+                sub_vector(x, n, inc_x, 0, i0), inc_x, 1.0f, xb, inc_x);
+        } else if (!is_trans) {
+            sgemv(false, nb, i0, -1.0f, A + i0, lda,
+                sub_vector(x, n, inc_x, 0, i0), inc_x, 1.0f, xb, inc_x);
+        } else {
+            sgemv(true, n - i1, nb, -1.0f, A + i1 + i0 * lda, lda,
+                sub_vector(x, n, inc_x, i1, n), inc_x, 1.0f, xb, inc_x);
+        }
+
+        /* Diagonal block, on a contiguous copy of x_i. */
+        for (len_t j = 0; j < nb; j++) {
+            x_block[j] = xb[ix + j * inc_x];
+        }
+        strsv_block(is_upper, is_trans, is_unit, nb, A + i0 + i0 * lda, lda,
+            x_block);
+        for (len_t j = 0; j < nb; j++) {
+            xb[ix + j * inc_x] = x_block[j];
+        }
+    }
+
+fail:
+    return;
+}
+
+
+/* Arguments to ssymv shared by all threads. */
+typedef struct {
+    bool is_upper;
+    len_t n;
+    float alpha;
+    const float * A;
+    len_t lda;
+    const float * x;
+    len_t inc_x;
+    float * y;
+    len_t inc_y;
+    len_t num_blocks;
+    len_t round;
+} ssymv_args;
+
+
+/* Offset of element i in a strided vector of length n. */
+static inline len_t
+element_offset(
+    len_t n,
+    len_t inc,
+    len_t i)
+{
+    return inc < 0 ? (len_t)((i + 1 - n) * inc) : i * inc;
+}
+
+
+/*
+ * Elements [i0, i0 + nb) of a strided vector as a contiguous block: the
+ * vector itself if inc = 1, or a copy in buf otherwise.
+ */
+static float *
+gather_block(
+    const float * const v,
+    len_t n,
+    len_t inc,
+    len_t i0,
+    len_t nb,
+    float * const buf)
+{
+    if (inc == 1) {
+        return (float *)v + i0;
+    }
+    for (len_t j = 0; j < nb; j++) {
+        buf[j] = v[element_offset(n, inc, i0 + j)];
+    }
+    return buf;
+}
+
+
+/* Write back a block returned by gather_block. */
+static void
+scatter_block(
+    float * const v,
+    len_t n,
+    len_t inc,
+    len_t i0,
+    len_t nb,
+    const float * const buf)
+{
+    if (inc == 1) {
+        return;
+    }
+    for (len_t j = 0; j < nb; j++) {
+        v[element_offset(n, inc, i0 + j)] = buf[j];
+    }
+}
+
+
+/*
+ * Diagonal blocks [begin, end). Column j of the stored triangle is a
+ * one-column panel: it is added into the other rows of y and dotted with
+ * the same rows of x for y_j.
+ */
+static void
+ssymv_diag_task(
+    void * arg,
+    len_t begin,
+    len_t end)
+{
+    const ssymv_args * p = arg;
+    float x_buf[SP_SSYMV_BLOCK];
+    float y_buf[SP_SSYMV_BLOCK];
+
+    for (len_t b = begin; b < end; b++) {
+        len_t i0 = b * SP_SSYMV_BLOCK;
+        len_t nb = p->n - i0 < SP_SSYMV_BLOCK ? p->n - i0 : SP_SSYMV_BLOCK;
+        const float * a = p->A + i0 + i0 * p->lda;
+        const float * xb = gather_block(p->x, p->n, p->inc_x, i0, nb, x_buf);
+        float * yb = gather_block(p->y, p->n, p->inc_y, i0, nb, y_buf);
+
+        for (len_t j = 0; j < nb; j++) {
+            const float * aj = a + j * p->lda;
+            if (p->is_upper) {
+                sp_kernels.ssymv_panel_inc1(j, 1, p->alpha, aj, p->lda,
+                    xb, xb + j, yb, yb + j);
+            } else {
+                sp_kernels.ssymv_panel_inc1(nb - j - 1, 1, p->alpha,
+                    aj + j + 1, p->lda, xb + j + 1, xb + j, yb + j + 1,
+                    yb + j);
+            }
+            yb[j] += p->alpha * aj[j] * xb[j];
+        }
+
+        scatter_block(p->y, p->n, p->inc_y, i0, nb, yb);
+    }
+}
+
+
+/*
+ * Off-diagonal blocks of one round of the schedule, pairs [begin, end).
+ * Pair k of round r joins blocks (r, m - 1) for k = 0 and
+ * ((r + k) mod (m - 1), (r - k) mod (m - 1)) otherwise, where m is the
+ * number of blocks rounded up to even. Over m - 1 rounds every pair of
+ * blocks meets once, and within a round no block appears twice, so the
+ * pairs of a round write to disjoint parts of y. A block numbered
+ * num_blocks is a stand-in that sits the round out.
+ */
+static void
+ssymv_pair_task(
+    void * arg,
+    len_t begin,
+    len_t end)
+{
+    const ssymv_args * p = arg;
+    float x_buf[2][SP_SSYMV_BLOCK];
+    float y_buf[2][SP_SSYMV_BLOCK];
+    len_t m = p->num_blocks + p->num_blocks % 2;
+    len_t r = p->round;
+
+    for (len_t k = begin; k < end; k++) {
+        len_t bi = k == 0 ? r : (r + k) % (m - 1);
+        len_t bj = k == 0 ? m - 1 : (r - k + m - 1) % (m - 1);
+        if (bi == p->num_blocks || bj == p->num_blocks) {
+            continue;
+        }
+        if (bi > bj) {
+            len_t t = bi;
+            bi = bj;
+            bj = t;
+        }
+
+        /* Block I lies above block J, so the stored block is A_IJ for an
+         * upper triangle and A_JI for a lower one.
+         */
+        len_t i0 = bi * SP_SSYMV_BLOCK;
+        len_t j0 = bj * SP_SSYMV_BLOCK;
+        len_t nj = p->n - j0 < SP_SSYMV_BLOCK ? p->n - j0 : SP_SSYMV_BLOCK;
+        const float * xi = gather_block(p->x, p->n, p->inc_x, i0,
+            SP_SSYMV_BLOCK, x_buf[0]);
+        const float * xj = gather_block(p->x, p->n, p->inc_x, j0, nj,
+            x_buf[1]);
+        float * yi = gather_block(p->y, p->n, p->inc_y, i0, SP_SSYMV_BLOCK,
+            y_buf[0]);
+        float * yj = gather_block(p->y, p->n, p->inc_y, j0, nj, y_buf[1]);
+
+        if (p->is_upper) {
+            sp_kernels.ssymv_panel_inc1(SP_SSYMV_BLOCK, nj, p->alpha,
+                p->A + i0 + j0 * p->lda, p->lda, xi, xj, yi, yj);
+        } else {
+            sp_kernels.ssymv_panel_inc1(nj, SP_SSYMV_BLOCK, p->alpha,
+                p->A + j0 + i0 * p->lda, p->lda, xj, xi, yj, yi);
+        }
+
+        scatter_block(p->y, p->n, p->inc_y, i0, SP_SSYMV_BLOCK, yi);
+        scatter_block(p->y, p->n, p->inc_y, j0, nj, yj);
+    }
+}
+
+
+/**
+ * Compute the product of a symmetric matrix and a vector.
+ *
+ * Performs the operation
+ *
+ *      y = alpha*A*x + beta*y
+ *
+ * where A is symmetric and only its upper or lower triangle is referenced.
+ *
+ * \param[in] is_upper  True if the upper triangle of A is stored, false
+ *                      for the lower triangle
+ * \param[in] n         Number of rows/columns in A
+ * \param[in] alpha     Scalar alpha
+ * \param[in] A         Matrix A
+ * \param[in] lda       Leading dimension of A - must be at least
+ *                      max(1, n)
+ * \param[in] x         Vector x
+ * \param[in] inc_x     Increment (stride) for x
+ * \param[in] beta      Scalar beta
+ * \param[in,out] y     Vector y, stores result
+ * \param[in] inc_y     Increment (stride) for y
+ *
+ * The stored triangle is cut into blocks of SP_SSYMV_BLOCK and read once:
+ * each off-diagonal block is used for the parts of y on both sides of the
+ * diagonal in the same pass, so the memory traffic is half that of sgemv
+ * on the mirrored matrix. The blocks are visited in a fixed round-robin
+ * order in which the blocks of one round update disjoint parts of y.
+ * Products with at least SP_SGEMV_PARALLEL_MIN entries in the triangle
+ * split each round across the thread pool, and the result does not depend
+ * on the number of threads.
+ */
+void
+sp_blas_ssymv(
+    bool is_upper,
+    len_t n,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    const float * const x,
+    len_t inc_x,
+    float beta,
+    float * const y,
+    len_t inc_y)
+{
+    SP_ASSERT_VALID_DIM(n);
+    SP_ASSERT_VALID_LDA(lda, n);
+    SP_ASSERT_VALID_INC(inc_x);
+    SP_ASSERT_VALID_INC(inc_y);
+
+    sp_blas_scale_y(n, beta, y, inc_y);
+    if (alpha == 0.0f) {
+        return;
+    }
+
+    ssymv_args args = {
+        .is_upper = is_upper,
+        .n = n,
+        .alpha = alpha,
+        .A = A,
+        .lda = lda,
+        .x = x,
+        .inc_x = inc_x,
+        .y = y,
+        .inc_y = inc_y,
+        .num_blocks = (n + SP_SSYMV_BLOCK - 1) / SP_SSYMV_BLOCK,
+    };
+
+    /* A pair of full blocks is at least SP_SGEMV_PARALLEL_MIN of work. */
+    bool is_threaded = (int64_t)n * n / 2 >= SP_SGEMV_PARALLEL_MIN;
+    len_t m = args.num_blocks + args.num_blocks % 2;
+
+    sp_parallel_for(args.num_blocks, is_threaded ? 1 : args.num_blocks,
+        ssymv_diag_task, &args);
+    for (len_t r = 0; r < m - 1; r++) {
+        args.round = r;
+        sp_parallel_for(m / 2, is_threaded ? 1 : m / 2, ssymv_pair_task,
+            &args);
+    }
+
+fail:
+    return;
+}
+
+
+/*
+ * Storage of a triangular or symmetric matrix of order n, as only its
+ * stored columns are walked: packed (column j of the triangle follows
+ * column j - 1 directly), or band with k off-diagonals in an array with
+ * leading dimension lda.
+ */
+typedef struct {
+    bool is_upper;
+    bool is_packed;
+    len_t n;
+    len_t k;
+    const float * A;
+    len_t lda;
+} tri_storage;
+
+
+/*
+ * Off-diagonal part of column j of the stored triangle. Returns a pointer
+ * to its first entry, sets [i0, i1) to the rows that it covers, and diag to
+ * the diagonal entry. The rows are above the diagonal for an upper
+ * triangle and below it for a lower one.
+ */
+static const float *
+tri_column(
+    const tri_storage * const s,
+    len_t j,
+    len_t * const i0,
+    len_t * const i1,
+    float * const diag)
+{
+    const float * col;
+
+    if (s->is_packed) {
+        col = s->A + (s->is_upper ? (int64_t)j * (j + 1) / 2 :
+            (int64_t)j * s->n - (int64_t)j * (j - 1) / 2);
+        *i0 = s->is_upper ? 0 : j + 1;
+        *i1 = s->is_upper ? j : s->n;
+        *diag = s->is_upper ? col[j] : col[0];
+        return s->is_upper ? col : col + 1;
+    }
+
+    col = s->A + j * s->lda;
+    if (s->is_upper) {
+        *i0 = j - s->k > 0 ? j - s->k : 0;
+        *i1 = j;
+        *diag = col[s->k];
+        return col + s->k + *i0 - j;
+    }
+    *i0 = j + 1;
+    *i1 = j + s->k + 1 < s->n ? j + s->k + 1 : s->n;
+    *diag = col[0];
+    return col + 1;
+}
+
+
+/* y += alpha*a for a contiguous a and a strided y. */
+static inline void
+axpy(
+    len_t len,
+    float alpha,
+    const float * const a,
+    float * const y,
+    len_t inc_y)
+{
+    if (len <= 0 || alpha == 0.0f) {
+        return;
+    } else if (inc_y == 1) {
+        sp_kernels.saxpy_inc1(len, alpha, a, y);
+    } else {
+        sp_blas_saxpy_incxy(len, alpha, a, 1, y, inc_y);
+    }
+}
+
+
+/* Dot product of a contiguous a and a strided x. */
+static inline float
+dot(
+    len_t len,
+    const float * const a,
+    const float * const x,
+    len_t inc_x)
+{
+    if (len <= 0) {
+        return 0.0f;
+    } else if (inc_x == 1) {
+        return sp_kernels.sdot_inc1(len, a, x);
+    }
+    return sp_blas_sdot_incxy(len, a, 1, x, inc_x);
+}
+
+
+/*
+ * x = op(T)*x column by column. Each column adds its off-diagonal part
+ * into x with saxpy, or takes it in with sdot for the transpose, in the
+ * order that reads every entry of x before it is overwritten.
+ */
+static void
+tri_mv(
+    const tri_storage * const s,
+    bool is_trans,
+    bool is_unit,
+    float * const x,
+    len_t inc_x)
+{
+    len_t n = s->n;
+    bool is_forward = s->is_upper != is_trans;
+
+    for (len_t b = 0; b < n; b++) {
+        len_t j = is_forward ? b : n - 1 - b;
+        len_t i0, i1;
+        float diag;
+        const float * a = tri_column(s, j, &i0, &i1, &diag);
+        float * xs = sub_vector(x, n, inc_x, i0, i1);
+        float * xj = x + element_offset(n, inc_x, j);
+
+        if (is_trans) {
+            float t = is_unit ? *xj : diag * *xj;
+            *xj = t + dot(i1 - i0, a, xs, inc_x);
+        } else {
+            axpy(i1 - i0, *xj, a, xs, inc_x);
+            if (!is_unit) {
+                *xj *= diag;
+            }
+        }
+    }
+}
+
+
+/*
+ * Solve op(T)*x = b column by column: either x_j is solved and then
+ * eliminated from the rest of x with saxpy, or the solved entries are
+ * taken out of x_j with sdot first.
+ */
+static void
+tri_sv(
+    const tri_storage * const s,
+    bool is_trans,
+    bool is_unit,
+    float * const x,
+    len_t inc_x)
+{
+    len_t n = s->n;
+    bool is_forward = s->is_upper == is_trans;
+
+    for (len_t b = 0; b < n; b++) {
+        len_t j = is_forward ? b : n - 1 - b;
+        len_t i0, i1;
+        float diag;
+        const float * a = tri_column(s, j, &i0, &i1, &diag);
+        float * xs = sub_vector(x, n, inc_x, i0, i1);
+        float * xj = x + element_offset(n, inc_x, j);
+
+        if (is_trans) {
+            float t = *xj - dot(i1 - i0, a, xs, inc_x);
+            *xj = is_unit ? t : t / diag;
+        } else {
+            if (!is_unit) {
+                *xj /= diag;
+            }
+            axpy(i1 - i0, -*xj, a, xs, inc_x);
+        }
+    }
+}
+
+
+/*
+ * y += alpha*A*x for a symmetric A given by its stored triangle. The
+ * off-diagonal part of every column is read once and used both for its
+ * rows of y and, as a dot product, for y_j.
+ */
+static void
+sym_mv(
+    const tri_storage * const s,
+    float alpha,
+    const float * const x,
+    len_t inc_x,
+    float * const y,
+    len_t inc_y)
+{
+    len_t n = s->n;
+
+    for (len_t j = 0; j < n; j++) {
+        len_t i0, i1;
+        float diag;
+        const float * a = tri_column(s, j, &i0, &i1, &diag);
+        const float * xs = sub_vector((float *)x, n, inc_x, i0, i1);
+        const float * xj = x + element_offset(n, inc_x, j);
+        float * ys = sub_vector(y, n, inc_y, i0, i1);
+        float * yj = y + element_offset(n, inc_y, j);
+
+        if (inc_x == 1 && inc_y == 1) {
+            sp_kernels.ssymv_panel_inc1(i1 - i0, 1, alpha, a, i1 - i0, xs,
+                xj, ys, yj);
+        } else {
+            axpy(i1 - i0, alpha * *xj, a, ys, inc_y);
+            *yj += alpha * dot(i1 - i0, a, xs, inc_x);
+        }
+        *yj += alpha * diag * *xj;
+    }
+}
+
+
+/**
+ * Compute the product of a symmetric matrix in packed storage and a
+ * vector.
+ *
+ * Performs the operation
+ *
+ *      y = alpha*A*x + beta*y
+ *
+ * \param[in] is_upper  True if AP holds the upper triangle of A, false for
+ *                      the lower triangle
+ * \param[in] n         Number of rows/columns in A
+ * \param[in] alpha     Scalar alpha
+ * \param[in] AP        The triangle of A packed by columns, of dimension at
+ *                      least n*(n + 1)/2
+ * \param[in] x         Vector x
+ * \param[in] inc_x     Increment (stride) for x
+ * \param[in] beta      Scalar beta
+ * \param[in,out] y     Vector y, stores result
+ * \param[in] inc_y     Increment (stride) for y
+ *
+ * Every stored entry is read once, for both the row and the column that it
+ * stands for.
+ */
+void
+sp_blas_sspmv(
+    bool is_upper,
+    len_t n,
+    float alpha,
+    const float * const AP,
+    const float * const x,
+    len_t inc_x,
+    float beta,
+    float * const y,
+    len_t inc_y)
+{
+    SP_ASSERT_VALID_DIM(n);
+    SP_ASSERT_VALID_INC(inc_x);
+    SP_ASSERT_VALID_INC(inc_y);
+
+    sp_blas_scale_y(n, beta, y, inc_y);
+    if (alpha == 0.0f) {
+        return;
+    }
+
+    tri_storage s = {
+        .is_upper = is_upper,
+        .is_packed = true,
+        .n = n,
+        .A = AP,
+    };
+    sym_mv(&s, alpha, x, inc_x, y, inc_y);
+
+fail:
+    return;
+}
+
+
+/**
+ * Compute the product of a triangular matrix in packed storage and a
+ * vector.
+ *
+ * Performs one of the operations
+ *
+ *      x = A*x
+ * or
+ *      x = A^T*x
+ *
+ * \param[in] is_upper  True if A is upper triangular, false otherwise
+ * \param[in] is_trans  True to use the transpose of A
+ * \param[in] is_unit   True if A is unit-triangular
+ * \param[in] n         Number of rows/columns in A
+ * \param[in] AP        The triangle of A packed by columns, of dimension at
+ *                      least n*(n + 1)/2
+ * \param[in,out] x     On enter, vector x to multiply. On exit, result.
+ * \param[in] inc_x     Increment of x
+ */
+void
+sp_blas_stpmv(
+    bool is_upper,
+    bool is_trans,
+    bool is_unit,
+    len_t n,
+    const float * const AP,
+    float * const x,
+    len_t inc_x)
+{
+    SP_ASSERT_VALID_DIM(n);
+    SP_ASSERT_VALID_INC(inc_x);
+
+    tri_storage s = {
+        .is_upper = is_upper,
+        .is_packed = true,
+        .n = n,
+        .A = AP,
+    };
+    tri_mv(&s, is_trans, is_unit, x, inc_x);
+
+fail:
+    return;
+}
+
+
+/**
+ * Solve a triangular system of equations in packed storage.
+ *
+ * Solves one of
+ *
+ *      A*x = b
+ * or
+ *      A^T*x = b
+ *
+ * No test for singularity is done.
+ *
+ * \param[in] is_upper  True if A is upper triangular, false otherwise
+ * \param[in] is_trans  True to use the transpose of A
+ * \param[in] is_unit   True if A is unit-triangular
+ * \param[in] n         Number of rows/columns in A
+ * \param[in] AP        The triangle of A packed by columns, of dimension at
+ *                      least n*(n + 1)/2
+ * \param[in,out] x     On enter, right-hand side b. On exit, solution x.
+ * \param[in] inc_x     Increment of x
+ */
+void
+sp_blas_stpsv(
+    bool is_upper,
+    bool is_trans,
+    bool is_unit,
+    len_t n,
+    const float * const AP,
+    float * const x,
+    len_t inc_x)
+{
+    SP_ASSERT_VALID_DIM(n);
+    SP_ASSERT_VALID_INC(inc_x);
+
+    tri_storage s = {
+        .is_upper = is_upper,
+        .is_packed = true,
+        .n = n,
+        .A = AP,
+    };
+    tri_sv(&s, is_trans, is_unit, x, inc_x);
+
+fail:
+    return;
+}
+
+
+/**
+ * Perform a symmetric rank-1 update of a matrix in packed storage.
+ *
+ * Performs the operation
+ *
+ *      A = alpha*x*x^T + A
+ *
+ * \param[in] is_upper  True if AP holds the upper triangle of A, false for
+ *                      the lower triangle
+ * \param[in] n         Number of rows/columns in A
+ * \param[in] alpha     Scalar alpha
+ * \param[in] x         Vector x
+ * \param[in] inc_x     Increment (stride) for x
+ * \param[in,out] AP    The triangle of A packed by columns, of dimension at
+ *                      least n*(n + 1)/2
+ */
+void
+sp_blas_sspr(
+    bool is_upper,
+    len_t n,
+    float alpha,
+    const float * const x,
+    len_t inc_x,
+    float * const AP)
+{
+    SP_ASSERT_VALID_DIM(n);
+    SP_ASSERT_VALID_INC(inc_x);
+
+    if (alpha == 0.0f) {
+        return;
+    }
+
+    float * col = AP;
+    for (len_t j = 0; j < n; j++) {
+        len_t i0 = is_upper ? 0 : j;
+        len_t i1 = is_upper ? j + 1 : n;
+        const float * xs = sub_vector((float *)x, n, inc_x, i0, i1);
+        float t = alpha * x[element_offset(n, inc_x, j)];
+
+        if (inc_x == 1) {
+            sp_kernels.saxpy_inc1(i1 - i0, t, xs, col);
+        } else {
+            sp_blas_saxpy_incxy(i1 - i0, t, xs, inc_x, col, 1);
+        }
+        col += i1 - i0;
+    }
+
+fail:
+    return;
+}
+
+
+/**
+ * Perform a symmetric rank-2 update of a matrix in packed storage.
+ *
+ * Performs the operation
+ *
+ *      A = alpha*x*y^T + alpha*y*x^T + A
+ *
+ * \param[in] is_upper  True if AP holds the upper triangle of A, false for
+ *                      the lower triangle
+ * \param[in] n         Number of rows/columns in A
+ * \param[in] alpha     Scalar alpha
+ * \param[in] x         Vector x
+ * \param[in] inc_x     Increment (stride) for x
+ * \param[in] y         Vector y
+ * \param[in] inc_y     Increment (stride) for y
+ * \param[in,out] AP    The triangle of A packed by columns, of dimension at
+ *                      least n*(n + 1)/2
+ */
+void
+sp_blas_sspr2(
+    bool is_upper,
+    len_t n,
+    float alpha,
+    const float * const x,
+    len_t inc_x,
+    const float * const y,
+    len_t inc_y,
+    float * const AP)
+{
+    SP_ASSERT_VALID_DIM(n);
+    SP_ASSERT_VALID_INC(inc_x);
+    SP_ASSERT_VALID_INC(inc_y);
+
+    if (alpha == 0.0f) {
+        return;
+    }
+
+    float * col = AP;
+    for (len_t j = 0; j < n; j++) {
+        len_t i0 = is_upper ? 0 : j;
+        len_t i1 = is_upper ? j + 1 : n;
+        const float * xs = sub_vector((float *)x, n, inc_x, i0, i1);
+        const float * ys = sub_vector((float *)y, n, inc_y, i0, i1);
+        float tx = alpha * y[element_offset(n, inc_y, j)];
+        float ty = alpha * x[element_offset(n, inc_x, j)];
+
+        if (inc_x == 1 && inc_y == 1) {
+            sp_kernels.saxpy_inc1(i1 - i0, tx, xs, col);
+            sp_kernels.saxpy_inc1(i1 - i0, ty, ys, col);
+        } else {
+            sp_blas_saxpy_incxy(i1 - i0, tx, xs, inc_x, col, 1);
+            sp_blas_saxpy_incxy(i1 - i0, ty, ys, inc_y, col, 1);
+        }
+        col += i1 - i0;
+    }
+
+fail:
+    return;
+}
+
+
+/**
+ * Compute the product of a general band matrix and a vector.
+ *
+ * Performs one of the operations
+ *
+ *      y = alpha*A*x + beta*y
+ * or
+ *      y = alpha*A^T*x + beta*y
+ *
+ * \param[in] is_trans  True to take the transpose of A
+ * \param[in] rows      Number of rows in A
+ * \param[in] cols      Number of columns in A
+ * \param[in] kl        Number of sub-diagonals of A
+ * \param[in] ku        Number of super-diagonals of A
+ * \param[in] alpha     Scalar alpha
+ * \param[in] A         Band of A, with A(i, j) in A[ku + i - j + j*lda]
+ * \param[in] lda       Leading dimension of A - must be at least
+ *                      kl + ku + 1
+ * \param[in] x         Vector x
+ * \param[in] inc_x     Increment (stride) for x
+ * \param[in] beta      Scalar beta
+ * \param[in,out] y     Vector y, stores result
+ * \param[in] inc_y     Increment (stride) for y
+ *
+ * Each column of the band is one saxpy into y, or one sdot for the
+ * transpose, so the cost is proportional to the number of entries in the
+ * band.
+ */
+void
+sp_blas_sgbmv(
+    bool is_trans,
+    len_t rows,
+    len_t cols,
+    len_t kl,
+    len_t ku,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    const float * const x,
+    len_t inc_x,
+    float beta,
+    float * const y,
+    len_t inc_y)
+{
+    SP_ASSERT_VALID_DIM(rows);
+    SP_ASSERT_VALID_DIM(cols);
+    SP_ASSERT_CONDITION(kl >= 0, SP_ERROR_INVALID_DIM, kl);
+    SP_ASSERT_CONDITION(ku >= 0, SP_ERROR_INVALID_DIM, ku);
+    SP_ASSERT_VALID_LDA(lda, kl + ku + 1);
+    SP_ASSERT_VALID_INC(inc_x);
+    SP_ASSERT_VALID_INC(inc_y);
+
+    len_t len_x = is_trans ? rows : cols;
+    len_t len_y = is_trans ? cols : rows;
+
+    sp_blas_scale_y(len_y, beta, y, inc_y);
+    if (alpha == 0.0f) {
+        return;
+    }
+
+    for (len_t j = 0; j < cols; j++) {
+        len_t i0 = j - ku > 0 ? j - ku : 0;
+        len_t i1 = j + kl + 1 < rows ? j + kl + 1 : rows;
+        const float * a = A + ku + i0 - j + j * lda;
+
+        if (is_trans) {
+            const float * xs = sub_vector((float *)x, len_x, inc_x, i0, i1);
+            y[element_offset(len_y, inc_y, j)] +=
+                alpha * dot(i1 - i0, a, xs, inc_x);
+        } else {
+            float t = alpha * x[element_offset(len_x, inc_x, j)];
+            axpy(i1 - i0, t, a, sub_vector(y, len_y, inc_y, i0, i1), inc_y);
+        }
+    }
+
+fail:
+    return;
+}
+
+
+/**
+ * Compute the product of a symmetric band matrix and a vector.
+ *
+ * Performs the operation
+ *
+ *      y = alpha*A*x + beta*y
+ *
+ * \param[in] is_upper  True if the upper triangle of the band is stored,
+ *                      with A(i, j) in A[k + i - j + j*lda]; false for the
+ *                      lower triangle, with A(i, j) in A[i - j + j*lda]
+ * \param[in] n         Number of rows/columns in A
+ * \param[in] k         Number of off-diagonals of A
+ * \param[in] alpha     Scalar alpha
+ * \param[in] A         Band of A
+ * \param[in] lda       Leading dimension of A - must be at least k + 1
+ * \param[in] x         Vector x
+ * \param[in] inc_x     Increment (stride) for x
+ * \param[in] beta      Scalar beta
+ * \param[in,out] y     Vector y, stores result
+ * \param[in] inc_y     Increment (stride) for y
+ *
+ * As in sp_blas_sspmv, every stored entry is read once.
+ */
+void
+sp_blas_ssbmv(
+    bool is_upper,
+    len_t n,
+    len_t k,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    const float * const x,
+    len_t inc_x,
+    float beta,
+    float * const y,
+    len_t inc_y)
+{
+    SP_ASSERT_VALID_DIM(n);
+    SP_ASSERT_CONDITION(k >= 0, SP_ERROR_INVALID_DIM, k);
+    SP_ASSERT_VALID_LDA(lda, k + 1);
+    SP_ASSERT_VALID_INC(inc_x);
+    SP_ASSERT_VALID_INC(inc_y);
+
+    sp_blas_scale_y(n, beta, y, inc_y);
+    if (alpha == 0.0f) {
+        return;
+    }
+
+    tri_storage s = {
+        .is_upper = is_upper,
+        .is_packed = false,
+        .n = n,
+        .k = k,
+        .A = A,
+        .lda = lda,
+    };
+    sym_mv(&s, alpha, x, inc_x, y, inc_y);
+
+fail:
+    return;
+}
+
+
+/**
+ * Compute the product of a triangular band matrix and a vector.
+ *
+ * Performs one of the operations
+ *
+ *      x = A*x
+ * or
+ *      x = A^T*x
+ *
+ * \param[in] is_upper  True if A is upper triangular, with A(i, j) in
+ *                      A[k + i - j + j*lda]; false if lower triangular,
+ *                      with A(i, j) in A[i - j + j*lda]
+ * \param[in] is_trans  True to use the transpose of A
+ * \param[in] is_unit   True if A is unit-triangular
+ * \param[in] n         Number of rows/columns in A
+ * \param[in] k         Number of off-diagonals of A
+ * \param[in] A         Band of A
+ * \param[in] lda       Leading dimension of A - must be at least k + 1
+ * \param[in,out] x     On enter, vector x to multiply. On exit, result.
+ * \param[in] inc_x     Increment of x
+ */
+void
+sp_blas_stbmv(
+    bool is_upper,
+    bool is_trans,
+    bool is_unit,
+    len_t n,
+    len_t k,
+    const float * const A,
+    len_t lda,
+    float * const x,
+    len_t inc_x)
+{
+    SP_ASSERT_VALID_DIM(n);
+    SP_ASSERT_CONDITION(k >= 0, SP_ERROR_INVALID_DIM, k);
+    SP_ASSERT_VALID_LDA(lda, k + 1);
+    SP_ASSERT_VALID_INC(inc_x);
+
+    tri_storage s = {
+        .is_upper = is_upper,
+        .is_packed = false,
+        .n = n,
+        .k = k,
+        .A = A,
+        .lda = lda,
+    };
+    tri_mv(&s, is_trans, is_unit, x, inc_x);
+
+fail:
+    return;
+}
+
+
+/**
+ * Solve a triangular band system of equations.
+ *
+ * Solves one of
+ *
+ *      A*x = b
+ * or
+ *      A^T*x = b
+ *
+ * No test for singularity is done.
+ *
+ * \param[in] is_upper  True if A is upper triangular, with A(i, j) in
+ *                      A[k + i - j + j*lda]; false if lower triangular,
+ *                      with A(i, j) in A[i - j + j*lda]
+ * \param[in] is_trans  True to use the transpose of A
+ * \param[in] is_unit   True if A is unit-triangular
+ * \param[in] n         Number of rows/columns in A
+ * \param[in] k         Number of off-diagonals of A
+ * \param[in] A         Band of A
+ * \param[in] lda       Leading dimension of A - must be at least k + 1
+ * \param[in,out] x     On enter, right-hand side b. On exit, solution x.
+ * \param[in] inc_x     Increment of x
+ */
+void
+sp_blas_stbsv(
+    bool is_upper,
+    bool is_trans,
+    bool is_unit,
+    len_t n,
+    len_t k,
+    const float * const A,
+    len_t lda,
+    float * const x,
+    len_t inc_x)
+{
+    SP_ASSERT_VALID_DIM(n);
+    SP_ASSERT_CONDITION(k >= 0, SP_ERROR_INVALID_DIM, k);
+    SP_ASSERT_VALID_LDA(lda, k + 1);
+    SP_ASSERT_VALID_INC(inc_x);
+
+    tri_storage s = {
+        .is_upper = is_upper,
+        .is_packed = false,
+        .n = n,
+        .k = k,
+        .A = A,
+        .lda = lda,
+    };
+    tri_sv(&s, is_trans, is_unit, x, inc_x);
+
+fail:
+    return;
+}
+
+
+#if 0
+
+sp_blas_ssyr
+
+sp_blas_ssyr2
 
 
 Level 3:
@@ -0,0 +1,712 @@
+/*
+ * AVX2 + FMA versions of the level 2 kernels. This file is compiled with
+ * -mavx2 -mfma.
+ */
+#if defined(__AVX2__) && defined(__FMA__)
+
+#include <immintrin.h>
+#include <math.h>
+
+#include "snackpack/snackpack.h"
+#include "snackpack/internal/blas2_real_simd.h"
+
+
+/* Mask with the first rem (< 8) lanes set, for maskload/maskstore. */
+static inline __m256i
+tail_mask(len_t rem)
+{
+    return _mm256_cmpgt_epi32(
+        _mm256_set1_epi32((int)rem),
+        _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+}
+
+
+/*
+ * Starting value of y for the current sweep: zero on the first sweep when
+ * beta is zero (so that NaN in y is cleared, as in sscal), y itself after
+ * the first sweep, and beta * y otherwise.
+ */
+static inline __m256
+load_y(
+    const float * const y,
+    float beta,
+    __m256 vb)
+{
+    if (beta == 0.0f) {
+        return _mm256_setzero_ps();
+    } else if (beta == 1.0f) {
+        return _mm256_loadu_ps(y);
+    }
+    return _mm256_mul_ps(vb, _mm256_loadu_ps(y));
+}
+
+
+static inline __m256
+maskload_y(
+    const float * const y,
+    __m256i mask,
+    float beta,
+    __m256 vb)
+{
+    if (beta == 0.0f) {
+        return _mm256_setzero_ps();
+    } else if (beta == 1.0f) {
+        return _mm256_maskload_ps(y, mask);
+    }
+    return _mm256_mul_ps(vb, _mm256_maskload_ps(y, mask));
+}
+
+
+/* sgemv for A*x with inc_y = 1 */
+void
+sp_blas_sgemv_n_inc1_avx2(
+    len_t rows,
+    len_t cols,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    const float * const x,
+    len_t inc_x,
+    float beta,
+    float * const y)
+{
+    len_t ix0 = inc_x < 0 ? (len_t)((1 - cols) * inc_x) : 0;
+
+    for (len_t r0 = 0; r0 < rows; r0 += SP_SGEMV_ROW_BLOCK) {
+        len_t mb = rows - r0 < SP_SGEMV_ROW_BLOCK ?
+            rows - r0 : SP_SGEMV_ROW_BLOCK;
+        float * yb = y + r0;
+        float b = beta;
+        len_t ix = ix0;
+        len_t i = 0;
+
+        for (; i + 4 <= cols; i += 4) {
+            const float * a0 = A + r0 + i * lda;
+            const float * a1 = a0 + lda;
+            const float * a2 = a1 + lda;
+            const float * a3 = a2 + lda;
+            __m256 t0 = _mm256_set1_ps(alpha * x[ix]);
+            __m256 t1 = _mm256_set1_ps(alpha * x[ix + inc_x]);
+            __m256 t2 = _mm256_set1_ps(alpha * x[ix + 2 * inc_x]);
+            __m256 t3 = _mm256_set1_ps(alpha * x[ix + 3 * inc_x]);
+            __m256 vb = _mm256_set1_ps(b);
+            len_t j = 0;
+
+            for (; j + 16 <= mb; j += 16) {
+                __m256 y0 = load_y(yb + j, b, vb);
+                __m256 y1 = load_y(yb + j + 8, b, vb);
+                y0 = _mm256_fmadd_ps(_mm256_loadu_ps(a0 + j), t0, y0);
+                y1 = _mm256_fmadd_ps(_mm256_loadu_ps(a0 + j + 8), t0, y1);
+                y0 = _mm256_fmadd_ps(_mm256_loadu_ps(a1 + j), t1, y0);
+                y1 = _mm256_fmadd_ps(_mm256_loadu_ps(a1 + j + 8), t1, y1);
+                y0 = _mm256_fmadd_ps(_mm256_loadu_ps(a2 + j), t2, y0);
+                y1 = _mm256_fmadd_ps(_mm256_loadu_ps(a2 + j + 8), t2, y1);
+                y0 = _mm256_fmadd_ps(_mm256_loadu_ps(a3 + j), t3, y0);
+                y1 = _mm256_fmadd_ps(_mm256_loadu_ps(a3 + j + 8), t3, y1);
+                _mm256_storeu_ps(yb + j, y0);
+                _mm256_storeu_ps(yb + j + 8, y1);
+            }
+            for (; j + 8 <= mb; j += 8) {
+                __m256 y0 = load_y(yb + j, b, vb);
+                y0 = _mm256_fmadd_ps(_mm256_loadu_ps(a0 + j), t0, y0);
+                y0 = _mm256_fmadd_ps(_mm256_loadu_ps(a1 + j), t1, y0);
+                y0 = _mm256_fmadd_ps(_mm256_loadu_ps(a2 + j), t2, y0);
+                y0 = _mm256_fmadd_ps(_mm256_loadu_ps(a3 + j), t3, y0);
+                _mm256_storeu_ps(yb + j, y0);
+            }
+            if (j < mb) {
+                __m256i mask = tail_mask(mb - j);
+                __m256 y0 = maskload_y(yb + j, mask, b, vb);
+                y0 = _mm256_fmadd_ps(_mm256_maskload_ps(a0 + j, mask), t0, y0);
+                y0 = _mm256_fmadd_ps(_mm256_maskload_ps(a1 + j, mask), t1, y0);
+                y0 = _mm256_fmadd_ps(_mm256_maskload_ps(a2 + j, mask), t2, y0);
+                y0 = _mm256_fmadd_ps(_mm256_maskload_ps(a3 + j, mask), t3, y0);
+                _mm256_maskstore_ps(yb + j, mask, y0);
+            }
+            b = 1.0f;
+            ix += 4 * inc_x;
+        }
+
+        for (; i < cols; i++) {
+            const float * a0 = A + r0 + i * lda;
+            __m256 t0 = _mm256_set1_ps(alpha * x[ix]);
+            __m256 vb = _mm256_set1_ps(b);
+            len_t j = 0;
+
+            for (; j + 8 <= mb; j += 8) {
+                __m256 y0 = load_y(yb + j, b, vb);
+                y0 = _mm256_fmadd_ps(_mm256_loadu_ps(a0 + j), t0, y0);
+                _mm256_storeu_ps(yb + j, y0);
+            }
+            if (j < mb) {
+                __m256i mask = tail_mask(mb - j);
+                __m256 y0 = maskload_y(yb + j, mask, b, vb);
+                y0 = _mm256_fmadd_ps(_mm256_maskload_ps(a0 + j, mask), t0, y0);
+                _mm256_maskstore_ps(yb + j, mask, y0);
+            }
+            b = 1.0f;
+            ix += inc_x;
+        }
+    }
+}
+
+
+/* Horizontal sums of four vectors, returned as one vector {v0, .., v3}. */
+static inline __m128
+hsum4(
+    __m256 v0,
+    __m256 v1,
+    __m256 v2,
+    __m256 v3)
+{
+    __m256 s = _mm256_hadd_ps(_mm256_hadd_ps(v0, v1), _mm256_hadd_ps(v2, v3));
+    return _mm_add_ps(_mm256_castps256_ps128(s), _mm256_extractf128_ps(s, 1));
+}
+
+
+/*
+ * New value of y_i in the transposed kernels, given s = alpha * (A^T*x)_i.
+ * beta == 0 ignores the old value entirely, so that NaN in y is cleared as
+ * in sscal. The fused multiply-add is explicit so that the column groups
+ * and the leftover columns round the same way, and a column's result does
+ * not depend on which group it lands in when the work is split.
+ */
+static inline float
+update_y(
+    float beta,
+    float y,
+    float s)
+{
+    return beta == 0.0f ? s : fmaf(beta, y, s);
+}
+
+
+/* sgemv for A^T*x with inc_x = 1 */
+void
+sp_blas_sgemv_t_inc1_avx2(
+    len_t rows,
+    len_t cols,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    const float * const x,
+    float beta,
+    float * const y,
+    len_t inc_y)
+{
+    len_t iy = inc_y < 0 ? (len_t)((1 - cols) * inc_y) : 0;
+    len_t i = 0;
+
+    for (; i + 4 <= cols; i += 4) {
+        const float * a0 = A + i * lda;
+        const float * a1 = a0 + lda;
+        const float * a2 = a1 + lda;
+        const float * a3 = a2 + lda;
+        __m256 c00 = _mm256_setzero_ps(), c01 = _mm256_setzero_ps();
+        __m256 c10 = _mm256_setzero_ps(), c11 = _mm256_setzero_ps();
+        __m256 c20 = _mm256_setzero_ps(), c21 = _mm256_setzero_ps();
+        __m256 c30 = _mm256_setzero_ps(), c31 = _mm256_setzero_ps();
+        len_t j = 0;
+
+        for (; j + 16 <= rows; j += 16) {
+            __m256 x0 = _mm256_loadu_ps(x + j);
+            __m256 x1 = _mm256_loadu_ps(x + j + 8);
+            c00 = _mm256_fmadd_ps(_mm256_loadu_ps(a0 + j), x0, c00);
+            c01 = _mm256_fmadd_ps(_mm256_loadu_ps(a0 + j + 8), x1, c01);
+            c10 = _mm256_fmadd_ps(_mm256_loadu_ps(a1 + j), x0, c10);
+            c11 = _mm256_fmadd_ps(_mm256_loadu_ps(a1 + j + 8), x1, c11);
+            c20 = _mm256_fmadd_ps(_mm256_loadu_ps(a2 + j), x0, c20);
+            c21 = _mm256_fmadd_ps(_mm256_loadu_ps(a2 + j + 8), x1, c21);
+            c30 = _mm256_fmadd_ps(_mm256_loadu_ps(a3 + j), x0, c30);
+            c31 = _mm256_fmadd_ps(_mm256_loadu_ps(a3 + j + 8), x1, c31);
+        }
+        for (; j + 8 <= rows; j += 8) {
+            __m256 x0 = _mm256_loadu_ps(x + j);
+            c00 = _mm256_fmadd_ps(_mm256_loadu_ps(a0 + j), x0, c00);
+            c10 = _mm256_fmadd_ps(_mm256_loadu_ps(a1 + j), x0, c10);
+            c20 = _mm256_fmadd_ps(_mm256_loadu_ps(a2 + j), x0, c20);
+            c30 = _mm256_fmadd_ps(_mm256_loadu_ps(a3 + j), x0, c30);
+        }
+        if (j < rows) {
+            __m256i mask = tail_mask(rows - j);
+            __m256 x0 = _mm256_maskload_ps(x + j, mask);
+            c01 = _mm256_fmadd_ps(_mm256_maskload_ps(a0 + j, mask), x0, c01);
+            c11 = _mm256_fmadd_ps(_mm256_maskload_ps(a1 + j, mask), x0, c11);
+            c21 = _mm256_fmadd_ps(_mm256_maskload_ps(a2 + j, mask), x0, c21);
+            c31 = _mm256_fmadd_ps(_mm256_maskload_ps(a3 + j, mask), x0, c31);
+        }
+
+        float sum[4];
+        _mm_storeu_ps(sum, _mm_mul_ps(_mm_set1_ps(alpha), hsum4(
+            _mm256_add_ps(c00, c01), _mm256_add_ps(c10, c11),
+            _mm256_add_ps(c20, c21), _mm256_add_ps(c30, c31))));
+        for (len_t k = 0; k < 4; k++) {
+            y[iy] = update_y(beta, y[iy], sum[k]);
+            iy += inc_y;
+        }
+    }
+
+    for (; i < cols; i++) {
+        const float * a0 = A + i * lda;
+        __m256 c00 = _mm256_setzero_ps(), c01 = _mm256_setzero_ps();
+        len_t j = 0;
+
+        for (; j + 16 <= rows; j += 16) {
+            c00 = _mm256_fmadd_ps(
+                _mm256_loadu_ps(a0 + j), _mm256_loadu_ps(x + j), c00);
+            c01 = _mm256_fmadd_ps(
+                _mm256_loadu_ps(a0 + j + 8), _mm256_loadu_ps(x + j + 8), c01);
+        }
+        for (; j + 8 <= rows; j += 8) {
+            c00 = _mm256_fmadd_ps(
+                _mm256_loadu_ps(a0 + j), _mm256_loadu_ps(x + j), c00);
+        }
+        if (j < rows) {
+            __m256i mask = tail_mask(rows - j);
+            c01 = _mm256_fmadd_ps(_mm256_maskload_ps(a0 + j, mask),
+                _mm256_maskload_ps(x + j, mask), c01);
+        }
+
+        /* Same reduction as the four-column case, lane 0 only. */
+        __m256 zero = _mm256_setzero_ps();
+        float sum = _mm_cvtss_f32(_mm_mul_ss(_mm_set_ss(alpha),
+            hsum4(_mm256_add_ps(c00, c01), zero, zero, zero)));
+        y[iy] = update_y(beta, y[iy], sum);
+        iy += inc_y;
+    }
+}
+
+/*
+ * Small-matrix kernels for the batched sgemv. Each row count gets its own
+ * unrolled kernel that keeps the whole of y (A*x) or a group of columns
+ * (A^T*x) in registers. alpha is applied once to the finished product, and
+ * beta == 0 ignores the old y as above.
+ */
+
+
+static inline __m128
+small_y4(
+    __m128 acc,
+    float alpha,
+    float beta,
+    const float * const y)
+{
+    __m128 s = _mm_mul_ps(_mm_set1_ps(alpha), acc);
+    if (beta == 0.0f) {
+        return s;
+    }
+    return _mm_fmadd_ps(_mm_set1_ps(beta), _mm_loadu_ps(y), s);
+}
+
+
+static inline __m256
+small_y8(
+    __m256 acc,
+    float alpha,
+    float beta,
+    const float * const y)
+{
+    __m256 s = _mm256_mul_ps(_mm256_set1_ps(alpha), acc);
+    if (beta == 0.0f) {
+        return s;
+    }
+    return _mm256_fmadd_ps(_mm256_set1_ps(beta), _mm256_loadu_ps(y), s);
+}
+
+
+/* A*x for 4, 8 and 16 rows. Two accumulators per row group hide latency. */
+static inline void
+sgemv_n_4(
+    len_t cols,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    const float * const x,
+    float beta,
+    float * const y)
+{
+    __m128 c0 = _mm_setzero_ps(), c1 = _mm_setzero_ps();
+    len_t j = 0;
+    for (; j + 2 <= cols; j += 2) {
+        c0 = _mm_fmadd_ps(_mm_loadu_ps(A + j * lda), _mm_set1_ps(x[j]), c0);
+        c1 = _mm_fmadd_ps(
+            _mm_loadu_ps(A + (j + 1) * lda), _mm_set1_ps(x[j + 1]), c1);
+    }
+    if (j < cols) {
+        c0 = _mm_fmadd_ps(_mm_loadu_ps(A + j * lda), _mm_set1_ps(x[j]), c0);
+    }
+    _mm_storeu_ps(y, small_y4(_mm_add_ps(c0, c1), alpha, beta, y));
+}
+
+
+static inline void
+sgemv_n_8(
+    len_t cols,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    const float * const x,
+    float beta,
+    float * const y)
+{
+    __m256 c0 = _mm256_setzero_ps(), c1 = _mm256_setzero_ps();
+    len_t j = 0;
+    for (; j + 2 <= cols; j += 2) {
+        c0 = _mm256_fmadd_ps(
+            _mm256_loadu_ps(A + j * lda), _mm256_set1_ps(x[j]), c0);
+        c1 = _mm256_fmadd_ps(
+            _mm256_loadu_ps(A + (j + 1) * lda), _mm256_set1_ps(x[j + 1]), c1);
+    }
+    if (j < cols) {
+        c0 = _mm256_fmadd_ps(
+            _mm256_loadu_ps(A + j * lda), _mm256_set1_ps(x[j]), c0);
+    }
+    _mm256_storeu_ps(y, small_y8(_mm256_add_ps(c0, c1), alpha, beta, y));
+}
+
+
+static inline void
+sgemv_n_16(
+    len_t cols,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    const float * const x,
+    float beta,
+    float * const y)
+{
+    __m256 c00 = _mm256_setzero_ps(), c01 = _mm256_setzero_ps();
+    __m256 c10 = _mm256_setzero_ps(), c11 = _mm256_setzero_ps();
+    len_t j = 0;
+    for (; j + 2 <= cols; j += 2) {
+        const float * a0 = A + j * lda;
+        const float * a1 = a0 + lda;
+        __m256 t0 = _mm256_set1_ps(x[j]);
+        __m256 t1 = _mm256_set1_ps(x[j + 1]);
+        c00 = _mm256_fmadd_ps(_mm256_loadu_ps(a0), t0, c00);
+        c01 = _mm256_fmadd_ps(_mm256_loadu_ps(a0 + 8), t0, c01);
+        c10 = _mm256_fmadd_ps(_mm256_loadu_ps(a1), t1, c10);
+        c11 = _mm256_fmadd_ps(_mm256_loadu_ps(a1 + 8), t1, c11);
+    }
+    if (j < cols) {
+        const float * a0 = A + j * lda;
+        __m256 t0 = _mm256_set1_ps(x[j]);
+        c00 = _mm256_fmadd_ps(_mm256_loadu_ps(a0), t0, c00);
+        c01 = _mm256_fmadd_ps(_mm256_loadu_ps(a0 + 8), t0, c01);
+    }
+    _mm256_storeu_ps(y,
+        small_y8(_mm256_add_ps(c00, c10), alpha, beta, y));
+    _mm256_storeu_ps(y + 8,
+        small_y8(_mm256_add_ps(c01, c11), alpha, beta, y + 8));
+}
+
+
+/* sgemv for A*x with 4, 8 or 16 rows and unit increments */
+void
+sp_blas_sgemv_n_small_avx2(
+    len_t rows,
+    len_t cols,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    const float * const x,
+    float beta,
+    float * const y)
+{
+    switch (rows) {
+    case 4:
+        sgemv_n_4(cols, alpha, A, lda, x, beta, y);
+        break;
+    case 8:
+        sgemv_n_8(cols, alpha, A, lda, x, beta, y);
+        break;
+    default:
+        sgemv_n_16(cols, alpha, A, lda, x, beta, y);
+        break;
+    }
+}
+
+
+/*
+ * Horizontal sums of eight vectors, returned as one vector {v0, .., v7}.
+ * The columns of the transposed small kernels are reduced eight at a time.
+ */
+static inline __m256
+hsum8(
+    __m256 v0,
+    __m256 v1,
+    __m256 v2,
+    __m256 v3,
+    __m256 v4,
+    __m256 v5,
+    __m256 v6,
+    __m256 v7)
+{
+    __m256 s0 = _mm256_hadd_ps(_mm256_hadd_ps(v0, v1), _mm256_hadd_ps(v2, v3));
+    __m256 s1 = _mm256_hadd_ps(_mm256_hadd_ps(v4, v5), _mm256_hadd_ps(v6, v7));
+    return _mm256_add_ps(
+        _mm256_permute2f128_ps(s0, s1, 0x20),
+        _mm256_permute2f128_ps(s0, s1, 0x31));
+}
+
+
+/* Product of column j of A with x, for 8 or 16 rows, as 8 lanes. */
+static inline __m256
+column_dot(
+    len_t rows,
+    const float * const a,
+    __m256 x0,
+    __m256 x1)
+{
+    __m256 p = _mm256_mul_ps(_mm256_loadu_ps(a), x0);
+    return rows == 16 ? _mm256_fmadd_ps(_mm256_loadu_ps(a + 8), x1, p) : p;
+}
+
+
+/* A^T*x for 8 or 16 rows. */
+static inline void
+sgemv_t_8_16(
+    len_t rows,
+    len_t cols,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    const float * const x,
+    float beta,
+    float * const y)
+{
+    __m256 x0 = _mm256_loadu_ps(x);
+    __m256 x1 = rows == 16 ? _mm256_loadu_ps(x + 8) : _mm256_setzero_ps();
+    len_t j = 0;
+
+    for (; j + 8 <= cols; j += 8) {
+        const float * a = A + j * lda;
+        __m256 s = hsum8(
+            column_dot(rows, a, x0, x1),
+            column_dot(rows, a + lda, x0, x1),
+            column_dot(rows, a + 2 * lda, x0, x1),
+            column_dot(rows, a + 3 * lda, x0, x1),
+            column_dot(rows, a + 4 * lda, x0, x1),
+            column_dot(rows, a + 5 * lda, x0, x1),
+            column_dot(rows, a + 6 * lda, x0, x1),
+            column_dot(rows, a + 7 * lda, x0, x1));
+        _mm256_storeu_ps(y + j, small_y8(s, alpha, beta, y + j));
+    }
+    for (; j < cols; j++) {
+        __m256 zero = _mm256_setzero_ps();
+        float s = _mm_cvtss_f32(hsum4(
+            column_dot(rows, A + j * lda, x0, x1), zero, zero, zero));
+        y[j] = update_y(beta, y[j], alpha * s);
+    }
+}
+
+
+static inline void
+sgemv_t_4(
+    len_t cols,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    const float * const x,
+    float beta,
+    float * const y)
+{
+    __m128 x0 = _mm_loadu_ps(x);
+    len_t j = 0;
+
+    for (; j + 4 <= cols; j += 4) {
+        const float * a = A + j * lda;
+        __m128 p0 = _mm_mul_ps(_mm_loadu_ps(a), x0);
+        __m128 p1 = _mm_mul_ps(_mm_loadu_ps(a + lda), x0);
+        __m128 p2 = _mm_mul_ps(_mm_loadu_ps(a + 2 * lda), x0);
+        __m128 p3 = _mm_mul_ps(_mm_loadu_ps(a + 3 * lda), x0);
+        __m128 s = _mm_hadd_ps(_mm_hadd_ps(p0, p1), _mm_hadd_ps(p2, p3));
+        _mm_storeu_ps(y + j, small_y4(s, alpha, beta, y + j));
+    }
+    for (; j < cols; j++) {
+        __m128 p = _mm_mul_ps(_mm_loadu_ps(A + j * lda), x0);
+        __m128 s = _mm_hadd_ps(_mm_hadd_ps(p, p), p);
+        y[j] = update_y(beta, y[j], alpha * _mm_cvtss_f32(s));
+    }
+}
+
+
+/* sgemv for A^T*x with 4, 8 or 16 rows and unit increments */
+void
+sp_blas_sgemv_t_small_avx2(
+    len_t rows,
+    len_t cols,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    const float * const x,
+    float beta,
+    float * const y)
+{
+    if (rows == 4) {
+        sgemv_t_4(cols, alpha, A, lda, x, beta, y);
+    } else {
+        sgemv_t_8_16(rows, cols, alpha, A, lda, x, beta, y);
+    }
+}
+
+/*
+ * Rank-1 update A += x*t^T. Each block of 32 rows of x is held in four
+ * registers while it is added into every column; the last rows are done
+ * 8 at a time and then with a mask.
+ */
+void
+sp_blas_sger_inc1_avx2(
+    len_t rows,
+    len_t cols,
+    const float * const x,
+    const float * const t,
+    float * const A,
+    len_t lda)
+{
+    len_t r0 = 0;
+
+    for (; r0 + 32 <= rows; r0 += 32) {
+        __m256 x0 = _mm256_loadu_ps(x + r0);
+        __m256 x1 = _mm256_loadu_ps(x + r0 + 8);
+        __m256 x2 = _mm256_loadu_ps(x + r0 + 16);
+        __m256 x3 = _mm256_loadu_ps(x + r0 + 24);
+        for (len_t j = 0; j < cols; j++) {
+            float * a = A + r0 + j * lda;
+            __m256 tj = _mm256_broadcast_ss(t + j);
+            _mm256_storeu_ps(a,
+                _mm256_fmadd_ps(x0, tj, _mm256_loadu_ps(a)));
+            _mm256_storeu_ps(a + 8,
+                _mm256_fmadd_ps(x1, tj, _mm256_loadu_ps(a + 8)));
+            _mm256_storeu_ps(a + 16,
+                _mm256_fmadd_ps(x2, tj, _mm256_loadu_ps(a + 16)));
+            _mm256_storeu_ps(a + 24,
+                _mm256_fmadd_ps(x3, tj, _mm256_loadu_ps(a + 24)));
+        }
+    }
+
+    for (; r0 + 8 <= rows; r0 += 8) {
+        __m256 x0 = _mm256_loadu_ps(x + r0);
+        for (len_t j = 0; j < cols; j++) {
+            float * a = A + r0 + j * lda;
+            __m256 tj = _mm256_broadcast_ss(t + j);
+            _mm256_storeu_ps(a,
+                _mm256_fmadd_ps(x0, tj, _mm256_loadu_ps(a)));
+        }
+    }
+
+    if (r0 < rows) {
+        __m256i mask = tail_mask(rows - r0);
+        __m256 x0 = _mm256_maskload_ps(x + r0, mask);
+        for (len_t j = 0; j < cols; j++) {
+            float * a = A + r0 + j * lda;
+            __m256 tj = _mm256_broadcast_ss(t + j);
+            _mm256_maskstore_ps(a, mask,
+                _mm256_fmadd_ps(x0, tj, _mm256_maskload_ps(a, mask)));
+        }
+    }
+}
+
+
+/*
+ * Symmetric block update y_r += alpha*M*x_c, y_c += alpha*M^T*x_r. Each
+ * load of four columns of M feeds both the update of y_r and the four dot
+ * products for y_c.
+ */
+void
+sp_blas_ssymv_panel_inc1_avx2(
+    len_t rows,
+    len_t cols,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    const float * const x_r,
+    const float * const x_c,
+    float * const y_r,
+    float * const y_c)
+{
+    len_t i = 0;
+
+    for (; i + 4 <= cols; i += 4) {
+        const float * a0 = A + i * lda;
+        const float * a1 = a0 + lda;
+        const float * a2 = a1 + lda;
+        const float * a3 = a2 + lda;
+        __m256 t0 = _mm256_set1_ps(alpha * x_c[i]);
+        __m256 t1 = _mm256_set1_ps(alpha * x_c[i + 1]);
+        __m256 t2 = _mm256_set1_ps(alpha * x_c[i + 2]);
+        __m256 t3 = _mm256_set1_ps(alpha * x_c[i + 3]);
+        __m256 c0 = _mm256_setzero_ps();
+        __m256 c1 = _mm256_setzero_ps();
+        __m256 c2 = _mm256_setzero_ps();
+        __m256 c3 = _mm256_setzero_ps();
+        len_t j = 0;
+
+        for (; j + 8 <= rows; j += 8) {
+            __m256 x = _mm256_loadu_ps(x_r + j);
+            __m256 v0 = _mm256_loadu_ps(a0 + j);
+            __m256 v1 = _mm256_loadu_ps(a1 + j);
+            __m256 v2 = _mm256_loadu_ps(a2 + j);
+            __m256 v3 = _mm256_loadu_ps(a3 + j);
+            __m256 y = _mm256_loadu_ps(y_r + j);
+            y = _mm256_fmadd_ps(v0, t0, y);
+            y = _mm256_fmadd_ps(v1, t1, y);
+            y = _mm256_fmadd_ps(v2, t2, y);
+            y = _mm256_fmadd_ps(v3, t3, y);
+            _mm256_storeu_ps(y_r + j, y);
+            c0 = _mm256_fmadd_ps(v0, x, c0);
+            c1 = _mm256_fmadd_ps(v1, x, c1);
+            c2 = _mm256_fmadd_ps(v2, x, c2);
+            c3 = _mm256_fmadd_ps(v3, x, c3);
+        }
+        if (j < rows) {
+            __m256i mask = tail_mask(rows - j);
+            __m256 x = _mm256_maskload_ps(x_r + j, mask);
+            __m256 v0 = _mm256_maskload_ps(a0 + j, mask);
+            __m256 v1 = _mm256_maskload_ps(a1 + j, mask);
+            __m256 v2 = _mm256_maskload_ps(a2 + j, mask);
+            __m256 v3 = _mm256_maskload_ps(a3 + j, mask);
+            __m256 y = _mm256_maskload_ps(y_r + j, mask);
+            y = _mm256_fmadd_ps(v0, t0, y);
+            y = _mm256_fmadd_ps(v1, t1, y);
+            y = _mm256_fmadd_ps(v2, t2, y);
+            y = _mm256_fmadd_ps(v3, t3, y);
+            _mm256_maskstore_ps(y_r + j, mask, y);
+            c0 = _mm256_fmadd_ps(v0, x, c0);
+            c1 = _mm256_fmadd_ps(v1, x, c1);
+            c2 = _mm256_fmadd_ps(v2, x, c2);
+            c3 = _mm256_fmadd_ps(v3, x, c3);
+        }
+
+        __m128 yc = _mm_loadu_ps(y_c + i);
+        yc = _mm_fmadd_ps(_mm_set1_ps(alpha), hsum4(c0, c1, c2, c3), yc);
+        _mm_storeu_ps(y_c + i, yc);
+    }
+
+    for (; i < cols; i++) {
+        const float * a0 = A + i * lda;
+        __m256 t0 = _mm256_set1_ps(alpha * x_c[i]);
+        __m256 c0 = _mm256_setzero_ps();
+        len_t j = 0;
+
+        for (; j + 8 <= rows; j += 8) {
+            __m256 v0 = _mm256_loadu_ps(a0 + j);
+            _mm256_storeu_ps(y_r + j,
+                _mm256_fmadd_ps(v0, t0, _mm256_loadu_ps(y_r + j)));
+            c0 = _mm256_fmadd_ps(v0, _mm256_loadu_ps(x_r + j), c0);
+        }
+        if (j < rows) {
+            __m256i mask = tail_mask(rows - j);
+            __m256 v0 = _mm256_maskload_ps(a0 + j, mask);
+            _mm256_maskstore_ps(y_r + j, mask,
+                _mm256_fmadd_ps(v0, t0, _mm256_maskload_ps(y_r + j, mask)));
+            c0 = _mm256_fmadd_ps(v0, _mm256_maskload_ps(x_r + j, mask), c0);
+        }
+
+        __m256 zero = _mm256_setzero_ps();
+        y_c[i] += alpha * _mm_cvtss_f32(hsum4(c0, zero, zero, zero));
+    }
+}
+
+
+#endif
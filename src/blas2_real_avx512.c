@@ -0,0 +1,279 @@
+/*
+ * AVX-512F versions of the level 2 kernels. This file is compiled with
+ * -mavx512f -mfma.
+ */
+#if defined(__AVX512F__)
+
+#include <immintrin.h>
+#include <math.h>
+
+#include "snackpack/snackpack.h"
+#include "snackpack/internal/blas2_real_simd.h"
+
+
+/* Mask with the first rem (<= 16) lanes set. */
+static inline __mmask16
+lane_mask(len_t rem)
+{
+    return rem >= 16 ? (__mmask16)0xffff : (__mmask16)((1u << rem) - 1u);
+}
+
+
+/*
+ * Starting value of y for the current sweep: zero on the first sweep when
+ * beta is zero (so that NaN in y is cleared, as in sscal), y itself after
+ * the first sweep, and beta * y otherwise.
+ */
+static inline __m512
+load_y(
+    const float * const y,
+    __mmask16 mask,
+    float beta,
+    __m512 vb)
+{
+    if (beta == 0.0f) {
+        return _mm512_setzero_ps();
+    } else if (beta == 1.0f) {
+        return _mm512_maskz_loadu_ps(mask, y);
+    }
+    return _mm512_mul_ps(vb, _mm512_maskz_loadu_ps(mask, y));
+}
+
+
+/* sgemv for A*x with inc_y = 1 */
+void
+sp_blas_sgemv_n_inc1_avx512(
+    len_t rows,
+    len_t cols,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    const float * const x,
+    len_t inc_x,
+    float beta,
+    float * const y)
+{
+    len_t ix0 = inc_x < 0 ? (len_t)((1 - cols) * inc_x) : 0;
+
+    for (len_t r0 = 0; r0 < rows; r0 += SP_SGEMV_ROW_BLOCK) {
+        len_t mb = rows - r0 < SP_SGEMV_ROW_BLOCK ?
+            rows - r0 : SP_SGEMV_ROW_BLOCK;
+        float * yb = y + r0;
+        float b = beta;
+        len_t ix = ix0;
+        len_t i = 0;
+
+        for (; i + 4 <= cols; i += 4) {
+            const float * a0 = A + r0 + i * lda;
+            const float * a1 = a0 + lda;
+            const float * a2 = a1 + lda;
+            const float * a3 = a2 + lda;
+            __m512 t0 = _mm512_set1_ps(alpha * x[ix]);
+            __m512 t1 = _mm512_set1_ps(alpha * x[ix + inc_x]);
+            __m512 t2 = _mm512_set1_ps(alpha * x[ix + 2 * inc_x]);
+            __m512 t3 = _mm512_set1_ps(alpha * x[ix + 3 * inc_x]);
+            __m512 vb = _mm512_set1_ps(b);
+            len_t j = 0;
+
+            for (; j + 32 <= mb; j += 32) {
+                __m512 y0 = load_y(yb + j, 0xffff, b, vb);
+                __m512 y1 = load_y(yb + j + 16, 0xffff, b, vb);
+                y0 = _mm512_fmadd_ps(_mm512_loadu_ps(a0 + j), t0, y0);
+                y1 = _mm512_fmadd_ps(_mm512_loadu_ps(a0 + j + 16), t0, y1);
+                y0 = _mm512_fmadd_ps(_mm512_loadu_ps(a1 + j), t1, y0);
+                y1 = _mm512_fmadd_ps(_mm512_loadu_ps(a1 + j + 16), t1, y1);
+                y0 = _mm512_fmadd_ps(_mm512_loadu_ps(a2 + j), t2, y0);
+                y1 = _mm512_fmadd_ps(_mm512_loadu_ps(a2 + j + 16), t2, y1);
+                y0 = _mm512_fmadd_ps(_mm512_loadu_ps(a3 + j), t3, y0);
+                y1 = _mm512_fmadd_ps(_mm512_loadu_ps(a3 + j + 16), t3, y1);
+                _mm512_storeu_ps(yb + j, y0);
+                _mm512_storeu_ps(yb + j + 16, y1);
+            }
+            for (; j < mb; j += 16) {
+                __mmask16 mask = lane_mask(mb - j);
+                __m512 y0 = load_y(yb + j, mask, b, vb);
+                y0 = _mm512_fmadd_ps(
+                    _mm512_maskz_loadu_ps(mask, a0 + j), t0, y0);
+                y0 = _mm512_fmadd_ps(
+                    _mm512_maskz_loadu_ps(mask, a1 + j), t1, y0);
+                y0 = _mm512_fmadd_ps(
+                    _mm512_maskz_loadu_ps(mask, a2 + j), t2, y0);
+                y0 = _mm512_fmadd_ps(
+                    _mm512_maskz_loadu_ps(mask, a3 + j), t3, y0);
+                _mm512_mask_storeu_ps(yb + j, mask, y0);
+            }
+            b = 1.0f;
+            ix += 4 * inc_x;
+        }
+
+        for (; i < cols; i++) {
+            const float * a0 = A + r0 + i * lda;
+            __m512 t0 = _mm512_set1_ps(alpha * x[ix]);
+            __m512 vb = _mm512_set1_ps(b);
+
+            for (len_t j = 0; j < mb; j += 16) {
+                __mmask16 mask = lane_mask(mb - j);
+                __m512 y0 = load_y(yb + j, mask, b, vb);
+                y0 = _mm512_fmadd_ps(
+                    _mm512_maskz_loadu_ps(mask, a0 + j), t0, y0);
+                _mm512_mask_storeu_ps(yb + j, mask, y0);
+            }
+            b = 1.0f;
+            ix += inc_x;
+        }
+    }
+}
+
+
+/*
+ * New value of y_i in the transposed kernels, given s = alpha * (A^T*x)_i.
+ * beta == 0 ignores the old value entirely, so that NaN in y is cleared as
+ * in sscal. The fused multiply-add is explicit so that the column groups
+ * and the leftover columns round the same way, and a column's result does
+ * not depend on which group it lands in when the work is split.
+ */
+static inline float
+update_y(
+    float beta,
+    float y,
+    float s)
+{
+    return beta == 0.0f ? s : fmaf(beta, y, s);
+}
+
+
+/* sgemv for A^T*x with inc_x = 1 */
+void
+sp_blas_sgemv_t_inc1_avx512(
+    len_t rows,
+    len_t cols,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    const float * const x,
+    float beta,
+    float * const y,
+    len_t inc_y)
+{
+    len_t iy = inc_y < 0 ? (len_t)((1 - cols) * inc_y) : 0;
+    len_t i = 0;
+
+    for (; i + 4 <= cols; i += 4) {
+        const float * a0 = A + i * lda;
+        const float * a1 = a0 + lda;
+        const float * a2 = a1 + lda;
+        const float * a3 = a2 + lda;
+        __m512 c00 = _mm512_setzero_ps(), c01 = _mm512_setzero_ps();
+        __m512 c10 = _mm512_setzero_ps(), c11 = _mm512_setzero_ps();
+        __m512 c20 = _mm512_setzero_ps(), c21 = _mm512_setzero_ps();
+        __m512 c30 = _mm512_setzero_ps(), c31 = _mm512_setzero_ps();
+        len_t j = 0;
+
+        for (; j + 32 <= rows; j += 32) {
+            __m512 x0 = _mm512_loadu_ps(x + j);
+            __m512 x1 = _mm512_loadu_ps(x + j + 16);
+            c00 = _mm512_fmadd_ps(_mm512_loadu_ps(a0 + j), x0, c00);
+            c01 = _mm512_fmadd_ps(_mm512_loadu_ps(a0 + j + 16), x1, c01);
+            c10 = _mm512_fmadd_ps(_mm512_loadu_ps(a1 + j), x0, c10);
+            c11 = _mm512_fmadd_ps(_mm512_loadu_ps(a1 + j + 16), x1, c11);
+            c20 = _mm512_fmadd_ps(_mm512_loadu_ps(a2 + j), x0, c20);
+            c21 = _mm512_fmadd_ps(_mm512_loadu_ps(a2 + j + 16), x1, c21);
+            c30 = _mm512_fmadd_ps(_mm512_loadu_ps(a3 + j), x0, c30);
+            c31 = _mm512_fmadd_ps(_mm512_loadu_ps(a3 + j + 16), x1, c31);
+        }
+        for (; j < rows; j += 16) {
+            __mmask16 mask = lane_mask(rows - j);
+            __m512 x0 = _mm512_maskz_loadu_ps(mask, x + j);
+            c00 = _mm512_fmadd_ps(
+                _mm512_maskz_loadu_ps(mask, a0 + j), x0, c00);
+            c10 = _mm512_fmadd_ps(
+                _mm512_maskz_loadu_ps(mask, a1 + j), x0, c10);
+            c20 = _mm512_fmadd_ps(
+                _mm512_maskz_loadu_ps(mask, a2 + j), x0, c20);
+            c30 = _mm512_fmadd_ps(
+                _mm512_maskz_loadu_ps(mask, a3 + j), x0, c30);
+        }
+
+        float sum[4];
+        sum[0] = alpha * _mm512_reduce_add_ps(_mm512_add_ps(c00, c01));
+        sum[1] = alpha * _mm512_reduce_add_ps(_mm512_add_ps(c10, c11));
+        sum[2] = alpha * _mm512_reduce_add_ps(_mm512_add_ps(c20, c21));
+        sum[3] = alpha * _mm512_reduce_add_ps(_mm512_add_ps(c30, c31));
+        for (len_t k = 0; k < 4; k++) {
+            y[iy] = update_y(beta, y[iy], sum[k]);
+            iy += inc_y;
+        }
+    }
+
+    for (; i < cols; i++) {
+        const float * a0 = A + i * lda;
+        __m512 c00 = _mm512_setzero_ps(), c01 = _mm512_setzero_ps();
+        len_t j = 0;
+
+        for (; j + 32 <= rows; j += 32) {
+            c00 = _mm512_fmadd_ps(
+                _mm512_loadu_ps(a0 + j), _mm512_loadu_ps(x + j), c00);
+            c01 = _mm512_fmadd_ps(
+                _mm512_loadu_ps(a0 + j + 16), _mm512_loadu_ps(x + j + 16), c01);
+        }
+        for (; j < rows; j += 16) {
+            __mmask16 mask = lane_mask(rows - j);
+            c00 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, a0 + j),
+                _mm512_maskz_loadu_ps(mask, x + j), c00);
+        }
+
+        float sum = alpha * _mm512_reduce_add_ps(_mm512_add_ps(c00, c01));
+        y[iy] = update_y(beta, y[iy], sum);
+        iy += inc_y;
+    }
+}
+
+/*
+ * Rank-1 update A += x*t^T. Each block of 64 rows of x is held in four
+ * registers while it is added into every column; the last rows are done
+ * 16 at a time with masks.
+ */
+void
+sp_blas_sger_inc1_avx512(
+    len_t rows,
+    len_t cols,
+    const float * const x,
+    const float * const t,
+    float * const A,
+    len_t lda)
+{
+    len_t r0 = 0;
+
+    for (; r0 + 64 <= rows; r0 += 64) {
+        __m512 x0 = _mm512_loadu_ps(x + r0);
+        __m512 x1 = _mm512_loadu_ps(x + r0 + 16);
+        __m512 x2 = _mm512_loadu_ps(x + r0 + 32);
+        __m512 x3 = _mm512_loadu_ps(x + r0 + 48);
+        for (len_t j = 0; j < cols; j++) {
+            float * a = A + r0 + j * lda;
+            __m512 tj = _mm512_set1_ps(t[j]);
+            _mm512_storeu_ps(a,
+                _mm512_fmadd_ps(x0, tj, _mm512_loadu_ps(a)));
+            _mm512_storeu_ps(a + 16,
+                _mm512_fmadd_ps(x1, tj, _mm512_loadu_ps(a + 16)));
+            _mm512_storeu_ps(a + 32,
+                _mm512_fmadd_ps(x2, tj, _mm512_loadu_ps(a + 32)));
+            _mm512_storeu_ps(a + 48,
+                _mm512_fmadd_ps(x3, tj, _mm512_loadu_ps(a + 48)));
+        }
+    }
+
+    for (; r0 < rows; r0 += 16) {
+        __mmask16 mask = lane_mask(rows - r0);
+        __m512 x0 = _mm512_maskz_loadu_ps(mask, x + r0);
+        for (len_t j = 0; j < cols; j++) {
+            float * a = A + r0 + j * lda;
+            __m512 tj = _mm512_set1_ps(t[j]);
+            _mm512_mask_storeu_ps(a, mask, _mm512_fmadd_ps(x0, tj,
+                _mm512_maskz_loadu_ps(mask, a)));
+        }
+    }
+}
+
+
+#endif
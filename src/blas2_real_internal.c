@@ -0,0 +1,388 @@
+#include "snackpack/snackpack.h"
+#include "snackpack/internal/blas2_real_internal.h"
+
+
+/*
+ * sgemv for A*x with inc_y = 1
+ *
+ * The rows are processed in blocks of SP_SGEMV_ROW_BLOCK. Within a block,
+ * four columns of A are folded into y per sweep, so each block of y is read
+ * and written cols/4 times while it sits in L1, instead of once per column.
+ * beta is applied during the first sweep over each block.
+ */
+void
+sp_blas_sgemv_n_inc1(
+    len_t rows,
+    len_t cols,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    const float * const x,
+    len_t inc_x,
+    float beta,
+    float * const y)
+{
+    len_t ix0 = inc_x < 0 ? (len_t)((1 - cols) * inc_x) : 0;
+
+    for (len_t r0 = 0; r0 < rows; r0 += SP_SGEMV_ROW_BLOCK) {
+        len_t mb = rows - r0 < SP_SGEMV_ROW_BLOCK ?
+            rows - r0 : SP_SGEMV_ROW_BLOCK;
+        float * restrict yb = y + r0;
+        float b = beta;
+        len_t ix = ix0;
+        len_t i = 0;
+
+        for (; i + 4 <= cols; i += 4) {
+            const float * restrict a0 = A + r0 + i * lda;
+            const float * restrict a1 = a0 + lda;
+            const float * restrict a2 = a1 + lda;
+            const float * restrict a3 = a2 + lda;
+            float t0 = alpha * x[ix];
+            float t1 = alpha * x[ix + inc_x];
+            float t2 = alpha * x[ix + 2 * inc_x];
+            float t3 = alpha * x[ix + 3 * inc_x];
+
+            if (b == 0.0f) {
+                for (len_t j = 0; j < mb; j++) {
+                    yb[j] = a0[j] * t0 + a1[j] * t1 + a2[j] * t2 + a3[j] * t3;
+                }
+            } else if (b == 1.0f) {
+                for (len_t j = 0; j < mb; j++) {
+                    yb[j] += a0[j] * t0 + a1[j] * t1 + a2[j] * t2 + a3[j] * t3;
+                }
+            } else {
+                for (len_t j = 0; j < mb; j++) {
+                    yb[j] = b * yb[j] +
+                        (a0[j] * t0 + a1[j] * t1 + a2[j] * t2 + a3[j] * t3);
+                }
+            }
+            b = 1.0f;
+            ix += 4 * inc_x;
+        }
+
+        for (; i < cols; i++) {
+            const float * restrict a0 = A + r0 + i * lda;
+            float t0 = alpha * x[ix];
+
+            if (b == 0.0f) {
+                for (len_t j = 0; j < mb; j++) {
+                    yb[j] = a0[j] * t0;
+                }
+            } else if (b == 1.0f) {
+                for (len_t j = 0; j < mb; j++) {
+                    yb[j] += a0[j] * t0;
+                }
+            } else {
+                for (len_t j = 0; j < mb; j++) {
+                    yb[j] = b * yb[j] + a0[j] * t0;
+                }
+            }
+            b = 1.0f;
+            ix += inc_x;
+        }
+    }
+}
+
+
+/*
+ * Starting value for y_i in the transposed kernels. beta == 0 ignores the
+ * old value entirely, so that NaN in y is cleared as in sscal.
+ */
+static inline float
+beta_y(
+    float beta,
+    float y)
+{
+    return beta == 0.0f ? 0.0f : beta * y;
+}
+
+
+/*
+ * sgemv for A^T*x with inc_x = 1
+ *
+ * Each y_i is a dot product of x with column i of A. Four columns are
+ * handled at once so that every load of x is shared by four dot products,
+ * and each column gets eight partial sums so the additions don't form a
+ * single dependency chain. The fixed-size inner loops are written so that
+ * the compiler can turn them into vector operations.
+ */
+void
+sp_blas_sgemv_t_inc1(
+    len_t rows,
+    len_t cols,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    const float * const x,
+    float beta,
+    float * const y,
+    len_t inc_y)
+{
+    len_t iy = inc_y < 0 ? (len_t)((1 - cols) * inc_y) : 0;
+    len_t i = 0;
+
+    for (; i + 4 <= cols; i += 4) {
+        const float * restrict a0 = A + i * lda;
+        const float * restrict a1 = a0 + lda;
+        const float * restrict a2 = a1 + lda;
+        const float * restrict a3 = a2 + lda;
+        float acc0[8] = {0.0f};
+        float acc1[8] = {0.0f};
+        float acc2[8] = {0.0f};
+        float acc3[8] = {0.0f};
+        float sum0 = 0.0f, sum1 = 0.0f, sum2 = 0.0f, sum3 = 0.0f;
+        len_t j = 0;
+
+        for (; j + 8 <= rows; j += 8) {
+            for (len_t k = 0; k < 8; k++) {
+                acc0[k] += a0[j + k] * x[j + k];
+                acc1[k] += a1[j + k] * x[j + k];
+                acc2[k] += a2[j + k] * x[j + k];
+                acc3[k] += a3[j + k] * x[j + k];
+            }
+        }
+        for (; j < rows; j++) {
+            sum0 += a0[j] * x[j];
+            sum1 += a1[j] * x[j];
+            sum2 += a2[j] * x[j];
+            sum3 += a3[j] * x[j];
+        }
+        for (len_t k = 0; k < 8; k++) {
+            sum0 += acc0[k];
+            sum1 += acc1[k];
+            sum2 += acc2[k];
+            sum3 += acc3[k];
+        }
+
+        y[iy] = beta_y(beta, y[iy]) + alpha * sum0;
+        y[iy + inc_y] = beta_y(beta, y[iy + inc_y]) + alpha * sum1;
+        y[iy + 2 * inc_y] = beta_y(beta, y[iy + 2 * inc_y]) + alpha * sum2;
+        y[iy + 3 * inc_y] = beta_y(beta, y[iy + 3 * inc_y]) + alpha * sum3;
+        iy += 4 * inc_y;
+    }
+
+    for (; i < cols; i++) {
+        const float * restrict a0 = A + i * lda;
+        float acc0[8] = {0.0f};
+        float sum0 = 0.0f;
+        len_t j = 0;
+
+        for (; j + 8 <= rows; j += 8) {
+            for (len_t k = 0; k < 8; k++) {
+                acc0[k] += a0[j + k] * x[j + k];
+            }
+        }
+        for (; j < rows; j++) {
+            sum0 += a0[j] * x[j];
+        }
+        for (len_t k = 0; k < 8; k++) {
+            sum0 += acc0[k];
+        }
+
+        y[iy] = beta_y(beta, y[iy]) + alpha * sum0;
+        iy += inc_y;
+    }
+}
+
+
+/*
+ * sgemv for A*x with a small number of rows and unit increments
+ *
+ * The product is accumulated over the columns in a local array of rows
+ * entries, and y is read and written once at the end.
+ */
+void
+sp_blas_sgemv_n_small(
+    len_t rows,
+    len_t cols,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    const float * const x,
+    float beta,
+    float * const y)
+{
+    float acc[SP_SGEMV_SMALL_MAX_ROWS] = {0.0f};
+
+    for (len_t j = 0; j < cols; j++) {
+        const float * a = A + j * lda;
+        float t = x[j];
+        for (len_t i = 0; i < rows; i++) {
+            acc[i] += a[i] * t;
+        }
+    }
+
+    for (len_t i = 0; i < rows; i++) {
+        y[i] = beta == 0.0f ? alpha * acc[i] : alpha * acc[i] + beta * y[i];
+    }
+}
+
+
+/*
+ * sgemv for A^T*x with a small number of rows and unit increments
+ *
+ * rows is a multiple of 4, so each column is summed in 4 lanes without a
+ * leftover loop. The lanes are added pairwise at the end.
+ */
+void
+sp_blas_sgemv_t_small(
+    len_t rows,
+    len_t cols,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    const float * const x,
+    float beta,
+    float * const y)
+{
+    for (len_t j = 0; j < cols; j++) {
+        const float * a = A + j * lda;
+        float acc[4] = {0.0f};
+        for (len_t i = 0; i < rows; i += 4) {
+            for (len_t k = 0; k < 4; k++) {
+                acc[k] += a[i + k] * x[i + k];
+            }
+        }
+        float s = alpha * ((acc[0] + acc[1]) + (acc[2] + acc[3]));
+        y[j] = beta == 0.0f ? s : s + beta * y[j];
+    }
+}
+
+
+/*
+ * Rank-1 update A += x*t^T
+ *
+ * Rows are taken 32 at a time. The fixed-size loop over those rows lets
+ * the compiler keep the copy of x in vector registers for every column.
+ */
+void
+sp_blas_sger_inc1(
+    len_t rows,
+    len_t cols,
+    const float * const x,
+    const float * const t,
+    float * const A,
+    len_t lda)
+{
+    len_t r0 = 0;
+
+    for (; r0 + 32 <= rows; r0 += 32) {
+        float xr[32];
+        for (len_t i = 0; i < 32; i++) {
+            xr[i] = x[r0 + i];
+        }
+        for (len_t j = 0; j < cols; j++) {
+            float * restrict a = A + r0 + j * lda;
+            float tj = t[j];
+            for (len_t i = 0; i < 32; i++) {
+                a[i] += xr[i] * tj;
+            }
+        }
+    }
+
+    if (r0 < rows) {
+        for (len_t j = 0; j < cols; j++) {
+            float * restrict a = A + j * lda;
+            float tj = t[j];
+            for (len_t i = r0; i < rows; i++) {
+                a[i] += x[i] * tj;
+            }
+        }
+    }
+}
+
+
+/*
+ * Symmetric block update y_r += alpha*M*x_c, y_c += alpha*M^T*x_r
+ *
+ * Four columns are done per sweep over the rows. Every entry of M that is
+ * loaded is used twice: once in the update of y_r, as in sgemv for A*x,
+ * and once in the dot product for y_c, which gets eight partial sums per
+ * column as in the transposed sgemv.
+ */
+void
+sp_blas_ssymv_panel_inc1(
+    len_t rows,
+    len_t cols,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    const float * const x_r,
+    const float * const x_c,
+    float * const y_r,
+    float * const y_c)
+{
+    float * restrict yr = y_r;
+    len_t i = 0;
+
+    for (; i + 4 <= cols; i += 4) {
+        const float * restrict a0 = A + i * lda;
+        const float * restrict a1 = a0 + lda;
+        const float * restrict a2 = a1 + lda;
+        const float * restrict a3 = a2 + lda;
+        float t0 = alpha * x_c[i];
+        float t1 = alpha * x_c[i + 1];
+        float t2 = alpha * x_c[i + 2];
+        float t3 = alpha * x_c[i + 3];
+        float acc0[8] = {0.0f};
+        float acc1[8] = {0.0f};
+        float acc2[8] = {0.0f};
+        float acc3[8] = {0.0f};
+        float sum0 = 0.0f, sum1 = 0.0f, sum2 = 0.0f, sum3 = 0.0f;
+        len_t j = 0;
+
+        for (; j + 8 <= rows; j += 8) {
+            for (len_t k = 0; k < 8; k++) {
+                float x = x_r[j + k];
+                yr[j + k] += a0[j + k] * t0 + a1[j + k] * t1 +
+                    a2[j + k] * t2 + a3[j + k] * t3;
+                acc0[k] += a0[j + k] * x;
+                acc1[k] += a1[j + k] * x;
+                acc2[k] += a2[j + k] * x;
+                acc3[k] += a3[j + k] * x;
+            }
+        }
+        for (; j < rows; j++) {
+            yr[j] += a0[j] * t0 + a1[j] * t1 + a2[j] * t2 + a3[j] * t3;
+            sum0 += a0[j] * x_r[j];
+            sum1 += a1[j] * x_r[j];
+            sum2 += a2[j] * x_r[j];
+            sum3 += a3[j] * x_r[j];
+        }
+        for (len_t k = 0; k < 8; k++) {
+            sum0 += acc0[k];
+            sum1 += acc1[k];
+            sum2 += acc2[k];
+            sum3 += acc3[k];
+        }
+
+        y_c[i] += alpha * sum0;
+        y_c[i + 1] += alpha * sum1;
+        y_c[i + 2] += alpha * sum2;
+        y_c[i + 3] += alpha * sum3;
+    }
+
+    for (; i < cols; i++) {
+        const float * restrict a0 = A + i * lda;
+        float t0 = alpha * x_c[i];
+        float acc0[8] = {0.0f};
+        float sum0 = 0.0f;
+        len_t j = 0;
+
+        for (; j + 8 <= rows; j += 8) {
+            for (len_t k = 0; k < 8; k++) {
+                yr[j + k] += a0[j + k] * t0;
+                acc0[k] += a0[j + k] * x_r[j + k];
+            }
+        }
+        for (; j < rows; j++) {
+            yr[j] += a0[j] * t0;
+            sum0 += a0[j] * x_r[j];
+        }
+        for (len_t k = 0; k < 8; k++) {
+            sum0 += acc0[k];
+        }
+
+        y_c[i] += alpha * sum0;
+    }
+}
@@ -0,0 +1,670 @@
+#include <math.h>
+#include <pthread.h>
+#include <stdlib.h>
+
+#include "snackpack/blas2_real.h"
+#include "snackpack/blas3_real.h"
+#include "snackpack/error.h"
+#include "snackpack/internal/blas2_real_internal.h"
+#include "snackpack/internal/blas3_real_internal.h"
+#include "snackpack/internal/dispatch.h"
+#include "snackpack/internal/threadpool.h"
+#include "snackpack/threads.h"
+
+
+/*
+ * Arguments to sgemm shared by all threads, along with the block of the
+ * product being computed: columns [jc, jc + nc) of C, and steps
+ * [pc, pc + kc) of the inner dimension.
+ */
+typedef struct {
+    bool is_trans_a;
+    bool is_trans_b;
+    len_t m;
+    float alpha;
+    const float * A;
+    len_t lda;
+    const float * B;
+    len_t ldb;
+    float beta;
+    float * C;
+    len_t ldc;
+
+    /* Micro-kernel and its tile size, read once from the dispatch table. */
+    len_t mr;
+    len_t nr;
+    void (*kernel)(
+        len_t k,
+        float alpha,
+        const float * const A,
+        const float * const B,
+        float beta,
+        float * const C,
+        len_t ldc);
+
+    len_t mc;
+    len_t jc;
+    len_t nc;
+    len_t pc;
+    len_t kc;
+    float * Bp;
+} sgemm_args;
+
+
+static inline len_t
+min_len(
+    len_t a,
+    len_t b)
+{
+    return a < b ? a : b;
+}
+
+
+/*
+ * Scratch memory for the packed panels. Each thread keeps its own buffers,
+ * which grow to the largest size it has needed and are freed when the
+ * thread exits, so sgemm neither allocates on every call nor needs a large
+ * stack frame. The panel of B belongs to the thread that calls sgemm and
+ * the block of A to each thread running the macro-kernel. strsm keeps its
+ * inverted diagonal block and copied right-hand sides in the same way.
+ */
+enum {
+    BUFFER_A,
+    BUFFER_B,
+    BUFFER_W,
+    BUFFER_T,
+    NUM_BUFFERS
+};
+
+typedef struct {
+    float * data;
+    size_t size;
+} thread_buffer;
+
+static pthread_key_t buffer_key;
+static pthread_once_t buffer_once = PTHREAD_ONCE_INIT;
+static bool has_buffer_key = false;
+
+
+static void
+free_buffers(
+    void * const p)
+{
+    thread_buffer * buffers = p;
+    for (size_t i = 0; i < NUM_BUFFERS; i++) {
+        free(buffers[i].data);
+    }
+    free(buffers);
+}
+
+
+static void
+create_buffer_key(void)
+{
+    has_buffer_key = pthread_key_create(&buffer_key, free_buffers) == 0;
+}
+
+
+/*
+ * Return buffer `which` of the calling thread with room for at least count
+ * floats, aligned to a cache line, or NULL if it cannot be allocated.
+ */
+static float *
+get_buffer(
+    size_t which,
+    size_t count)
+{
+    pthread_once(&buffer_once, create_buffer_key);
+    if (!has_buffer_key) {
+        return NULL;
+    }
+
+    thread_buffer * buffers = pthread_getspecific(buffer_key);
+    if (buffers == NULL) {
+        buffers = calloc(NUM_BUFFERS, sizeof(thread_buffer));
+        if (buffers == NULL) {
+            return NULL;
+        }
+        if (pthread_setspecific(buffer_key, buffers) != 0) {
+            free(buffers);
+            return NULL;
+        }
+    }
+
+    thread_buffer * b = &buffers[which];
+    if (b->size < count) {
+        size_t bytes = (count * sizeof(float) + 63) / 64 * 64;
+        float * data = aligned_alloc(64, bytes);
+        if (data == NULL) {
+            return NULL;
+        }
+        free(b->data);
+        b->data = data;
+        b->size = bytes / sizeof(float);
+    }
+    return b->data;
+}
+
+
+/*
+ * Fallback for when a packing buffer cannot be allocated: rows [i0, i0 +
+ * mb) and columns [j0, j0 + nb) of C, over steps [p0, p0 + kb) of the
+ * inner dimension, one column of C at a time with sgemv.
+ */
+static void
+sgemm_by_columns(
+    const sgemm_args * const p,
+    len_t i0,
+    len_t mb,
+    len_t j0,
+    len_t nb,
+    len_t p0,
+    len_t kb,
+    float beta)
+{
+    for (len_t j = j0; j < j0 + nb; j++) {
+        const float * x = p->is_trans_b ?
+            p->B + j + p0 * p->ldb : p->B + p0 + j * p->ldb;
+        len_t inc_x = p->is_trans_b ? p->ldb : 1;
+        float * y = p->C + i0 + j * p->ldc;
+
+        if (p->is_trans_a) {
+            sp_blas_sgemv_t_incxy(kb, mb, p->alpha, p->A + p0 + i0 * p->lda,
+                p->lda, x, inc_x, beta, y, 1);
+        } else {
+            sp_blas_sgemv_n_incxy(mb, kb, p->alpha, p->A + i0 + p0 * p->lda,
+                p->lda, x, inc_x, beta, y, 1);
+        }
+    }
+}
+
+
+/*
+ * Pack a kc x nc panel of op(B) into slivers of nr columns. Within a
+ * sliver, row p holds nr consecutive entries; columns past the edge of B
+ * are zero. Each task packs a range of slivers.
+ */
+static void
+pack_b_task(
+    void * arg,
+    len_t begin,
+    len_t end)
+{
+    const sgemm_args * p = arg;
+    len_t nr = p->nr;
+
+    for (len_t s = begin; s < end; s++) {
+        float * dst = p->Bp + s * p->kc * nr;
+        len_t j0 = s * nr;
+        for (len_t c = 0; c < nr; c++) {
+            len_t j = p->jc + j0 + c;
+            if (j0 + c >= p->nc) {
+                for (len_t l = 0; l < p->kc; l++) {
+                    dst[l * nr + c] = 0.0f;
+                }
+            } else if (p->is_trans_b) {
+                const float * b = p->B + j + p->pc * p->ldb;
+                for (len_t l = 0; l < p->kc; l++) {
+                    dst[l * nr + c] = b[l * p->ldb];
+                }
+            } else {
+                const float * b = p->B + p->pc + j * p->ldb;
+                for (len_t l = 0; l < p->kc; l++) {
+                    dst[l * nr + c] = b[l];
+                }
+            }
+        }
+    }
+}
+
+
+/*
+ * Pack an mb x kc block of op(A), starting at row i0, into slivers of mr
+ * rows. Within a sliver, column l holds mr consecutive entries; rows past
+ * the edge of A are zero.
+ */
+static void
+pack_a(
+    const sgemm_args * const p,
+    len_t i0,
+    len_t mb,
+    float * const Ap)
+{
+    len_t mr = p->mr;
+
+    for (len_t r0 = 0; r0 < mb; r0 += mr) {
+        float * dst = Ap + r0 * p->kc;
+        len_t rows = min_len(mr, mb - r0);
+        for (len_t l = 0; l < p->kc; l++) {
+            len_t i = i0 + r0;
+            if (p->is_trans_a) {
+                const float * a = p->A + (p->pc + l) + i * p->lda;
+                for (len_t r = 0; r < rows; r++) {
+                    dst[r] = a[r * p->lda];
+                }
+            } else {
+                const float * a = p->A + i + (p->pc + l) * p->lda;
+                for (len_t r = 0; r < rows; r++) {
+                    dst[r] = a[r];
+                }
+            }
+            for (len_t r = rows; r < mr; r++) {
+                dst[r] = 0.0f;
+            }
+            dst += mr;
+        }
+    }
+}
+
+
+/*
+ * Macro-kernel: each task takes a range of mc-row blocks of C, packs the
+ * matching block of A into its thread's buffer and sweeps the micro-kernel
+ * over the block against the shared panel of B. Tiles cut off by the edges
+ * of C are computed into a scratch tile and merged with the same rounding
+ * as the kernel, so a result does not depend on where the tiles fall.
+ */
+static void
+macro_task(
+    void * arg,
+    len_t begin,
+    len_t end)
+{
+    const sgemm_args * p = arg;
+    float * Ap = get_buffer(BUFFER_A, (size_t)p->mc * (size_t)p->kc);
+    float tile[SP_SGEMM_MAX_MR * SP_SGEMM_MAX_NR];
+    len_t mr = p->mr;
+    len_t nr = p->nr;
+
+    for (len_t blk = begin; blk < end; blk++) {
+        len_t i0 = blk * p->mc;
+        len_t mb = min_len(p->mc, p->m - i0);
+        if (Ap == NULL) {
+            sgemm_by_columns(p, i0, mb, p->jc, p->nc, p->pc, p->kc, p->beta);
+            continue;
+        }
+        pack_a(p, i0, mb, Ap);
+
+        for (len_t j0 = 0; j0 < p->nc; j0 += nr) {
+            len_t cols = min_len(nr, p->nc - j0);
+            const float * b = p->Bp + j0 * p->kc;
+            float * c = p->C + i0 + (p->jc + j0) * p->ldc;
+
+            for (len_t r0 = 0; r0 < mb; r0 += mr) {
+                len_t rows = min_len(mr, mb - r0);
+                const float * a = Ap + r0 * p->kc;
+
+                if (rows == mr && cols == nr) {
+                    p->kernel(p->kc, p->alpha, a, b, p->beta, c + r0,
+                        p->ldc);
+                    continue;
+                }
+
+                p->kernel(p->kc, p->alpha, a, b, 0.0f, tile, mr);
+                for (len_t j = 0; j < cols; j++) {
+                    float * cj = c + r0 + j * p->ldc;
+                    for (len_t i = 0; i < rows; i++) {
+                        float s = tile[i + j * mr];
+                        cj[i] = p->beta == 0.0f ?
+                            s : fmaf(p->beta, cj[i], s);
+                    }
+                }
+            }
+        }
+    }
+}
+
+
+/*
+ * sgemm after argument checks. Also used for the updates of the blocked
+ * triangular solve, which may pass k = 0.
+ */
+static void
+sgemm(
+    bool is_trans_a,
+    bool is_trans_b,
+    len_t m,
+    len_t n,
+    len_t k,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    const float * const B,
+    len_t ldb,
+    float beta,
+    float * const C,
+    len_t ldc)
+{
+    /* An empty inner product leaves beta * C. */
+    if (k == 0) {
+        alpha = 0.0f;
+    }
+
+    /* If alpha is 0, all that's left is beta * C. */
+    if (alpha == 0.0f) {
+        if (beta != 1.0f) {
+            for (len_t j = 0; j < n; j++) {
+                sp_kernels.sscal_inc1(m, beta, C + j * ldc);
+            }
+        }
+        return;
+    }
+
+    sgemm_args args = {
+        .is_trans_a = is_trans_a,
+        .is_trans_b = is_trans_b,
+        .m = m,
+        .alpha = alpha,
+        .A = A,
+        .lda = lda,
+        .B = B,
+        .ldb = ldb,
+        .C = C,
+        .ldc = ldc,
+        .mr = sp_kernels.sgemm_mr,
+        .nr = sp_kernels.sgemm_nr,
+        .kernel = sp_kernels.sgemm_kernel,
+        .mc = SP_SGEMM_MC,
+    };
+
+    /* Split the rows so that every thread gets a block of A to pack. */
+    bool is_threaded = (int64_t)m * n * k >= SP_SGEMM_PARALLEL_MIN;
+    if (is_threaded) {
+        len_t num_threads = sp_get_num_threads();
+        len_t rows = (m + num_threads - 1) / num_threads;
+        rows = (rows + args.mr - 1) / args.mr * args.mr;
+        args.mc = min_len(args.mc, rows);
+    }
+    len_t num_blocks = (m + args.mc - 1) / args.mc;
+
+    /* The panel of B is at most kc x nc, rounded up to whole slivers. */
+    len_t kc = min_len(SP_SGEMM_KC, k);
+    len_t nc = (min_len(SP_SGEMM_NC, n) + args.nr - 1) / args.nr * args.nr;
+    args.Bp = get_buffer(BUFFER_B, (size_t)kc * (size_t)nc);
+    if (args.Bp == NULL) {
+        sgemm_by_columns(&args, 0, m, 0, n, 0, k, beta);
+        return;
+    }
+
+    for (len_t jc = 0; jc < n; jc += SP_SGEMM_NC) {
+        args.jc = jc;
+        args.nc = min_len(SP_SGEMM_NC, n - jc);
+        len_t num_slivers = (args.nc + args.nr - 1) / args.nr;
+
+        /* beta applies on the first pass over k only. */
+        for (len_t pc = 0; pc < k; pc += SP_SGEMM_KC) {
+            args.pc = pc;
+            args.kc = min_len(SP_SGEMM_KC, k - pc);
+            args.beta = pc == 0 ? beta : 1.0f;
+
+            sp_parallel_for(num_slivers, is_threaded ? 4 : num_slivers,
+                pack_b_task, &args);
+            sp_parallel_for(num_blocks, is_threaded ? 1 : num_blocks,
+                macro_task, &args);
+        }
+    }
+}
+
+
+/**
+ * Compute a general matrix-matrix product.
+ *
+ * Performs the operation
+ *
+ *      C = alpha*op(A)*op(B) + beta*C
+ *
+ * where op(X) is X or X^T, op(A) is m x k, op(B) is k x n and C is m x n.
+ *
+ * \param[in] is_trans_a    True to take the transpose of A
+ * \param[in] is_trans_b    True to take the transpose of B
+ * \param[in] m             Number of rows of op(A) and C
+ * \param[in] n             Number of columns of op(B) and C
+ * \param[in] k             Number of columns of op(A) and rows of op(B)
+ * \param[in] alpha         Scalar alpha
+ * \param[in] A             Matrix A
+ * \param[in] lda           Leading dimension of A - must be at least
+ *                          max(1, m), or max(1, k) if is_trans_a
+ * \param[in] B             Matrix B
+ * \param[in] ldb           Leading dimension of B - must be at least
+ *                          max(1, k), or max(1, n) if is_trans_b
+ * \param[in] beta          Scalar beta
+ * \param[in,out] C         Matrix C, stores result
+ * \param[in] ldc           Leading dimension of C - must be at least
+ *                          max(1, m)
+ *
+ * The product is blocked for the caches: panels of op(B) and op(A) are
+ * packed into contiguous slivers and multiplied by a register micro-kernel
+ * from the dispatch table. Products with at least SP_SGEMM_PARALLEL_MIN
+ * multiply-adds split the rows of C across the thread pool. Every entry of
+ * C is summed in the same order however the rows are split, so the result
+ * does not depend on the number of threads.
+ */
+void
+sp_blas_sgemm(
+    bool is_trans_a,
+    bool is_trans_b,
+    len_t m,
+    len_t n,
+    len_t k,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    const float * const B,
+    len_t ldb,
+    float beta,
+    float * const C,
+    len_t ldc)
+{
+    SP_ASSERT_VALID_DIM(m);
+    SP_ASSERT_VALID_DIM(n);
+    SP_ASSERT_VALID_DIM(k);
+    SP_ASSERT_VALID_LDA(lda, is_trans_a ? k : m);
+    SP_ASSERT_VALID_LDA(ldb, is_trans_b ? n : k);
+    SP_ASSERT_VALID_LDA(ldc, m);
+
+    sgemm(is_trans_a, is_trans_b, m, n, k, alpha, A, lda, B, ldb, beta, C,
+        ldc);
+
+fail:
+    return;
+}
+
+
+/* Pointer to entry (r0, c0) of op(A). */
+static inline const float *
+op_entry(
+    const float * const A,
+    len_t lda,
+    bool is_trans,
+    len_t r0,
+    len_t c0)
+{
+    return is_trans ? A + c0 + r0 * lda : A + r0 + c0 * lda;
+}
+
+
+/*
+ * Invert the nb x nb triangle T into W (leading dimension nb), with zeros
+ * in the other triangle. Column j of the inverse is the inverse of the
+ * columns already done times column j of T, scaled by -1/T_jj; these are
+ * the only divisions of the solve.
+ */
+static void
+invert_triangle(
+    bool is_upper,
+    bool is_unit,
+    len_t nb,
+    const float * const T,
+    len_t ldt,
+    float * const W)
+{
+    for (len_t i = 0; i < nb * nb; i++) {
+        W[i] = 0.0f;
+    }
+
+    if (is_upper) {
+        for (len_t j = 0; j < nb; j++) {
+            float * w = W + j * nb;
+            const float * t = T + j * ldt;
+            w[j] = is_unit ? 1.0f : 1.0f / t[j];
+            for (len_t i = 0; i < j; i++) {
+                float s = 0.0f;
+                for (len_t l = i; l < j; l++) {
+                    s += W[i + l * nb] * t[l];
+                }
+                w[i] = -s * w[j];
+            }
+        }
+    } else {
+        for (len_t j = nb - 1; j >= 0; j--) {
+            float * w = W + j * nb;
+            const float * t = T + j * ldt;
+            w[j] = is_unit ? 1.0f : 1.0f / t[j];
+            for (len_t i = j + 1; i < nb; i++) {
+                float s = 0.0f;
+                for (len_t l = j + 1; l <= i; l++) {
+                    s += W[i + l * nb] * t[l];
+                }
+                w[i] = -s * w[j];
+            }
+        }
+    }
+}
+
+
+/**
+ * Solve a triangular system with many right-hand sides.
+ *
+ * Solves one of
+ *
+ *      op(A)*X = alpha*B
+ * or
+ *      X*op(A) = alpha*B
+ *
+ * for X, where A is triangular and op(A) is A or A^T. X overwrites B.
+ *
+ * \param[in] is_left   True to solve op(A)*X = alpha*B, false for
+ *                      X*op(A) = alpha*B
+ * \param[in] is_upper  True if A is upper triangular, false otherwise
+ * \param[in] is_trans  True to use the transpose of A
+ * \param[in] is_unit   True if A is unit-triangular
+ * \param[in] m         Number of rows of B
+ * \param[in] n         Number of columns of B
+ * \param[in] alpha     Scalar alpha
+ * \param[in] A         Triangular matrix A, m x m if is_left, else n x n
+ * \param[in] lda       Leading dimension of A
+ * \param[in,out] B     On enter, right-hand sides. On exit, solution X.
+ * \param[in] ldb       Leading dimension of B - must be at least
+ *                      max(1, m)
+ *
+ * A is cut into diagonal blocks of SP_STRSM_BLOCK. Each block of X first
+ * has the contribution of the blocks already solved subtracted with one
+ * sgemm, and is then multiplied by the inverse of its diagonal block, also
+ * with sgemm. Apart from inverting the diagonal blocks, all of the work is
+ * done by the sgemm micro-kernels and threads.
+ */
+void
+sp_blas_strsm(
+    bool is_left,
+    bool is_upper,
+    bool is_trans,
+    bool is_unit,
+    len_t m,
+    len_t n,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    float * const B,
+    len_t ldb)
+{
+    SP_ASSERT_VALID_DIM(m);
+    SP_ASSERT_VALID_DIM(n);
+    SP_ASSERT_VALID_LDA(lda, is_left ? m : n);
+    SP_ASSERT_VALID_LDA(ldb, m);
+
+    if (alpha != 1.0f) {
+        for (len_t j = 0; j < n; j++) {
+            sp_kernels.sscal_inc1(m, alpha, B + j * ldb);
+        }
+        if (alpha == 0.0f) {
+            return;
+        }
+    }
+
+    /*
+     * Order of A, and whether op(A) is upper triangular. An upper op(A)
+     * couples each block of X to the blocks after it on the left, and to
+     * the blocks before it on the right.
+     */
+    len_t na = is_left ? m : n;
+    bool is_op_upper = is_upper != is_trans;
+    bool is_forward = is_left != is_op_upper;
+    len_t num_blocks = (na + SP_STRSM_BLOCK - 1) / SP_STRSM_BLOCK;
+    float * W = get_buffer(BUFFER_W, SP_STRSM_BLOCK * SP_STRSM_BLOCK);
+    float * T = get_buffer(BUFFER_T, SP_STRSM_BLOCK * SP_STRSM_RHS);
+
+    /* Without the buffers, solve one column (or row) of X at a time. */
+    if (W == NULL || T == NULL) {
+        if (is_left) {
+            for (len_t j = 0; j < n; j++) {
+                sp_blas_strsv(is_upper, is_trans, is_unit, m, A, lda,
+                    B + j * ldb, 1);
+            }
+        } else {
+            for (len_t i = 0; i < m; i++) {
+                sp_blas_strsv(is_upper, !is_trans, is_unit, n, A, lda,
+                    B + i, ldb);
+            }
+        }
+        return;
+    }
+
+    for (len_t b = 0; b < num_blocks; b++) {
+        len_t i0 = (is_forward ? b : num_blocks - 1 - b) * SP_STRSM_BLOCK;
+        len_t i1 = i0 + SP_STRSM_BLOCK < na ? i0 + SP_STRSM_BLOCK : na;
+        len_t nb = i1 - i0;
+
+        /* Blocks of X already solved: [s0, s1). */
+        len_t s0 = is_forward ? 0 : i1;
+        len_t s1 = is_forward ? i0 : na;
+
+        invert_triangle(is_upper, is_unit, nb, A + i0 + i0 * lda, lda, W);
+
+        if (is_left) {
+            /* B_i -= op(A)_(i, s) * X_s, then X_i = inv(op(A)_ii) * B_i */
+            sgemm(is_trans, false, nb, n, s1 - s0, -1.0f,
+                op_entry(A, lda, is_trans, i0, s0), lda, B + s0, ldb,
+                1.0f, B + i0, ldb);
+
+            for (len_t c0 = 0; c0 < n; c0 += SP_STRSM_RHS) {
+                len_t cols = min_len(SP_STRSM_RHS, n - c0);
+                for (len_t j = 0; j < cols; j++) {
+                    for (len_t i = 0; i < nb; i++) {
+                        T[i + j * nb] = B[i0 + i + (c0 + j) * ldb];
+                    }
+                }
+                sgemm(is_trans, false, nb, cols, nb, 1.0f, W, nb, T, nb,
+                    0.0f, B + i0 + c0 * ldb, ldb);
+            }
+        } else {
+            /* B_i -= X_s * op(A)_(s, i), then X_i = B_i * inv(op(A)_ii) */
+            sgemm(false, is_trans, m, nb, s1 - s0, -1.0f,
+                B + s0 * ldb, ldb, op_entry(A, lda, is_trans, s0, i0), lda,
+                1.0f, B + i0 * ldb, ldb);
+
+            for (len_t r0 = 0; r0 < m; r0 += SP_STRSM_RHS) {
+                len_t rows = min_len(SP_STRSM_RHS, m - r0);
+                for (len_t j = 0; j < nb; j++) {
+                    for (len_t i = 0; i < rows; i++) {
+                        T[i + j * rows] = B[r0 + i + (i0 + j) * ldb];
+                    }
+                }
+                sgemm(false, is_trans, rows, nb, nb, 1.0f, T, rows, W, nb,
+                    0.0f, B + r0 + i0 * ldb, ldb);
+            }
+        }
+    }
+
+fail:
+    return;
+}
@@ -0,0 +1,97 @@
+/*
+ * AVX2 + FMA sgemm micro-kernel. This file is compiled with -mavx2 -mfma.
+ */
+#if defined(__AVX2__) && defined(__FMA__)
+
+#include <immintrin.h>
+
+#include "snackpack/snackpack.h"
+#include "snackpack/internal/blas3_real_simd.h"
+
+
+/* alpha*c + beta*C for one column of the tile. */
+static inline void
+store_column(
+    float * const C,
+    __m256 c0,
+    __m256 c1,
+    __m256 va,
+    float beta)
+{
+    __m256 s0 = _mm256_mul_ps(va, c0);
+    __m256 s1 = _mm256_mul_ps(va, c1);
+    if (beta != 0.0f) {
+        __m256 vb = _mm256_set1_ps(beta);
+        s0 = _mm256_fmadd_ps(vb, _mm256_loadu_ps(C), s0);
+        s1 = _mm256_fmadd_ps(vb, _mm256_loadu_ps(C + 8), s1);
+    }
+    _mm256_storeu_ps(C, s0);
+    _mm256_storeu_ps(C + 8, s1);
+}
+
+
+/*
+ * sgemm micro-kernel for a 16 x 6 tile
+ *
+ * Each step of k loads one packed column of A into two vectors and
+ * broadcasts the six packed entries of B against it, for 12 independent
+ * FMA chains. The accumulators are separate variables rather than an
+ * array, which some compilers would keep in memory across iterations.
+ */
+void
+sp_blas_sgemm_kernel_avx2(
+    len_t k,
+    float alpha,
+    const float * const A,
+    const float * const B,
+    float beta,
+    float * const C,
+    len_t ldc)
+{
+    __m256 c00 = _mm256_setzero_ps(), c01 = _mm256_setzero_ps();
+    __m256 c10 = _mm256_setzero_ps(), c11 = _mm256_setzero_ps();
+    __m256 c20 = _mm256_setzero_ps(), c21 = _mm256_setzero_ps();
+    __m256 c30 = _mm256_setzero_ps(), c31 = _mm256_setzero_ps();
+    __m256 c40 = _mm256_setzero_ps(), c41 = _mm256_setzero_ps();
+    __m256 c50 = _mm256_setzero_ps(), c51 = _mm256_setzero_ps();
+
+    const float * a = A;
+    const float * b = B;
+    for (len_t p = 0; p < k; p++) {
+        __m256 a0 = _mm256_loadu_ps(a);
+        __m256 a1 = _mm256_loadu_ps(a + 8);
+        __m256 bj;
+
+        bj = _mm256_broadcast_ss(b);
+        c00 = _mm256_fmadd_ps(a0, bj, c00);
+        c01 = _mm256_fmadd_ps(a1, bj, c01);
+        bj = _mm256_broadcast_ss(b + 1);
+        c10 = _mm256_fmadd_ps(a0, bj, c10);
+        c11 = _mm256_fmadd_ps(a1, bj, c11);
+        bj = _mm256_broadcast_ss(b + 2);
+        c20 = _mm256_fmadd_ps(a0, bj, c20);
+        c21 = _mm256_fmadd_ps(a1, bj, c21);
+        bj = _mm256_broadcast_ss(b + 3);
+        c30 = _mm256_fmadd_ps(a0, bj, c30);
+        c31 = _mm256_fmadd_ps(a1, bj, c31);
+        bj = _mm256_broadcast_ss(b + 4);
+        c40 = _mm256_fmadd_ps(a0, bj, c40);
+        c41 = _mm256_fmadd_ps(a1, bj, c41);
+        bj = _mm256_broadcast_ss(b + 5);
+        c50 = _mm256_fmadd_ps(a0, bj, c50);
+        c51 = _mm256_fmadd_ps(a1, bj, c51);
+
+        a += SP_SGEMM_MR_AVX2;
+        b += SP_SGEMM_NR_AVX2;
+    }
+
+    __m256 va = _mm256_set1_ps(alpha);
+    store_column(C, c00, c01, va, beta);
+    store_column(C + ldc, c10, c11, va, beta);
+    store_column(C + 2 * ldc, c20, c21, va, beta);
+    store_column(C + 3 * ldc, c30, c31, va, beta);
+    store_column(C + 4 * ldc, c40, c41, va, beta);
+    store_column(C + 5 * ldc, c50, c51, va, beta);
+}
+
+#endif
@@ -0,0 +1,66 @@
+/*
+ * AVX-512F sgemm micro-kernel. This file is compiled with -mavx512f -mfma.
+ */
+#if defined(__AVX512F__) && defined(__FMA__)
+
+#include <immintrin.h>
+
+#include "snackpack/snackpack.h"
+#include "snackpack/internal/blas3_real_simd.h"
+
+
+/*
+ * sgemm micro-kernel for a 32 x 12 tile
+ *
+ * As the AVX2 kernel, with 24 accumulators out of the 32 registers. The
+ * next column of A is prefetched a few steps ahead, since at this tile size
+ * the loads of A are the only stream the hardware prefetcher must follow
+ * through the packed block.
+ */
+void
+sp_blas_sgemm_kernel_avx512(
+    len_t k,
+    float alpha,
+    const float * const A,
+    const float * const B,
+    float beta,
+    float * const C,
+    len_t ldc)
+{
+    __m512 c[SP_SGEMM_NR_AVX512][2];
+    for (len_t j = 0; j < SP_SGEMM_NR_AVX512; j++) {
+        c[j][0] = _mm512_setzero_ps();
+        c[j][1] = _mm512_setzero_ps();
+    }
+
+    const float * a = A;
+    const float * b = B;
+    for (len_t p = 0; p < k; p++) {
+        _mm_prefetch((const char *)(a + 8 * SP_SGEMM_MR_AVX512), _MM_HINT_T0);
+        __m512 a0 = _mm512_loadu_ps(a);
+        __m512 a1 = _mm512_loadu_ps(a + 16);
+        for (len_t j = 0; j < SP_SGEMM_NR_AVX512; j++) {
+            __m512 bj = _mm512_set1_ps(b[j]);
+            c[j][0] = _mm512_fmadd_ps(a0, bj, c[j][0]);
+            c[j][1] = _mm512_fmadd_ps(a1, bj, c[j][1]);
+        }
+        a += SP_SGEMM_MR_AVX512;
+        b += SP_SGEMM_NR_AVX512;
+    }
+
+    __m512 va = _mm512_set1_ps(alpha);
+    __m512 vb = _mm512_set1_ps(beta);
+    for (len_t j = 0; j < SP_SGEMM_NR_AVX512; j++) {
+        float * cj = C + j * ldc;
+        __m512 s0 = _mm512_mul_ps(va, c[j][0]);
+        __m512 s1 = _mm512_mul_ps(va, c[j][1]);
+        if (beta != 0.0f) {
+            s0 = _mm512_fmadd_ps(vb, _mm512_loadu_ps(cj), s0);
+            s1 = _mm512_fmadd_ps(vb, _mm512_loadu_ps(cj + 16), s1);
+        }
+        _mm512_storeu_ps(cj, s0);
+        _mm512_storeu_ps(cj + 16, s1);
+    }
+}
+
+#endif
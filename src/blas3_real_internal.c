@@ -0,0 +1,43 @@
+#include <math.h>
+
+#include "snackpack/snackpack.h"
+#include "snackpack/internal/blas3_real_internal.h"
+
+
+/*
+ * sgemm micro-kernel for an SP_SGEMM_MR x SP_SGEMM_NR tile
+ *
+ * The tile is accumulated in a local array, one rank-1 update per step of
+ * k. The fixed-size inner loops are written so that the compiler can turn
+ * them into vector operations.
+ */
+void
+sp_blas_sgemm_kernel(
+    len_t k,
+    float alpha,
+    const float * const A,
+    const float * const B,
+    float beta,
+    float * const C,
+    len_t ldc)
+{
+    float acc[SP_SGEMM_NR][SP_SGEMM_MR] = {{0.0f}};
+
+    for (len_t p = 0; p < k; p++) {
+        const float * a = A + p * SP_SGEMM_MR;
+        const float * b = B + p * SP_SGEMM_NR;
+        for (len_t j = 0; j < SP_SGEMM_NR; j++) {
+            for (len_t i = 0; i < SP_SGEMM_MR; i++) {
+                acc[j][i] += a[i] * b[j];
+            }
+        }
+    }
+
+    for (len_t j = 0; j < SP_SGEMM_NR; j++) {
+        float * c = C + j * ldc;
+        for (len_t i = 0; i < SP_SGEMM_MR; i++) {
+            float s = alpha * acc[j][i];
+            c[i] = beta == 0.0f ? s : fmaf(beta, c[i], s);
+        }
+    }
+}
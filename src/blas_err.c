@@ -0,0 +1,837 @@
+#include <stdbool.h>
+
+#include "snackpack/batch_real.h"
+#include "snackpack/blas1_real.h"
+#include "snackpack/blas2_real.h"
+#include "snackpack/blas3_real.h"
+#include "snackpack/blas_err.h"
+#include "snackpack/error.h"
+
+
+/*
+ * Every wrapper sets the thread-local error aside, makes the call and reads
+ * the error back. The checks all run on the calling thread before any work
+ * is handed to the thread pool, so the error of a threaded call lands in
+ * the caller's slot.
+ */
+
+
+/* Clear the thread-local error for a call, returning the pending one. */
+static SP_ERROR
+begin_call(void)
+{
+    SP_ERROR pending = sp_get_last_error();
+    sp_clear_last_error();
+    return pending;
+}
+
+
+/*
+ * Return the error of the call. As for the plain routines, the slot is only
+ * written on failure, so the pending error is put back if the call passed.
+ */
+static SP_ERROR
+end_call(
+    SP_ERROR pending)
+{
+    SP_ERROR error = sp_get_last_error();
+    if (error == SP_NO_ERROR) {
+        sp_set_last_error(pending);
+    }
+    return error;
+}
+
+
+/** Same as sp_blas_sasum, returning SP_NO_ERROR or the failed check. */
+SP_ERROR
+sp_blas_sasum_err(
+    len_t n,
+    const float * const x,
+    len_t inc_x,
+    float * const result)
+{
+    SP_ERROR pending = begin_call();
+    *result = sp_blas_sasum(n, x, inc_x);
+    return end_call(pending);
+}
+
+
+/** Same as sp_blas_saxpy, returning SP_NO_ERROR or the failed check. */
+SP_ERROR
+sp_blas_saxpy_err(
+    len_t n,
+    float alpha,
+    const float * const x,
+    len_t inc_x,
+    float * const y,
+    len_t inc_y)
+{
+    SP_ERROR pending = begin_call();
+    sp_blas_saxpy(n, alpha, x, inc_x, y, inc_y);
+    return end_call(pending);
+}
+
+
+/** Same as sp_blas_sdot, returning SP_NO_ERROR or the failed check. */
+SP_ERROR
+sp_blas_sdot_err(
+    len_t n,
+    const float * const x,
+    len_t inc_x,
+    const float * const y,
+    len_t inc_y,
+    float * const result)
+{
+    SP_ERROR pending = begin_call();
+    *result = sp_blas_sdot(n, x, inc_x, y, inc_y);
+    return end_call(pending);
+}
+
+
+/** Same as sp_blas_srot, returning SP_NO_ERROR or the failed check. */
+SP_ERROR
+sp_blas_srot_err(
+    len_t n,
+    float * const x,
+    len_t inc_x,
+    float * const y,
+    len_t inc_y,
+    float c,
+    float s)
+{
+    SP_ERROR pending = begin_call();
+    sp_blas_srot(n, x, inc_x, y, inc_y, c, s);
+    return end_call(pending);
+}
+
+
+/** Same as sp_blas_sswap, returning SP_NO_ERROR or the failed check. */
+SP_ERROR
+sp_blas_sswap_err(
+    len_t n,
+    float * const x,
+    len_t inc_x,
+    float * const y,
+    len_t inc_y)
+{
+    SP_ERROR pending = begin_call();
+    sp_blas_sswap(n, x, inc_x, y, inc_y);
+    return end_call(pending);
+}
+
+
+/** Same as sp_blas_scopy, returning SP_NO_ERROR or the failed check. */
+SP_ERROR
+sp_blas_scopy_err(
+    len_t n,
+    const float * const x,
+    len_t inc_x,
+    float * const y,
+    len_t inc_y)
+{
+    SP_ERROR pending = begin_call();
+    sp_blas_scopy(n, x, inc_x, y, inc_y);
+    return end_call(pending);
+}
+
+
+/** Same as sp_blas_snrm2, returning SP_NO_ERROR or the failed check. */
+SP_ERROR
+sp_blas_snrm2_err(
+    len_t n,
+    const float * const x,
+    len_t inc_x,
+    float * const result)
+{
+    SP_ERROR pending = begin_call();
+    *result = sp_blas_snrm2(n, x, inc_x);
+    return end_call(pending);
+}
+
+
+/** Same as sp_blas_sscal, returning SP_NO_ERROR or the failed check. */
+SP_ERROR
+sp_blas_sscal_err(
+    len_t n,
+    float alpha,
+    float * const x,
+    len_t inc_x)
+{
+    SP_ERROR pending = begin_call();
+    sp_blas_sscal(n, alpha, x, inc_x);
+    return end_call(pending);
+}
+
+
+/** Same as sp_blas_isamax, returning SP_NO_ERROR or the failed check. */
+SP_ERROR
+sp_blas_isamax_err(
+    len_t n,
+    const float * const x,
+    len_t inc_x,
+    len_t * const index)
+{
+    SP_ERROR pending = begin_call();
+    *index = sp_blas_isamax(n, x, inc_x);
+    return end_call(pending);
+}
+
+
+/** Same as sp_blas_isamin, returning SP_NO_ERROR or the failed check. */
+SP_ERROR
+sp_blas_isamin_err(
+    len_t n,
+    const float * const x,
+    len_t inc_x,
+    len_t * const index)
+{
+    SP_ERROR pending = begin_call();
+    *index = sp_blas_isamin(n, x, inc_x);
+    return end_call(pending);
+}
+
+
+/**
+ * Same as sp_blas_isamax_value, returning SP_NO_ERROR or the failed check.
+ */
+SP_ERROR
+sp_blas_isamax_value_err(
+    len_t n,
+    const float * const x,
+    len_t inc_x,
+    float * const value,
+    len_t * const index)
+{
+    SP_ERROR pending = begin_call();
+    *index = sp_blas_isamax_value(n, x, inc_x, value);
+    return end_call(pending);
+}
+
+
+/**
+ * Same as sp_blas_isamin_value, returning SP_NO_ERROR or the failed check.
+ */
+SP_ERROR
+sp_blas_isamin_value_err(
+    len_t n,
+    const float * const x,
+    len_t inc_x,
+    float * const value,
+    len_t * const index)
+{
+    SP_ERROR pending = begin_call();
+    *index = sp_blas_isamin_value(n, x, inc_x, value);
+    return end_call(pending);
+}
+
+
+/** Same as sp_blas_sdsdot, returning SP_NO_ERROR or the failed check. */
+SP_ERROR
+sp_blas_sdsdot_err(
+    len_t n,
+    float sb,
+    const float * const x,
+    len_t inc_x,
+    const float * const y,
+    len_t inc_y,
+    float * const result)
+{
+    SP_ERROR pending = begin_call();
+    *result = sp_blas_sdsdot(n, sb, x, inc_x, y, inc_y);
+    return end_call(pending);
+}
+
+
+/** Same as sp_blas_saxpy_dot, returning SP_NO_ERROR or the failed check. */
+SP_ERROR
+sp_blas_saxpy_dot_err(
+    len_t n,
+    float alpha,
+    const float * const x,
+    len_t inc_x,
+    float * const y,
+    len_t inc_y,
+    const float * const z,
+    len_t inc_z,
+    float * const result)
+{
+    SP_ERROR pending = begin_call();
+    *result = sp_blas_saxpy_dot(n, alpha, x, inc_x, y, inc_y, z, inc_z);
+    return end_call(pending);
+}
+
+
+/** Same as sp_blas_snrm2_scal, returning SP_NO_ERROR or the failed check. */
+SP_ERROR
+sp_blas_snrm2_scal_err(
+    len_t n,
+    float * const x,
+    len_t inc_x,
+    float * const result)
+{
+    SP_ERROR pending = begin_call();
+    *result = sp_blas_snrm2_scal(n, x, inc_x);
+    return end_call(pending);
+}
+
+
+/** Same as sp_blas_scopy_scal, returning SP_NO_ERROR or the failed check. */
+SP_ERROR
+sp_blas_scopy_scal_err(
+    len_t n,
+    float alpha,
+    const float * const x,
+    len_t inc_x,
+    float * const y,
+    len_t inc_y)
+{
+    SP_ERROR pending = begin_call();
+    sp_blas_scopy_scal(n, alpha, x, inc_x, y, inc_y);
+    return end_call(pending);
+}
+
+
+/** Same as sp_blas_sgemv, returning SP_NO_ERROR or the failed check. */
+SP_ERROR
+sp_blas_sgemv_err(
+    bool is_trans,
+    len_t m,
+    len_t n,
+    float alpha,
+    const float * const a,
+    len_t lda,
+    const float * const x,
+    len_t inc_x,
+    float beta,
+    float * const y,
+    len_t inc_y)
+{
+    SP_ERROR pending = begin_call();
+    sp_blas_sgemv(is_trans, m, n, alpha, a, lda, x, inc_x, beta, y, inc_y);
+    return end_call(pending);
+}
+
+
+/** Same as sp_blas_sger, returning SP_NO_ERROR or the failed check. */
+SP_ERROR
+sp_blas_sger_err(
+    len_t rows,
+    len_t cols,
+    float alpha,
+    const float * const x,
+    len_t inc_x,
+    const float * const y,
+    len_t inc_y,
+    float * const A,
+    len_t lda)
+{
+    SP_ERROR pending = begin_call();
+    sp_blas_sger(rows, cols, alpha, x, inc_x, y, inc_y, A, lda);
+    return end_call(pending);
+}
+
+
+/** Same as sp_blas_strmv, returning SP_NO_ERROR or the failed check. */
+SP_ERROR
+sp_blas_strmv_err(
+    bool is_upper,
+    bool is_trans,
+    bool is_unit,
+    len_t n,
+    const float * const A,
+    len_t lda,
+    float * const x,
+    len_t inc_x)
+{
+    SP_ERROR pending = begin_call();
+    sp_blas_strmv(is_upper, is_trans, is_unit, n, A, lda, x, inc_x);
+    return end_call(pending);
+}
+
+
+/** Same as sp_blas_strsv, returning SP_NO_ERROR or the failed check. */
+SP_ERROR
+sp_blas_strsv_err(
+    bool is_upper,
+    bool is_trans,
+    bool is_unit,
+    len_t n,
+    const float * const A,
+    len_t lda,
+    float * const x,
+    len_t inc_x)
+{
+    SP_ERROR pending = begin_call();
+    sp_blas_strsv(is_upper, is_trans, is_unit, n, A, lda, x, inc_x);
+    return end_call(pending);
+}
+
+
+/** Same as sp_blas_ssymv, returning SP_NO_ERROR or the failed check. */
+SP_ERROR
+sp_blas_ssymv_err(
+    bool is_upper,
+    len_t n,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    const float * const x,
+    len_t inc_x,
+    float beta,
+    float * const y,
+    len_t inc_y)
+{
+    SP_ERROR pending = begin_call();
+    sp_blas_ssymv(is_upper, n, alpha, A, lda, x, inc_x, beta, y, inc_y);
+    return end_call(pending);
+}
+
+
+/** Same as sp_blas_sspmv, returning SP_NO_ERROR or the failed check. */
+SP_ERROR
+sp_blas_sspmv_err(
+    bool is_upper,
+    len_t n,
+    float alpha,
+    const float * const AP,
+    const float * const x,
+    len_t inc_x,
+    float beta,
+    float * const y,
+    len_t inc_y)
+{
+    SP_ERROR pending = begin_call();
+    sp_blas_sspmv(is_upper, n, alpha, AP, x, inc_x, beta, y, inc_y);
+    return end_call(pending);
+}
+
+
+/** Same as sp_blas_stpmv, returning SP_NO_ERROR or the failed check. */
+SP_ERROR
+sp_blas_stpmv_err(
+    bool is_upper,
+    bool is_trans,
+    bool is_unit,
+    len_t n,
+    const float * const AP,
+    float * const x,
+    len_t inc_x)
+{
+    SP_ERROR pending = begin_call();
+    sp_blas_stpmv(is_upper, is_trans, is_unit, n, AP, x, inc_x);
+    return end_call(pending);
+}
+
+
+/** Same as sp_blas_stpsv, returning SP_NO_ERROR or the failed check. */
+SP_ERROR
+sp_blas_stpsv_err(
+    bool is_upper,
+    bool is_trans,
+    bool is_unit,
+    len_t n,
+    const float * const AP,
+    float * const x,
+    len_t inc_x)
+{
+    SP_ERROR pending = begin_call();
+    sp_blas_stpsv(is_upper, is_trans, is_unit, n, AP, x, inc_x);
+    return end_call(pending);
+}
+
+
+/** Same as sp_blas_sspr, returning SP_NO_ERROR or the failed check. */
+SP_ERROR
+sp_blas_sspr_err(
+    bool is_upper,
+    len_t n,
+    float alpha,
+    const float * const x,
+    len_t inc_x,
+    float * const AP)
+{
+    SP_ERROR pending = begin_call();
+    sp_blas_sspr(is_upper, n, alpha, x, inc_x, AP);
+    return end_call(pending);
+}
+
+
+/** Same as sp_blas_sspr2, returning SP_NO_ERROR or the failed check. */
+SP_ERROR
+sp_blas_sspr2_err(
+    bool is_upper,
+    len_t n,
+    float alpha,
+    const float * const x,
+    len_t inc_x,
+    const float * const y,
+    len_t inc_y,
+    float * const AP)
+{
+    SP_ERROR pending = begin_call();
+    sp_blas_sspr2(is_upper, n, alpha, x, inc_x, y, inc_y, AP);
+    return end_call(pending);
+}
+
+
+/** Same as sp_blas_sgbmv, returning SP_NO_ERROR or the failed check. */
+SP_ERROR
+sp_blas_sgbmv_err(
+    bool is_trans,
+    len_t rows,
+    len_t cols,
+    len_t kl,
+    len_t ku,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    const float * const x,
+    len_t inc_x,
+    float beta,
+    float * const y,
+    len_t inc_y)
+{
+    SP_ERROR pending = begin_call();
+    sp_blas_sgbmv(is_trans, rows, cols, kl, ku, alpha, A, lda, x, inc_x, beta,
+        y, inc_y);
+    return end_call(pending);
+}
+
+
+/** Same as sp_blas_ssbmv, returning SP_NO_ERROR or the failed check. */
+SP_ERROR
+sp_blas_ssbmv_err(
+    bool is_upper,
+    len_t n,
+    len_t k,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    const float * const x,
+    len_t inc_x,
+    float beta,
+    float * const y,
+    len_t inc_y)
+{
+    SP_ERROR pending = begin_call();
+    sp_blas_ssbmv(is_upper, n, k, alpha, A, lda, x, inc_x, beta, y, inc_y);
+    return end_call(pending);
+}
+
+
+/** Same as sp_blas_stbmv, returning SP_NO_ERROR or the failed check. */
+SP_ERROR
+sp_blas_stbmv_err(
+    bool is_upper,
+    bool is_trans,
+    bool is_unit,
+    len_t n,
+    len_t k,
+    const float * const A,
+    len_t lda,
+    float * const x,
+    len_t inc_x)
+{
+    SP_ERROR pending = begin_call();
+    sp_blas_stbmv(is_upper, is_trans, is_unit, n, k, A, lda, x, inc_x);
+    return end_call(pending);
+}
+
+
+/** Same as sp_blas_stbsv, returning SP_NO_ERROR or the failed check. */
+SP_ERROR
+sp_blas_stbsv_err(
+    bool is_upper,
+    bool is_trans,
+    bool is_unit,
+    len_t n,
+    len_t k,
+    const float * const A,
+    len_t lda,
+    float * const x,
+    len_t inc_x)
+{
+    SP_ERROR pending = begin_call();
+    sp_blas_stbsv(is_upper, is_trans, is_unit, n, k, A, lda, x, inc_x);
+    return end_call(pending);
+}
+
+
+/** Same as sp_blas_sgemm, returning SP_NO_ERROR or the failed check. */
+SP_ERROR
+sp_blas_sgemm_err(
+    bool is_trans_a,
+    bool is_trans_b,
+    len_t m,
+    len_t n,
+    len_t k,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    const float * const B,
+    len_t ldb,
+    float beta,
+    float * const C,
+    len_t ldc)
+{
+    SP_ERROR pending = begin_call();
+    sp_blas_sgemm(is_trans_a, is_trans_b, m, n, k, alpha, A, lda, B, ldb, beta,
+        C, ldc);
+    return end_call(pending);
+}
+
+
+/** Same as sp_blas_strsm, returning SP_NO_ERROR or the failed check. */
+SP_ERROR
+sp_blas_strsm_err(
+    bool is_left,
+    bool is_upper,
+    bool is_trans,
+    bool is_unit,
+    len_t m,
+    len_t n,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    float * const B,
+    len_t ldb)
+{
+    SP_ERROR pending = begin_call();
+    sp_blas_strsm(is_left, is_upper, is_trans, is_unit, m, n, alpha, A, lda, B,
+        ldb);
+    return end_call(pending);
+}
+
+
+/** Same as sp_blas_sasum_batch, returning SP_NO_ERROR or the failed check. */
+SP_ERROR
+sp_blas_sasum_batch_err(
+    len_t n,
+    const float * const x,
+    len_t inc_x,
+    len_t stride_x,
+    float * const result,
+    len_t batch_count)
+{
+    SP_ERROR pending = begin_call();
+    sp_blas_sasum_batch(n, x, inc_x, stride_x, result, batch_count);
+    return end_call(pending);
+}
+
+
+/**
+ * Same as sp_blas_sasum_batch_ptr, returning SP_NO_ERROR or the failed
+ * check.
+ */
+SP_ERROR
+sp_blas_sasum_batch_ptr_err(
+    len_t n,
+    const float * const * const x,
+    len_t inc_x,
+    float * const result,
+    len_t batch_count)
+{
+    SP_ERROR pending = begin_call();
+    sp_blas_sasum_batch_ptr(n, x, inc_x, result, batch_count);
+    return end_call(pending);
+}
+
+
+/** Same as sp_blas_saxpy_batch, returning SP_NO_ERROR or the failed check. */
+SP_ERROR
+sp_blas_saxpy_batch_err(
+    len_t n,
+    float alpha,
+    const float * const x,
+    len_t inc_x,
+    len_t stride_x,
+    float * const y,
+    len_t inc_y,
+    len_t stride_y,
+    len_t batch_count)
+{
+    SP_ERROR pending = begin_call();
+    sp_blas_saxpy_batch(n, alpha, x, inc_x, stride_x, y, inc_y, stride_y,
+        batch_count);
+    return end_call(pending);
+}
+
+
+/**
+ * Same as sp_blas_saxpy_batch_ptr, returning SP_NO_ERROR or the failed
+ * check.
+ */
+SP_ERROR
+sp_blas_saxpy_batch_ptr_err(
+    len_t n,
+    float alpha,
+    const float * const * const x,
+    len_t inc_x,
+    float * const * const y,
+    len_t inc_y,
+    len_t batch_count)
+{
+    SP_ERROR pending = begin_call();
+    sp_blas_saxpy_batch_ptr(n, alpha, x, inc_x, y, inc_y, batch_count);
+    return end_call(pending);
+}
+
+
+/** Same as sp_blas_sdot_batch, returning SP_NO_ERROR or the failed check. */
+SP_ERROR
+sp_blas_sdot_batch_err(
+    len_t n,
+    const float * const x,
+    len_t inc_x,
+    len_t stride_x,
+    const float * const y,
+    len_t inc_y,
+    len_t stride_y,
+    float * const result,
+    len_t batch_count)
+{
+    SP_ERROR pending = begin_call();
+    sp_blas_sdot_batch(n, x, inc_x, stride_x, y, inc_y, stride_y, result,
+        batch_count);
+    return end_call(pending);
+}
+
+
+/**
+ * Same as sp_blas_sdot_batch_ptr, returning SP_NO_ERROR or the failed
+ * check.
+ */
+SP_ERROR
+sp_blas_sdot_batch_ptr_err(
+    len_t n,
+    const float * const * const x,
+    len_t inc_x,
+    const float * const * const y,
+    len_t inc_y,
+    float * const result,
+    len_t batch_count)
+{
+    SP_ERROR pending = begin_call();
+    sp_blas_sdot_batch_ptr(n, x, inc_x, y, inc_y, result, batch_count);
+    return end_call(pending);
+}
+
+
+/** Same as sp_blas_snrm2_batch, returning SP_NO_ERROR or the failed check. */
+SP_ERROR
+sp_blas_snrm2_batch_err(
+    len_t n,
+    const float * const x,
+    len_t inc_x,
+    len_t stride_x,
+    float * const result,
+    len_t batch_count)
+{
+    SP_ERROR pending = begin_call();
+    sp_blas_snrm2_batch(n, x, inc_x, stride_x, result, batch_count);
+    return end_call(pending);
+}
+
+
+/**
+ * Same as sp_blas_snrm2_batch_ptr, returning SP_NO_ERROR or the failed
+ * check.
+ */
+SP_ERROR
+sp_blas_snrm2_batch_ptr_err(
+    len_t n,
+    const float * const * const x,
+    len_t inc_x,
+    float * const result,
+    len_t batch_count)
+{
+    SP_ERROR pending = begin_call();
+    sp_blas_snrm2_batch_ptr(n, x, inc_x, result, batch_count);
+    return end_call(pending);
+}
+
+
+/** Same as sp_blas_sscal_batch, returning SP_NO_ERROR or the failed check. */
+SP_ERROR
+sp_blas_sscal_batch_err(
+    len_t n,
+    float alpha,
+    float * const x,
+    len_t inc_x,
+    len_t stride_x,
+    len_t batch_count)
+{
+    SP_ERROR pending = begin_call();
+    sp_blas_sscal_batch(n, alpha, x, inc_x, stride_x, batch_count);
+    return end_call(pending);
+}
+
+
+/**
+ * Same as sp_blas_sscal_batch_ptr, returning SP_NO_ERROR or the failed
+ * check.
+ */
+SP_ERROR
+sp_blas_sscal_batch_ptr_err(
+    len_t n,
+    float alpha,
+    float * const * const x,
+    len_t inc_x,
+    len_t batch_count)
+{
+    SP_ERROR pending = begin_call();
+    sp_blas_sscal_batch_ptr(n, alpha, x, inc_x, batch_count);
+    return end_call(pending);
+}
+
+
+/** Same as sp_blas_sgemv_batch, returning SP_NO_ERROR or the failed check. */
+SP_ERROR
+sp_blas_sgemv_batch_err(
+    bool is_trans,
+    len_t rows,
+    len_t cols,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    len_t stride_A,
+    const float * const x,
+    len_t inc_x,
+    len_t stride_x,
+    float beta,
+    float * const y,
+    len_t inc_y,
+    len_t stride_y,
+    len_t batch_count)
+{
+    SP_ERROR pending = begin_call();
+    sp_blas_sgemv_batch(is_trans, rows, cols, alpha, A, lda, stride_A, x, inc_x,
+        stride_x, beta, y, inc_y, stride_y, batch_count);
+    return end_call(pending);
+}
+
+
+/**
+ * Same as sp_blas_sgemv_batch_ptr, returning SP_NO_ERROR or the failed
+ * check.
+ */
+SP_ERROR
+sp_blas_sgemv_batch_ptr_err(
+    bool is_trans,
+    len_t rows,
+    len_t cols,
+    float alpha,
+    const float * const * const A,
+    len_t lda,
+    const float * const * const x,
+    len_t inc_x,
+    float beta,
+    float * const * const y,
+    len_t inc_y,
+    len_t batch_count)
+{
+    SP_ERROR pending = begin_call();
+    sp_blas_sgemv_batch_ptr(is_trans, rows, cols, alpha, A, lda, x, inc_x, beta,
+        y, inc_y, batch_count);
+    return end_call(pending);
+}
@@ -0,0 +1,258 @@
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "snackpack/arch.h"
+#include "snackpack/internal/blas1_real_internal.h"
+#include "snackpack/internal/blas1_real_simd.h"
+#include "snackpack/internal/blas2_real_internal.h"
+#include "snackpack/internal/blas2_real_simd.h"
+#include "snackpack/internal/blas3_real_internal.h"
+#include "snackpack/internal/blas3_real_simd.h"
+#include "snackpack/internal/dispatch.h"
+#include "snackpack/internal/sort_internal.h"
+#include "snackpack/internal/sort_simd.h"
+
+
+/* Reference kernels. These run everywhere. */
+static const sp_kernel_table scalar_kernels = {
+    .name             = "scalar",
+    .sasum_inc1       = sp_blas_sasum_inc1,
+    .saxpy_inc1       = sp_blas_saxpy_inc1,
+    .sdot_inc1        = sp_blas_sdot_inc1,
+    .srot_inc1        = sp_blas_srot_inc1,
+    .sscal_inc1       = sp_blas_sscal_inc1,
+    .scopy_inc1       = sp_blas_scopy_inc1,
+    .sswap_inc1       = sp_blas_sswap_inc1,
+    .snrm2_inc1       = sp_blas_snrm2_inc1,
+    .isamax_inc1      = sp_blas_isamax_inc1,
+    .isamin_inc1      = sp_blas_isamin_inc1,
+    .saxpy_dot_inc1   = sp_blas_saxpy_dot_inc1,
+    .scopy_scal_inc1  = sp_blas_scopy_scal_inc1,
+    .sgemv_n_inc1     = sp_blas_sgemv_n_inc1,
+    .sgemv_t_inc1     = sp_blas_sgemv_t_inc1,
+    .sgemv_n_small    = sp_blas_sgemv_n_small,
+    .sgemv_t_small    = sp_blas_sgemv_t_small,
+    .sger_inc1        = sp_blas_sger_inc1,
+    .ssymv_panel_inc1 = sp_blas_ssymv_panel_inc1,
+    .sgemm_mr         = SP_SGEMM_MR,
+    .sgemm_nr         = SP_SGEMM_NR,
+    .sgemm_kernel     = sp_blas_sgemm_kernel,
+    .sort16           = sp_sort16,
+    .sort_partition   = sp_sort_partition,
+};
+
+
+#ifdef SP_HAVE_X86_KERNELS
+static const sp_kernel_table sse42_kernels = {
+    .name             = "sse42",
+    .sasum_inc1       = sp_blas_sasum_inc1_sse42,
+    .saxpy_inc1       = sp_blas_saxpy_inc1_sse42,
+    .sdot_inc1        = sp_blas_sdot_inc1_sse42,
+    .srot_inc1        = sp_blas_srot_inc1_sse42,
+    .sscal_inc1       = sp_blas_sscal_inc1_sse42,
+    .scopy_inc1       = sp_blas_scopy_inc1_sse42,
+    .sswap_inc1       = sp_blas_sswap_inc1_sse42,
+    .snrm2_inc1       = sp_blas_snrm2_inc1_sse42,
+    .isamax_inc1      = sp_blas_isamax_inc1_sse42,
+    .isamin_inc1      = sp_blas_isamin_inc1_sse42,
+    .saxpy_dot_inc1   = sp_blas_saxpy_dot_inc1_sse42,
+    .scopy_scal_inc1  = sp_blas_scopy_scal_inc1_sse42,
+    .sgemv_n_inc1     = sp_blas_sgemv_n_inc1,
+    .sgemv_t_inc1     = sp_blas_sgemv_t_inc1,
+    .sgemv_n_small    = sp_blas_sgemv_n_small,
+    .sgemv_t_small    = sp_blas_sgemv_t_small,
+    .sger_inc1        = sp_blas_sger_inc1,
+    .ssymv_panel_inc1 = sp_blas_ssymv_panel_inc1,
+    .sgemm_mr         = SP_SGEMM_MR,
+    .sgemm_nr         = SP_SGEMM_NR,
+    .sgemm_kernel     = sp_blas_sgemm_kernel,
+    .sort16           = sp_sort16,
+    .sort_partition   = sp_sort_partition,
+};
+
+
+static const sp_kernel_table avx2_kernels = {
+    .name             = "avx2",
+    .sasum_inc1       = sp_blas_sasum_inc1_avx2,
+    .saxpy_inc1       = sp_blas_saxpy_inc1_avx2,
+    .sdot_inc1        = sp_blas_sdot_inc1_avx2,
+    .srot_inc1        = sp_blas_srot_inc1_avx2,
+    .sscal_inc1       = sp_blas_sscal_inc1_avx2,
+    .scopy_inc1       = sp_blas_scopy_inc1_avx2,
+    .sswap_inc1       = sp_blas_sswap_inc1_avx2,
+    .snrm2_inc1       = sp_blas_snrm2_inc1_avx2,
+    .isamax_inc1      = sp_blas_isamax_inc1_avx2,
+    .isamin_inc1      = sp_blas_isamin_inc1_avx2,
+    .saxpy_dot_inc1   = sp_blas_saxpy_dot_inc1_avx2,
+    .scopy_scal_inc1  = sp_blas_scopy_scal_inc1_avx2,
+    .sgemv_n_inc1     = sp_blas_sgemv_n_inc1_avx2,
+    .sgemv_t_inc1     = sp_blas_sgemv_t_inc1_avx2,
+    .sgemv_n_small    = sp_blas_sgemv_n_small_avx2,
+    .sgemv_t_small    = sp_blas_sgemv_t_small_avx2,
+    .sger_inc1        = sp_blas_sger_inc1_avx2,
+    .ssymv_panel_inc1 = sp_blas_ssymv_panel_inc1_avx2,
+    .sgemm_mr         = SP_SGEMM_MR_AVX2,
+    .sgemm_nr         = SP_SGEMM_NR_AVX2,
+    .sgemm_kernel     = sp_blas_sgemm_kernel_avx2,
+    .sort16           = sp_sort16_avx2,
+    .sort_partition   = sp_sort_partition_avx2,
+};
+
+
+static const sp_kernel_table avx512_kernels = {
+    .name             = "avx512",
+    .sasum_inc1       = sp_blas_sasum_inc1_avx512,
+    .saxpy_inc1       = sp_blas_saxpy_inc1_avx512,
+    .sdot_inc1        = sp_blas_sdot_inc1_avx512,
+    .srot_inc1        = sp_blas_srot_inc1_avx512,
+    .sscal_inc1       = sp_blas_sscal_inc1_avx512,
+    .scopy_inc1       = sp_blas_scopy_inc1_avx512,
+    .sswap_inc1       = sp_blas_sswap_inc1_avx512,
+    .snrm2_inc1       = sp_blas_snrm2_inc1_avx512,
+    .isamax_inc1      = sp_blas_isamax_inc1_avx512,
+    .isamin_inc1      = sp_blas_isamin_inc1_avx512,
+    .saxpy_dot_inc1   = sp_blas_saxpy_dot_inc1_avx512,
+    .scopy_scal_inc1  = sp_blas_scopy_scal_inc1_avx512,
+    .sgemv_n_inc1     = sp_blas_sgemv_n_inc1_avx512,
+    .sgemv_t_inc1     = sp_blas_sgemv_t_inc1_avx512,
+    .sgemv_n_small    = sp_blas_sgemv_n_small_avx2,
+    .sgemv_t_small    = sp_blas_sgemv_t_small_avx2,
+    .sger_inc1        = sp_blas_sger_inc1_avx512,
+    .ssymv_panel_inc1 = sp_blas_ssymv_panel_inc1_avx2,
+    .sgemm_mr         = SP_SGEMM_MR_AVX512,
+    .sgemm_nr         = SP_SGEMM_NR_AVX512,
+    .sgemm_kernel     = sp_blas_sgemm_kernel_avx512,
+    .sort16           = sp_sort16_avx2,
+    .sort_partition   = sp_sort_partition_avx2,
+};
+#endif
+
+
+/*
+ * Start out with the reference kernels so that the table is usable even if
+ * something calls into the library before the constructor below has run.
+ */
+sp_kernel_table sp_kernels = {
+    .name             = "scalar",
+    .sasum_inc1       = sp_blas_sasum_inc1,
+    .saxpy_inc1       = sp_blas_saxpy_inc1,
+    .sdot_inc1        = sp_blas_sdot_inc1,
+    .srot_inc1        = sp_blas_srot_inc1,
+    .sscal_inc1       = sp_blas_sscal_inc1,
+    .scopy_inc1       = sp_blas_scopy_inc1,
+    .sswap_inc1       = sp_blas_sswap_inc1,
+    .snrm2_inc1       = sp_blas_snrm2_inc1,
+    .isamax_inc1      = sp_blas_isamax_inc1,
+    .isamin_inc1      = sp_blas_isamin_inc1,
+    .saxpy_dot_inc1   = sp_blas_saxpy_dot_inc1,
+    .scopy_scal_inc1  = sp_blas_scopy_scal_inc1,
+    .sgemv_n_inc1     = sp_blas_sgemv_n_inc1,
+    .sgemv_t_inc1     = sp_blas_sgemv_t_inc1,
+    .sgemv_n_small    = sp_blas_sgemv_n_small,
+    .sgemv_t_small    = sp_blas_sgemv_t_small,
+    .sger_inc1        = sp_blas_sger_inc1,
+    .ssymv_panel_inc1 = sp_blas_ssymv_panel_inc1,
+    .sgemm_mr         = SP_SGEMM_MR,
+    .sgemm_nr         = SP_SGEMM_NR,
+    .sgemm_kernel     = sp_blas_sgemm_kernel,
+    .sort16           = sp_sort16,
+    .sort_partition   = sp_sort_partition,
+};
+
+
+/* Return true if the host can run the given table. */
+static bool
+is_supported(
+    const sp_kernel_table * const table)
+{
+    if (table == &scalar_kernels) {
+        return true;
+    }
+#ifdef SP_HAVE_X86_KERNELS
+    __builtin_cpu_init();
+    if (table == &sse42_kernels) {
+        return __builtin_cpu_supports("sse4.2");
+    } else if (table == &avx2_kernels) {
+        return __builtin_cpu_supports("avx2")
+            && __builtin_cpu_supports("fma");
+    } else if (table == &avx512_kernels) {
+        return __builtin_cpu_supports("avx512f")
+            && __builtin_cpu_supports("avx2")
+            && __builtin_cpu_supports("fma");
+    }
+#endif
+    return false;
+}
+
+
+/* Variants in order of preference. */
+static const sp_kernel_table * const all_kernels[] = {
+#ifdef SP_HAVE_X86_KERNELS
+    &avx512_kernels,
+    &avx2_kernels,
+    &sse42_kernels,
+#endif
+    &scalar_kernels,
+};
+
+#define NUM_KERNEL_TABLES (sizeof(all_kernels) / sizeof(all_kernels[0]))
+
+
+/**
+ * Return the name of the kernel variant in use, e.g. "avx2".
+ */
+const char *
+sp_get_arch(void)
+{
+    return sp_kernels.name;
+}
+
+
+/**
+ * Select a kernel variant by name.
+ *
+ * \param[in] name      One of "scalar", "sse42", "avx2", "avx512", or
+ *                      "auto" to pick the best variant for the host.
+ * \returns             True if the variant was selected, false if the name
+ *                      is unknown or the host does not support it. The
+ *                      current selection is unchanged on failure.
+ *
+ * This is meant for benchmarking and testing. It is not thread safe and
+ * should be called before any other thread is using the library.
+ */
+bool
+sp_set_arch(
+    const char * const name)
+{
+    bool is_auto = strcmp(name, "auto") == 0;
+
+    for (size_t i = 0; i < NUM_KERNEL_TABLES; i++) {
+        const sp_kernel_table * table = all_kernels[i];
+        if (!is_auto && strcmp(name, table->name) != 0) {
+            continue;
+        }
+        if (is_supported(table)) {
+            sp_kernels = *table;
+            return true;
+        } else if (!is_auto) {
+            return false;
+        }
+    }
+    return false;
+}
+
+
+/*
+ * Probe the CPU once when the library is loaded. SNACKPACK_ARCH can be used
+ * to pin a variant; an unknown or unsupported value falls back to "auto".
+ */
+__attribute__((constructor))
+static void
+sp_dispatch_init(void)
+{
+    const char * env = getenv("SNACKPACK_ARCH");
+    if (env == NULL || !sp_set_arch(env)) {
+        sp_set_arch("auto");
+    }
+}
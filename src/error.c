@@ -15,3 +15,43 @@ const char * SP_ERROR_DESCR[NUM_SP_ERROR] = {
     [SP_ERROR_DIM_TOO_LARGE]    = "matrix/vector dimensions too large"
 };
 
+
+
+/* The error code of the last failed check on this thread. */
+static __thread SP_ERROR last_error = SP_NO_ERROR;
+
+
+/**
+ * Return the error code of the last failed check made on the calling
+ * thread, or SP_NO_ERROR if no check has failed since the last call to
+ * sp_clear_last_error.
+ */
+SP_ERROR
+sp_get_last_error(void)
+{
+    return last_error;
+}
+
+
+/**
+ * Reset the error code of the calling thread to SP_NO_ERROR.
+ */
+void
+sp_clear_last_error(void)
+{
+    last_error = SP_NO_ERROR;
+}
+
+
+/**
+ * Set the error code of the calling thread. This is called by the
+ * SP_ASSERT_* macros when a check fails.
+ *
+ * \param error The error code to store.
+ */
+void
+sp_set_last_error(
+    SP_ERROR error)
+{
+    last_error = error;
+}
@@ -0,0 +1,543 @@
+#include <stdlib.h>
+
+#include "snackpack/plan.h"
+#include "snackpack/error.h"
+#include "snackpack/threads.h"
+#include "snackpack/internal/blas1_real_internal.h"
+#include "snackpack/internal/blas1_real_reduce.h"
+#include "snackpack/internal/blas2_real_internal.h"
+#include "snackpack/internal/dispatch.h"
+
+
+/* Body of a plan. The array arguments are those of sp_plan_execute. */
+typedef float (*plan_fn)(
+    const sp_plan * const plan,
+    const float * const A,
+    const float * const x,
+    float * const y);
+
+
+/* Signature of the single-threaded sgemv for any increments. */
+typedef void (*sgemv_incxy_fn)(
+    len_t rows,
+    len_t cols,
+    float alpha,
+    const float * const A,
+    len_t lda,
+    const float * const x,
+    len_t inc_x,
+    float beta,
+    float * const y,
+    len_t inc_y);
+
+
+struct sp_plan {
+    plan_fn execute;
+
+    bool is_trans;
+    len_t rows;
+    len_t cols;
+    len_t lda;
+    len_t inc_x;
+    len_t inc_y;
+    float alpha;
+    float beta;
+
+    /* The kernel picked for the plan. Which member is used depends on
+     * execute.
+     */
+    union {
+        void (*sgemv_small)(
+            len_t rows,
+            len_t cols,
+            float alpha,
+            const float * const A,
+            len_t lda,
+            const float * const x,
+            float beta,
+            float * const y);
+        sgemv_incxy_fn sgemv_incxy;
+        void (*saxpy_inc1)(
+            len_t n,
+            float alpha,
+            const float * const x,
+            float * const y);
+        float (*sdot_inc1)(
+            len_t n,
+            const float * const x,
+            const float * const y);
+        void (*sscal_inc1)(
+            len_t n,
+            float alpha,
+            float * const x);
+        void (*scopy_inc1)(
+            len_t n,
+            const float * const x,
+            float * const y);
+    } kernel;
+};
+
+
+static sp_plan *
+new_plan(
+    plan_fn execute)
+{
+    sp_plan * plan = calloc(1, sizeof(sp_plan));
+    if (plan != NULL) {
+        plan->execute = execute;
+    }
+    return plan;
+}
+
+
+static float
+sgemv_small(
+    const sp_plan * const p,
+    const float * const A,
+    const float * const x,
+    float * const y)
+{
+    p->kernel.sgemv_small(p->rows, p->cols, p->alpha, A, p->lda, x, p->beta,
+        y);
+    return 0.0f;
+}
+
+
+static float
+sgemv_serial(
+    const sp_plan * const p,
+    const float * const A,
+    const float * const x,
+    float * const y)
+{
+    p->kernel.sgemv_incxy(p->rows, p->cols, p->alpha, A, p->lda, x,
+        p->inc_x, p->beta, y, p->inc_y);
+    return 0.0f;
+}
+
+
+static float
+sgemv_parallel(
+    const sp_plan * const p,
+    const float * const A,
+    const float * const x,
+    float * const y)
+{
+    sp_blas_sgemv_parallel(p->is_trans, p->rows, p->cols, p->alpha, A,
+        p->lda, x, p->inc_x, p->beta, y, p->inc_y);
+    return 0.0f;
+}
+
+
+/* alpha = 0: only beta * y is left. */
+static float
+sgemv_beta(
+    const sp_plan * const p,
+    const float * const A,
+    const float * const x,
+    float * const y)
+{
+    (void)A;
+    (void)x;
+    sp_blas_scale_y(p->is_trans ? p->cols : p->rows, p->beta, y, p->inc_y);
+    return 0.0f;
+}
+
+
+/**
+ * Plan a general matrix-vector product.
+ *
+ * The plan performs one of
+ *
+ *      y = alpha*A*x + beta*y
+ * or
+ *      y = alpha*A^T*x + beta*y
+ *
+ * with the arguments as for sp_blas_sgemv. Pass A, x and y to
+ * sp_plan_execute.
+ *
+ * \returns             The plan, or NULL if an argument is invalid or the
+ *                      plan cannot be allocated
+ *
+ * Small matrices with unit increments get the shape-specialized kernels of
+ * the batched sgemv. Whether the product is split across the thread pool is
+ * decided here, from SP_SGEMV_PARALLEL_MIN and the number of threads at the
+ * time.
+ */
+sp_plan *
+sp_plan_sgemv(
+    bool is_trans,
+    len_t rows,
+    len_t cols,
+    float alpha,
+    len_t lda,
+    len_t inc_x,
+    float beta,
+    len_t inc_y)
+{
+    sp_plan * plan = NULL;
+
+    SP_ASSERT_VALID_DIM(rows);
+    SP_ASSERT_VALID_DIM(cols);
+    SP_ASSERT_VALID_LDA(lda, rows);
+    SP_ASSERT_VALID_INC(inc_x);
+    SP_ASSERT_VALID_INC(inc_y);
+
+    bool is_threaded = (int64_t)rows * cols >= SP_SGEMV_PARALLEL_MIN
+        && sp_get_num_threads() > 1;
+
+    if (alpha == 0.0f) {
+        plan = new_plan(sgemv_beta);
+    } else if (inc_x == 1 && inc_y == 1 && SP_SGEMV_IS_SMALL(rows)) {
+        plan = new_plan(sgemv_small);
+        if (plan != NULL) {
+            plan->kernel.sgemv_small = is_trans ?
+                sp_kernels.sgemv_t_small : sp_kernels.sgemv_n_small;
+        }
+    } else if (is_threaded) {
+        plan = new_plan(sgemv_parallel);
+    } else {
+        plan = new_plan(sgemv_serial);
+        if (plan != NULL) {
+            plan->kernel.sgemv_incxy = is_trans ?
+                sp_blas_sgemv_t_incxy : sp_blas_sgemv_n_incxy;
+        }
+    }
+
+    if (plan != NULL) {
+        plan->is_trans = is_trans;
+        plan->rows = rows;
+        plan->cols = cols;
+        plan->lda = lda;
+        plan->inc_x = inc_x;
+        plan->inc_y = inc_y;
+        plan->alpha = alpha;
+        plan->beta = beta;
+    }
+
+fail:
+    return plan;
+}
+
+
+static float
+saxpy_inc1(
+    const sp_plan * const p,
+    const float * const A,
+    const float * const x,
+    float * const y)
+{
+    (void)A;
+    p->kernel.saxpy_inc1(p->rows, p->alpha, x, y);
+    return 0.0f;
+}
+
+
+static float
+saxpy_incxy(
+    const sp_plan * const p,
+    const float * const A,
+    const float * const x,
+    float * const y)
+{
+    (void)A;
+    sp_blas_saxpy_incxy(p->rows, p->alpha, x, p->inc_x, y, p->inc_y);
+    return 0.0f;
+}
+
+
+/**
+ * Plan y = alpha*x + y, with the arguments as for sp_blas_saxpy. Pass x
+ * and y to sp_plan_execute; A is not used.
+ *
+ * \returns             The plan, or NULL if an argument is invalid or the
+ *                      plan cannot be allocated
+ */
+sp_plan *
+sp_plan_saxpy(
+    len_t n,
+    float alpha,
+    len_t inc_x,
+    len_t inc_y)
+{
+    sp_plan * plan = NULL;
+
+    SP_ASSERT_VALID_DIM(n);
+    SP_ASSERT_VALID_INC(inc_x);
+    SP_ASSERT_VALID_INC(inc_y);
+
+    if (inc_x == 1 && inc_y == 1) {
+        plan = new_plan(saxpy_inc1);
+        if (plan != NULL) {
+            plan->kernel.saxpy_inc1 = sp_kernels.saxpy_inc1;
+        }
+    } else {
+        plan = new_plan(saxpy_incxy);
+    }
+
+    if (plan != NULL) {
+        plan->rows = n;
+        plan->inc_x = inc_x;
+        plan->inc_y = inc_y;
+        plan->alpha = alpha;
+    }
+
+fail:
+    return plan;
+}
+
+
+static float
+sdot_inc1(
+    const sp_plan * const p,
+    const float * const A,
+    const float * const x,
+    float * const y)
+{
+    (void)A;
+    return p->kernel.sdot_inc1(p->rows, x, y);
+}
+
+
+static float
+sdot_incxy(
+    const sp_plan * const p,
+    const float * const A,
+    const float * const x,
+    float * const y)
+{
+    (void)A;
+    return sp_blas_sdot_incxy(p->rows, x, p->inc_x, y, p->inc_y);
+}
+
+
+static float
+sdot_reduce(
+    const sp_plan * const p,
+    const float * const A,
+    const float * const x,
+    float * const y)
+{
+    (void)A;
+    return sp_blas_sdot_reduce(p->rows, x, p->inc_x, y, p->inc_y);
+}
+
+
+/**
+ * Plan the dot product x^T*y, with the arguments as for sp_blas_sdot. Pass
+ * x and y to sp_plan_execute, which returns the result; y is only read
+ * and A is not used.
+ *
+ * \returns             The plan, or NULL if an argument is invalid or the
+ *                      plan cannot be allocated
+ *
+ * Long vectors are reduced in the same fixed order as by sp_blas_sdot, so
+ * the result is the same.
+ */
+sp_plan *
+sp_plan_sdot(
+    len_t n,
+    len_t inc_x,
+    len_t inc_y)
+{
+    sp_plan * plan = NULL;
+
+    SP_ASSERT_VALID_DIM(n);
+    SP_ASSERT_VALID_INC(inc_x);
+    SP_ASSERT_VALID_INC(inc_y);
+
+    if (n >= SP_REDUCE_PARALLEL_MIN) {
+        plan = new_plan(sdot_reduce);
+    } else if (inc_x == 1 && inc_y == 1) {
+        plan = new_plan(sdot_inc1);
+        if (plan != NULL) {
+            plan->kernel.sdot_inc1 = sp_kernels.sdot_inc1;
+        }
+    } else {
+        plan = new_plan(sdot_incxy);
+    }
+
+    if (plan != NULL) {
+        plan->rows = n;
+        plan->inc_x = inc_x;
+        plan->inc_y = inc_y;
+    }
+
+fail:
+    return plan;
+}
+
+
+static float
+sscal_inc1(
+    const sp_plan * const p,
+    const float * const A,
+    const float * const x,
+    float * const y)
+{
+    (void)A;
+    (void)x;
+    p->kernel.sscal_inc1(p->rows, p->alpha, y);
+    return 0.0f;
+}
+
+
+static float
+sscal_incx(
+    const sp_plan * const p,
+    const float * const A,
+    const float * const x,
+    float * const y)
+{
+    (void)A;
+    (void)x;
+    sp_blas_sscal_incx(p->rows, p->alpha, y, p->inc_y);
+    return 0.0f;
+}
+
+
+/**
+ * Plan x = alpha*x, with the arguments as for sp_blas_sscal. The vector
+ * is updated in place, so it is passed to sp_plan_execute as y; A and x
+ * are not used.
+ *
+ * \returns             The plan, or NULL if an argument is invalid or the
+ *                      plan cannot be allocated
+ */
+sp_plan *
+sp_plan_sscal(
+    len_t n,
+    float alpha,
+    len_t inc_x)
+{
+    sp_plan * plan = NULL;
+
+    SP_ASSERT_VALID_DIM(n);
+    SP_ASSERT_VALID_INC(inc_x);
+
+    if (inc_x == 1) {
+        plan = new_plan(sscal_inc1);
+        if (plan != NULL) {
+            plan->kernel.sscal_inc1 = sp_kernels.sscal_inc1;
+        }
+    } else {
+        plan = new_plan(sscal_incx);
+    }
+
+    if (plan != NULL) {
+        plan->rows = n;
+        plan->inc_y = inc_x;
+        plan->alpha = alpha;
+    }
+
+fail:
+    return plan;
+}
+
+
+static float
+scopy_inc1(
+    const sp_plan * const p,
+    const float * const A,
+    const float * const x,
+    float * const y)
+{
+    (void)A;
+    p->kernel.scopy_inc1(p->rows, x, y);
+    return 0.0f;
+}
+
+
+static float
+scopy_incxy(
+    const sp_plan * const p,
+    const float * const A,
+    const float * const x,
+    float * const y)
+{
+    (void)A;
+    sp_blas_scopy_incxy(p->rows, x, p->inc_x, y, p->inc_y);
+    return 0.0f;
+}
+
+
+/**
+ * Plan y = x, with the arguments as for sp_blas_scopy. Pass x and y to
+ * sp_plan_execute; A is not used.
+ *
+ * \returns             The plan, or NULL if an argument is invalid or the
+ *                      plan cannot be allocated
+ */
+sp_plan *
+sp_plan_scopy(
+    len_t n,
+    len_t inc_x,
+    len_t inc_y)
+{
+    sp_plan * plan = NULL;
+
+    SP_ASSERT_VALID_DIM(n);
+    SP_ASSERT_VALID_INC(inc_x);
+    SP_ASSERT_VALID_INC(inc_y);
+
+    if (inc_x == 1 && inc_y == 1) {
+        plan = new_plan(scopy_inc1);
+        if (plan != NULL) {
+            plan->kernel.scopy_inc1 = sp_kernels.scopy_inc1;
+        }
+    } else {
+        plan = new_plan(scopy_incxy);
+    }
+
+    if (plan != NULL) {
+        plan->rows = n;
+        plan->inc_x = inc_x;
+        plan->inc_y = inc_y;
+    }
+
+fail:
+    return plan;
+}
+
+
+/**
+ * Run a plan.
+ *
+ * \param[in] plan      A plan from one of the sp_plan_* functions
+ * \param[in] A         Matrix operand, if the plan has one
+ * \param[in] x         Input vector, if the plan has one
+ * \param[in,out] y     Output (or second input) vector
+ * \returns             The result of a dot product plan, 0 otherwise
+ *
+ * Nothing is checked here: the arrays must have the sizes the plan was
+ * made for. Operands the plan does not use may be NULL.
+ *
+ * y is not const because every plan except sdot writes to it. An sdot plan
+ * only reads y, so a pointer to const data may be cast for it; nothing is
+ * written through it.
+ *
+ * With unit increments, and for the small sgemv, the plan calls the kernel
+ * that was selected when it was made, even if sp_set_arch has been called
+ * since. The other paths run the same code as the sp_blas_* routines and
+ * use the kernels selected at the time of the call.
+ */
+float
+sp_plan_execute(
+    const sp_plan * const plan,
+    const float * const A,
+    const float * const x,
+    float * const y)
+{
+    return plan->execute(plan, A, x, y);
+}
+
+
+/**
+ * Free a plan. NULL is ignored.
+ */
+void
+sp_plan_destroy(
+    sp_plan * const plan)
+{
+    free(plan);
+}
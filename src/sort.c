@@ -1,75 +1,1119 @@
+#include <math.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
+
 #include "snackpack/sort.h"
+#include "snackpack/internal/dispatch.h"
+#include "snackpack/internal/sort_internal.h"
+#include "snackpack/internal/threadpool.h"
+#include "snackpack/threads.h"
+
+
+/*
+ * Comparator layers of the 8-key network and of the bitonic merge that
+ * joins two sorted runs of 8. Each pair is (i, j) with i < j; i gets the
+ * smaller key.
+ */
+static const uint8_t sort8_pairs[19][2] = {
+    {0, 2}, {1, 3}, {4, 6}, {5, 7},
+    {0, 4}, {1, 5}, {2, 6}, {3, 7},
+    {0, 1}, {2, 3}, {4, 5}, {6, 7},
+    {2, 4}, {3, 5},
+    {1, 4}, {3, 6},
+    {1, 2}, {3, 4}, {5, 6},
+};
+
+static const uint8_t merge8_pairs[12][2] = {
+    {0, 4}, {1, 5}, {2, 6}, {3, 7},
+    {0, 2}, {1, 3}, {4, 6}, {5, 7},
+    {0, 1}, {2, 3}, {4, 5}, {6, 7},
+};
+
+
+static inline len_t
+min_len(
+    len_t a,
+    len_t b)
+{
+    return a < b ? a : b;
+}
+
+
+static inline void
+compare_exchange(
+    uint32_t * const k,
+    len_t i,
+    len_t j)
+{
+    uint32_t a = k[i];
+    uint32_t b = k[j];
+    k[i] = a < b ? a : b;
+    k[j] = a < b ? b : a;
+}
+
+
+/* Reference sorting network, used where there is no SIMD version. */
+void
+sp_sort16(
+    uint32_t * const keys)
+{
+    for (len_t h = 0; h < 16; h += 8) {
+        for (len_t c = 0; c < 19; c++) {
+            compare_exchange(keys + h, sort8_pairs[c][0], sort8_pairs[c][1]);
+        }
+    }
+    for (len_t i = 0; i < 8; i++) {
+        compare_exchange(keys, i, 15 - i);
+    }
+    for (len_t h = 0; h < 16; h += 8) {
+        for (len_t c = 0; c < 12; c++) {
+            compare_exchange(keys + h, merge8_pairs[c][0], merge8_pairs[c][1]);
+        }
+    }
+}
+
+
+/* Reference partition: a branch-free Lomuto pass. */
+len_t
+sp_sort_partition(
+    uint32_t * const keys,
+    len_t n,
+    uint32_t pivot)
+{
+    len_t m = 0;
+    for (len_t i = 0; i < n; i++) {
+        uint32_t u = keys[i];
+        keys[i] = keys[m];
+        keys[m] = u;
+        m += u < pivot;
+    }
+    return m;
+}
+
+
+/*
+ * Move the NaNs in d to the end and return the number of other entries.
+ * NaN has no place in the order, so it is sorted last either way. The
+ * other entries keep their order. If perm is not NULL it is moved along
+ * with d.
+ */
+static len_t
+move_nans_last(
+    float * const d,
+    len_t * const perm,
+    len_t n)
+{
+    len_t m = 0;
+    for (len_t i = 0; i < n; i++) {
+        if (!isnan(d[i])) {
+            float t = d[m];
+            d[m] = d[i];
+            d[i] = t;
+            if (perm != NULL) {
+                len_t tp = perm[m];
+                perm[m] = perm[i];
+                perm[i] = tp;
+            }
+            m++;
+        }
+    }
+    return m;
+}
+
+
+/* Turn floats into keys in place; see sp_sort_key. */
+static void
+to_keys(
+    sp_sort_key * const k,
+    len_t n,
+    bool is_decreasing)
+{
+    uint32_t flip = is_decreasing ? UINT32_MAX : 0;
+    for (len_t i = 0; i < n; i++) {
+        uint32_t u = k[i];
+        uint32_t sign = (uint32_t)-(int32_t)(u >> 31);
+        k[i] = (u ^ (sign | 0x80000000u)) ^ flip;
+    }
+}
+
+
+static void
+from_keys(
+    sp_sort_key * const k,
+    len_t n,
+    bool is_decreasing)
+{
+    uint32_t flip = is_decreasing ? UINT32_MAX : 0;
+    for (len_t i = 0; i < n; i++) {
+        uint32_t u = k[i] ^ flip;
+        k[i] = u ^ (((u >> 31) - 1u) | 0x80000000u);
+    }
+}
+
+
+/* Sort at most SP_SORT_SMALL keys with the dispatched network. */
+static void
+sort_small(
+    sp_sort_key * const k,
+    len_t n)
+{
+    uint32_t buf[SP_SORT_SMALL];
+
+    if (n < 2) {
+        return;
+    }
+    for (len_t i = 0; i < n; i++) {
+        buf[i] = k[i];
+    }
+    for (len_t i = n; i < SP_SORT_SMALL; i++) {
+        buf[i] = UINT32_MAX;
+    }
+    sp_kernels.sort16(buf);
+    for (len_t i = 0; i < n; i++) {
+        k[i] = buf[i];
+    }
+}
+
+
+static void
+sift_down(
+    sp_sort_key * const k,
+    len_t root,
+    len_t n)
+{
+    uint32_t t = k[root];
+    for (len_t child = 2 * root + 1; child < n; child = 2 * root + 1) {
+        if (child + 1 < n && k[child + 1] > k[child]) {
+            child++;
+        }
+        if (k[child] <= t) {
+            break;
+        }
+        k[root] = k[child];
+        root = child;
+    }
+    k[root] = t;
+}
+
+
+/* Fallback of introsort when quicksort keeps picking bad pivots. */
+static void
+heap_sort(
+    sp_sort_key * const k,
+    len_t n)
+{
+    for (len_t i = n / 2 - 1; i >= 0; i--) {
+        sift_down(k, i, n);
+    }
+    for (len_t i = n - 1; i > 0; i--) {
+        uint32_t t = k[0];
+        k[0] = k[i];
+        k[i] = t;
+        sift_down(k, 0, i);
+    }
+}
+
+
+/* Rounds of partitioning allowed before introsort or introselect give up. */
+static inline len_t
+depth_limit(
+    len_t n)
+{
+    len_t depth = 0;
+    for (len_t m = n; m > 1; m /= 2) {
+        depth += 2;
+    }
+    return depth;
+}
+
+
+/*
+ * Quicksort with a median-of-three pivot and Hoare partitioning. The
+ * smaller side is sorted by recursion and the larger one by the loop, so
+ * the stack depth is O(log n). Once depth runs out the rest is heap
+ * sorted, which bounds the worst case at O(n log n).
+ */
+static void
+intro_sort(
+    sp_sort_key * k,
+    len_t n,
+    len_t depth)
+{
+    while (n > SP_SORT_SMALL) {
+        if (depth-- == 0) {
+            heap_sort(k, n);
+            return;
+        }
+
+        /* Order the first, middle and last keys; the two outer ones are
+         * then sentinels for the scans below.
+         */
+        len_t mid = n / 2;
+        compare_exchange(k, 0, mid);
+        compare_exchange(k, mid, n - 1);
+        compare_exchange(k, 0, mid);
+        uint32_t pivot = k[mid];
+
+        len_t i = 0;
+        len_t j = n - 1;
+        for (;;) {
+            while (k[++i] < pivot) {}
+            while (k[--j] > pivot) {}
+            if (i >= j) {
+                break;
+            }
+            uint32_t t = k[i];
+            k[i] = k[j];
+            k[j] = t;
+        }
+
+        /* [0, j] <= pivot <= [j + 1, n) */
+        len_t left = j + 1;
+        if (left < n - left) {
+            intro_sort(k, left, depth);
+            k += left;
+            n -= left;
+        } else {
+            intro_sort(k + left, n - left, depth);
+            n = left;
+        }
+    }
+    sort_small(k, n);
+}
+
+
+/*
+ * LSD radix sort on bytes, using buf for n keys. The four histograms are
+ * taken in one pass, and a byte that is the same in every key is skipped.
+ * If p is not NULL it is moved along with the keys, using p_buf for n
+ * indices. The sort is stable.
+ */
+static void
+radix_sort(
+    sp_sort_key * const k,
+    len_t * const p,
+    len_t n,
+    uint32_t * const buf,
+    len_t * const p_buf)
+{
+    len_t count[4][256];
+    memset(count, 0, sizeof(count));
+
+    for (len_t i = 0; i < n; i++) {
+        uint32_t u = k[i];
+        count[0][u & 0xff]++;
+        count[1][(u >> 8) & 0xff]++;
+        count[2][(u >> 16) & 0xff]++;
+        count[3][u >> 24]++;
+    }
+
+    sp_sort_key * src = k;
+    sp_sort_key * dst = buf;
+    len_t * src_p = p;
+    len_t * dst_p = p_buf;
+    for (len_t pass = 0; pass < 4; pass++) {
+        len_t shift = 8 * pass;
+        len_t * c = count[pass];
+        if (c[(src[0] >> shift) & 0xff] == n) {
+            continue;
+        }
+
+        len_t sum = 0;
+        for (len_t b = 0; b < 256; b++) {
+            len_t t = c[b];
+            c[b] = sum;
+            sum += t;
+        }
+        if (p == NULL) {
+            for (len_t i = 0; i < n; i++) {
+                uint32_t u = src[i];
+                dst[c[(u >> shift) & 0xff]++] = u;
+            }
+        } else {
+            for (len_t i = 0; i < n; i++) {
+                uint32_t u = src[i];
+                len_t j = c[(u >> shift) & 0xff]++;
+                dst[j] = u;
+                dst_p[j] = src_p[i];
+            }
+            len_t * t = src_p;
+            src_p = dst_p;
+            dst_p = t;
+        }
+
+        sp_sort_key * t = src;
+        src = dst;
+        dst = t;
+    }
+
+    if (src != k) {
+        memcpy(k, src, (size_t)n * sizeof(uint32_t));
+        if (p != NULL) {
+            memcpy(p, src_p, (size_t)n * sizeof(len_t));
+        }
+    }
+}
+
+
+/*
+ * The (key, index) pairs of the sorts that track a permutation are ordered
+ * by key, then index. Indices are unique, so pairs never compare equal and
+ * equal keys keep their order.
+ */
+static inline bool
+pair_less(
+    uint32_t ka,
+    len_t pa,
+    uint32_t kb,
+    len_t pb)
+{
+    return ka < kb || (ka == kb && pa < pb);
+}
+
+
+static inline bool
+pair_less_at(
+    const sp_sort_key * const k,
+    const len_t * const p,
+    len_t i,
+    len_t j)
+{
+    return pair_less(k[i], p[i], k[j], p[j]);
+}
+
+
+static inline void
+swap_pair(
+    sp_sort_key * const k,
+    len_t * const p,
+    len_t i,
+    len_t j)
+{
+    uint32_t t = k[i];
+    k[i] = k[j];
+    k[j] = t;
+    len_t tp = p[i];
+    p[i] = p[j];
+    p[j] = tp;
+}
+
+
+static void
+insertion_sort_perm(
+    sp_sort_key * const k,
+    len_t * const p,
+    len_t n)
+{
+    for (len_t i = 1; i < n; i++) {
+        uint32_t tk = k[i];
+        len_t tp = p[i];
+        len_t j = i;
+        for (; j > 0 && pair_less(tk, tp, k[j - 1], p[j - 1]); j--) {
+            k[j] = k[j - 1];
+            p[j] = p[j - 1];
+        }
+        k[j] = tk;
+        p[j] = tp;
+    }
+}
+
+
+static void
+sift_down_perm(
+    sp_sort_key * const k,
+    len_t * const p,
+    len_t root,
+    len_t n)
+{
+    for (len_t child = 2 * root + 1; child < n; child = 2 * root + 1) {
+        if (child + 1 < n && pair_less_at(k, p, child, child + 1)) {
+            child++;
+        }
+        if (pair_less_at(k, p, child, root)) {
+            break;
+        }
+        swap_pair(k, p, root, child);
+        root = child;
+    }
+}
+
+
+static void
+heap_sort_perm(
+    sp_sort_key * const k,
+    len_t * const p,
+    len_t n)
+{
+    for (len_t i = n / 2 - 1; i >= 0; i--) {
+        sift_down_perm(k, p, i, n);
+    }
+    for (len_t i = n - 1; i > 0; i--) {
+        swap_pair(k, p, 0, i);
+        sift_down_perm(k, p, 0, i);
+    }
+}
+
+
+/* intro_sort on (key, index) pairs; see intro_sort. */
+static void
+intro_sort_perm(
+    sp_sort_key * k,
+    len_t * p,
+    len_t n,
+    len_t depth)
+{
+    while (n > SP_SORT_SMALL) {
+        if (depth-- == 0) {
+            heap_sort_perm(k, p, n);
+            return;
+        }
+
+        len_t mid = n / 2;
+        if (pair_less_at(k, p, mid, 0)) {
+            swap_pair(k, p, 0, mid);
+        }
+        if (pair_less_at(k, p, n - 1, mid)) {
+            swap_pair(k, p, mid, n - 1);
+        }
+        if (pair_less_at(k, p, mid, 0)) {
+            swap_pair(k, p, 0, mid);
+        }
+        uint32_t pk = k[mid];
+        len_t pp = p[mid];
+
+        len_t i = 0;
+        len_t j = n - 1;
+        for (;;) {
+            for (i++; pair_less(k[i], p[i], pk, pp); i++) {}
+            for (j--; pair_less(pk, pp, k[j], p[j]); j--) {}
+            if (i >= j) {
+                break;
+            }
+            swap_pair(k, p, i, j);
+        }
+
+        len_t left = j + 1;
+        if (left < n - left) {
+            intro_sort_perm(k, p, left, depth);
+            k += left;
+            p += left;
+            n -= left;
+        } else {
+            intro_sort_perm(k + left, p + left, n - left, depth);
+            n = left;
+        }
+    }
+    insertion_sort_perm(k, p, n);
+}
+
+
+/*
+ * Sort n keys with the best method for n. If p is not NULL it is permuted
+ * along with the keys, and keys that are equal keep their order.
+ */
+static void
+sort_keys(
+    sp_sort_key * const k,
+    len_t * const p,
+    len_t n)
+{
+    if (n >= SP_SORT_RADIX_MIN) {
+        /* The indices go first, where they are aligned. */
+        size_t size = (size_t)n * sizeof(uint32_t);
+        if (p != NULL) {
+            size += (size_t)n * sizeof(len_t);
+        }
+        len_t * p_buf = malloc(size);
+        if (p_buf != NULL) {
+            len_t * after_p = p == NULL ? p_buf : p_buf + n;
+            uint32_t * buf = (uint32_t *)(void *)after_p;
+            radix_sort(k, p, n, buf, p_buf);
+            free(p_buf);
+            return;
+        }
+    }
+
+    len_t depth = depth_limit(n);
+    if (p == NULL) {
+        intro_sort(k, n, depth);
+    } else {
+        intro_sort_perm(k, p, n, depth);
+    }
+}
+
+
+/*
+ * Rearrange n keys so that k[t] is the key that sorting would put there,
+ * with no larger key before it and no smaller one after it. This is
+ * quickselect with the dispatched partition: one pass splits off the keys
+ * below the pivot, and if t is not among them a second pass splits off
+ * the keys equal to it, so runs of equal keys cannot stall it. Like
+ * intro_sort it gives up after 2 log2(n) rounds, and then sorts what is
+ * left.
+ */
+static void
+select_key(
+    sp_sort_key * k,
+    len_t n,
+    len_t t)
+{
+    len_t depth = depth_limit(n);
+
+    while (n > SP_SORT_SMALL) {
+        if (depth-- == 0) {
+            sort_keys(k, NULL, n);
+            return;
+        }
+
+        /* Median of three, without moving anything. */
+        uint32_t a = k[0];
+        uint32_t b = k[n / 2];
+        uint32_t c = k[n - 1];
+        uint32_t pivot = a < b
+            ? (b < c ? b : (a < c ? c : a))
+            : (a < c ? a : (b < c ? c : b));
+
+        len_t lo = sp_kernels.sort_partition(k, n, pivot);
+        if (t < lo) {
+            n = lo;
+            continue;
+        }
+
+        len_t hi = n;
+        if (pivot != UINT32_MAX) {
+            hi = lo + sp_kernels.sort_partition(k + lo, n - lo, pivot + 1);
+        }
+        if (t < hi) {
+            return;
+        }
+        k += hi;
+        n -= hi;
+        t -= hi;
+    }
+    sort_small(k, n);
+}
+
+
+/*
+ * Parallel sample sort. The keys are split into buckets by splitters taken
+ * from an evenly spaced sample, so bucket b holds the keys k with
+ * splitter[b - 1] <= k < splitter[b]. Each thread converts and counts the
+ * keys of one chunk of d, then copies them to their buckets in buf; the
+ * buckets are then sorted independently and converted back into d. The
+ * bucket slices of d serve as radix sort buffers. Sorted keys determine the
+ * floats exactly, so the result is the same as the sequential sort.
+ */
+typedef struct {
+    float * d;
+    uint32_t * buf;
+    len_t n;
+    bool is_decreasing;
+    len_t chunk;
+    len_t num_chunks;
+    len_t num_buckets;
+    uint32_t splitter[SP_SORT_MAX_BUCKETS];
+    /* Per chunk and bucket: key count, then write offset into buf. */
+    len_t * offset;
+    len_t bucket_start[SP_SORT_MAX_BUCKETS + 1];
+} sample_sort_args;
+
+
+/* Branch-free search for the bucket of u; num_buckets is a power of 2. */
+static inline len_t
+bucket_of(
+    const sample_sort_args * const args,
+    uint32_t u)
+{
+    len_t b = 0;
+    for (len_t step = args->num_buckets / 2; step > 0; step /= 2) {
+        b += args->splitter[b + step - 1] <= u ? step : 0;
+    }
+    return b;
+}
+
+
+static void
+sample_count_task(
+    void * arg,
+    len_t begin,
+    len_t end)
+{
+    sample_sort_args * args = arg;
+    for (len_t c = begin; c < end; c++) {
+        len_t first = c * args->chunk;
+        len_t len = min_len(args->chunk, args->n - first);
+        sp_sort_key * k = (sp_sort_key *)args->d + first;
+        len_t * count = args->offset + c * args->num_buckets;
+
+        to_keys(k, len, args->is_decreasing);
+        for (len_t i = 0; i < len; i++) {
+            count[bucket_of(args, k[i])]++;
+        }
+    }
+}
+
+
+static void
+sample_scatter_task(
+    void * arg,
+    len_t begin,
+    len_t end)
+{
+    sample_sort_args * args = arg;
+    for (len_t c = begin; c < end; c++) {
+        len_t first = c * args->chunk;
+        len_t len = min_len(args->chunk, args->n - first);
+        const sp_sort_key * k = (const sp_sort_key *)args->d + first;
+        len_t * offset = args->offset + c * args->num_buckets;
+
+        for (len_t i = 0; i < len; i++) {
+            uint32_t u = k[i];
+            args->buf[offset[bucket_of(args, u)]++] = u;
+        }
+    }
+}
+
+
+static void
+sample_bucket_task(
+    void * arg,
+    len_t begin,
+    len_t end)
+{
+    sample_sort_args * args = arg;
+    for (len_t b = begin; b < end; b++) {
+        len_t first = args->bucket_start[b];
+        len_t len = args->bucket_start[b + 1] - first;
+        sp_sort_key * k = args->buf + first;
+        sp_sort_key * d = (sp_sort_key *)args->d + first;
+
+        if (len >= SP_SORT_RADIX_MIN) {
+            radix_sort(k, NULL, len, d, NULL);
+        } else {
+            intro_sort(k, len, depth_limit(len));
+        }
+        from_keys(k, len, args->is_decreasing);
+        memcpy(d, k, (size_t)len * sizeof(uint32_t));
+    }
+}
 
 
-/* These are used to implement the LAPACK slasrt sorting function. No custom
- * types here because this is a standard-library prototype.
+/*
+ * Sort n floats, none of them NaN, on the thread pool. Returns false
+ * without touching d if the buffers cannot be allocated.
  */
-static int sort_increase(const void * const p1, const void * const p2);
-static int sort_decrease(const void * const p1, const void * const p2);
+static bool
+parallel_sort(
+    float * const d,
+    len_t n,
+    bool is_decreasing,
+    len_t num_threads)
+{
+    sample_sort_args args = {
+        .d = d,
+        .n = n,
+        .is_decreasing = is_decreasing,
+        .chunk = (n + num_threads - 1) / num_threads,
+        .num_buckets = 1,
+    };
+    args.num_chunks = (n + args.chunk - 1) / args.chunk;
+    while (args.num_buckets < SP_SORT_BUCKETS_PER_THREAD * num_threads
+            && args.num_buckets < SP_SORT_MAX_BUCKETS) {
+        args.num_buckets *= 2;
+    }
+
+    len_t num_samples = SP_SORT_OVERSAMPLE * args.num_buckets;
+    args.buf = malloc((size_t)n * sizeof(uint32_t));
+    args.offset = calloc(
+        (size_t)args.num_chunks * (size_t)args.num_buckets, sizeof(len_t));
+    uint32_t * sample = malloc((size_t)num_samples * sizeof(uint32_t));
+    if (args.buf == NULL || args.offset == NULL || sample == NULL) {
+        free(args.buf);
+        free(args.offset);
+        free(sample);
+        return false;
+    }
+
+    for (len_t i = 0; i < num_samples; i++) {
+        memcpy(sample + i,
+            d + (len_t)((int64_t)n * (2 * i + 1) / (2 * num_samples)),
+            sizeof(uint32_t));
+    }
+    to_keys(sample, num_samples, is_decreasing);
+    intro_sort(sample, num_samples, depth_limit(num_samples));
+    for (len_t b = 0; b < args.num_buckets - 1; b++) {
+        args.splitter[b] = sample[(b + 1) * SP_SORT_OVERSAMPLE];
+    }
+    free(sample);
+
+    sp_parallel_for(args.num_chunks, 1, sample_count_task, &args);
+
+    /* Turn the counts into offsets, bucket by bucket. */
+    len_t sum = 0;
+    for (len_t b = 0; b < args.num_buckets; b++) {
+        args.bucket_start[b] = sum;
+        for (len_t c = 0; c < args.num_chunks; c++) {
+            len_t * offset = args.offset + c * args.num_buckets + b;
+            len_t t = *offset;
+            *offset = sum;
+            sum += t;
+        }
+    }
+    args.bucket_start[args.num_buckets] = n;
+
+    sp_parallel_for(args.num_chunks, 1, sample_scatter_task, &args);
+    sp_parallel_for(args.num_buckets, 1, sample_bucket_task, &args);
+
+    free(args.buf);
+    free(args.offset);
+    return true;
+}
 
 
 /**
  * Sort an array in increasing or decreasing order.
  *
+ * \param[in] id        'I' to sort in increasing order, 'D' for decreasing
+ * \param[in] n         Length of d
+ * \param[in,out] d     Array to sort
+ * \returns             SP_STATUS_OK, SP_STATUS_ERROR if id is invalid or
+ *                      SP_STATUS_INVALID_DIM if n is not positive
+ *
  * Note that the documentation for this in the reference LAPACK says
  * something about returning the index of an "illegal value" on error, but
  * this doesn't appear to be true. The values of the return SP_STATUS enum
  * correspond to what the LAPACK function actually returns.
+ *
+ * The floats are mapped in place to integer keys with the same order, so
+ * -0.0 sorts before +0.0 in increasing order. NaNs are moved to the end
+ * first, in either order. Arrays of at least SP_SORT_RADIX_MIN entries are
+ * radix sorted; shorter ones go through introsort, whose partitions of up
+ * to SP_SORT_SMALL keys are finished by a SIMD sorting network. From
+ * SP_SORT_PARALLEL_MIN entries on, a sample sort splits the work across the
+ * thread pool; the result is the same.
  */
 SP_STATUS
 sp_slasrt(
     char id,
     len_t n,
-    float_t * const d)
+    float * const d)
 {
-    if (n == 0) {
+    if (id != 'I' && id != 'D') {
+        return SP_STATUS_ERROR;
+    } else if (n <= 0) {
         return SP_STATUS_INVALID_DIM;
     } else if (n == 1) {
         /* Nothing to do */
         return SP_STATUS_OK;
     }
 
-    switch (id) {
-        case 'I':
-            qsort(d, n, sizeof(float_t), sort_increase);
-            return  SP_STATUS_OK;
-            break;
-        case 'D':
-            qsort(d, n, sizeof(float_t), sort_decrease);
-            return  SP_STATUS_OK;
-            break;
-        default:
-            return SP_STATUS_ERROR;
+    bool is_decreasing = id == 'D';
+    len_t m = move_nans_last(d, NULL, n);
+
+    if (m >= SP_SORT_PARALLEL_MIN) {
+        len_t num_threads = sp_get_num_threads();
+        if (num_threads > 1
+                && parallel_sort(d, m, is_decreasing, num_threads)) {
+            return SP_STATUS_OK;
+        }
     }
+
+    sp_sort_key * k = (sp_sort_key *)d;
+    to_keys(k, m, is_decreasing);
+    sort_keys(k, NULL, m);
+    from_keys(k, m, is_decreasing);
+
+    return SP_STATUS_OK;
 }
 
 
-static int
-sort_increase(
-    const void * const p1,
-    const void * const p2)
+/**
+ * Sort an array and return the permutation that sorts it.
+ *
+ * \param[in] id        'I' to sort in increasing order, 'D' for decreasing
+ * \param[in] n         Length of d and perm
+ * \param[in,out] d     Array to sort
+ * \param[out] perm     On exit, the sorted d[i] is the input d[perm[i]]
+ * \returns             The same codes as sp_slasrt
+ *
+ * d ends up in the same order as with sp_slasrt. Equal entries keep their
+ * input order, so perm does not depend on which sort was used.
+ */
+SP_STATUS
+sp_slasrt_perm(
+    char id,
+    len_t n,
+    float * const d,
+    len_t * const perm)
 {
-    if (*(float_t *)p1 < *(float_t *)p2) {
-        return -1;
-    } else if (*(float_t *)p1 > *(float_t *)p2) {
-        return 1;
-    } else {
-        return 0;
+    if (id != 'I' && id != 'D') {
+        return SP_STATUS_ERROR;
+    } else if (n <= 0) {
+        return SP_STATUS_INVALID_DIM;
+    }
+
+    for (len_t i = 0; i < n; i++) {
+        perm[i] = i;
     }
+
+    bool is_decreasing = id == 'D';
+    len_t m = move_nans_last(d, perm, n);
+    sp_sort_key * k = (sp_sort_key *)d;
+
+    to_keys(k, m, is_decreasing);
+    sort_keys(k, perm, m);
+    from_keys(k, m, is_decreasing);
+
+    return SP_STATUS_OK;
 }
 
 
-static int
-sort_decrease(
-    const void * const p1,
-    const void * const p2)
+/*
+ * Rows of A moved per sweep over the cycles of the permutation in
+ * sp_slapmt. Each move copies a contiguous piece of a column this long.
+ */
+#define SP_SLAPMT_ROWS (256)
+
+
+/**
+ * Permute the columns of a matrix in place.
+ *
+ * \param[in] is_forward    If true, column j of the result is column perm[j]
+ *                          of A. If false, column j of A becomes column
+ *                          perm[j] of the result.
+ * \param[in] rows          Number of rows of A
+ * \param[in] n             Number of columns of A and length of perm
+ * \param[in,out] A         Column-major matrix
+ * \param[in] lda           Leading dimension of A
+ * \param[in,out] perm      A permutation of 0 .. n - 1. It is used to mark
+ *                          visited columns and restored on exit.
+ * \returns                 SP_STATUS_OK, SP_STATUS_INVALID_DIM if rows is
+ *                          negative or n is not positive, or
+ *                          SP_STATUS_ERROR if lda < max(1, rows)
+ *
+ * Each cycle of the permutation is followed once, so every column is moved
+ * once and only one column is held aside. Tall matrices are done in strips
+ * of SP_SLAPMT_ROWS rows. A vector with stride inc is a matrix with one row
+ * and lda = inc.
+ *
+ * This is LAPACK slapmt with 0-based indices.
+ */
+SP_STATUS
+sp_slapmt(
+    bool is_forward,
+    len_t rows,
+    len_t n,
+    float * const A,
+    len_t lda,
+    len_t * const perm)
 {
-    if (*(float_t *)p1 < *(float_t *)p2) {
-        return 1;
-    } else if (*(float_t *)p1 > *(float_t *)p2) {
-        return -1;
-    } else {
-        return 0;
+    float tmp[SP_SLAPMT_ROWS];
+
+    if (rows < 0 || n <= 0) {
+        return SP_STATUS_INVALID_DIM;
+    } else if (lda < 1 || lda < rows) {
+        return SP_STATUS_ERROR;
+    }
+
+    for (len_t r = 0; r < rows; r += SP_SLAPMT_ROWS) {
+        len_t nr = rows - r < SP_SLAPMT_ROWS ? rows - r : SP_SLAPMT_ROWS;
+        size_t bytes = (size_t)nr * sizeof(float);
+        float * const B = A + r;
+
+        /* Visited entries of perm are marked by flipping their bits. */
+        for (len_t i = 0; i < n; i++) {
+            if (perm[i] < 0) {
+                continue;
+            } else if (perm[i] == i) {
+                perm[i] = ~i;
+                continue;
+            }
+
+            memcpy(tmp, B + (ptrdiff_t)i * lda, bytes);
+            if (is_forward) {
+                len_t j = i;
+                for (;;) {
+                    len_t next = perm[j];
+                    perm[j] = ~next;
+                    if (next == i) {
+                        break;
+                    }
+                    memcpy(B + (ptrdiff_t)j * lda, B + (ptrdiff_t)next * lda,
+                        bytes);
+                    j = next;
+                }
+                memcpy(B + (ptrdiff_t)j * lda, tmp, bytes);
+            } else {
+                len_t j = perm[i];
+                perm[i] = ~j;
+                while (j != i) {
+                    float * const col = B + (ptrdiff_t)j * lda;
+                    for (len_t l = 0; l < nr; l++) {
+                        float t = col[l];
+                        col[l] = tmp[l];
+                        tmp[l] = t;
+                    }
+                    len_t next = perm[j];
+                    perm[j] = ~next;
+                    j = next;
+                }
+                memcpy(B + (ptrdiff_t)i * lda, tmp, bytes);
+            }
+        }
+
+        for (len_t i = 0; i < n; i++) {
+            perm[i] = ~perm[i];
+        }
+    }
+
+    return SP_STATUS_OK;
+}
+
+
+/**
+ * Sort an array and apply the same permutation to the columns of a matrix.
+ *
+ * \param[in] id        'I' to sort in increasing order, 'D' for decreasing
+ * \param[in] n         Length of d and number of columns of A
+ * \param[in,out] d     Array to sort
+ * \param[in] rows      Number of rows of A
+ * \param[in,out] A     Column-major matrix whose columns go with d
+ * \param[in] lda       Leading dimension of A
+ * \returns             The codes of sp_slasrt and sp_slapmt.
+ *                      SP_STATUS_ERROR is also returned if the permutation
+ *                      cannot be allocated, in which case d and A are
+ *                      unchanged.
+ *
+ * This is for sorting eigenvalues or singular values together with their
+ * vectors. Several companion arrays of length n can be stored as the rows
+ * of A. d is sorted as by sp_slasrt_perm, and the columns are then moved
+ * in one pass of sp_slapmt.
+ */
+SP_STATUS
+sp_slasrt_cols(
+    char id,
+    len_t n,
+    float * const d,
+    len_t rows,
+    float * const A,
+    len_t lda)
+{
+    if (id != 'I' && id != 'D') {
+        return SP_STATUS_ERROR;
+    } else if (n <= 0 || rows < 0) {
+        return SP_STATUS_INVALID_DIM;
+    } else if (lda < 1 || lda < rows) {
+        return SP_STATUS_ERROR;
     }
+
+    len_t * perm = malloc((size_t)n * sizeof(len_t));
+    if (perm == NULL) {
+        return SP_STATUS_ERROR;
+    }
+
+    SP_STATUS status = sp_slasrt_perm(id, n, d, perm);
+    if (status == SP_STATUS_OK) {
+        status = sp_slapmt(true, rows, n, A, lda, perm);
+    }
+
+    free(perm);
+    return status;
+}
+
+
+/**
+ * Partially sort an array so that its k smallest or largest entries come
+ * first, in order.
+ *
+ * \param[in] id        'I' for the k smallest entries in increasing order,
+ *                      'D' for the k largest in decreasing order
+ * \param[in] k         Number of entries to sort, 0 <= k <= n
+ * \param[in] n         Length of d
+ * \param[in,out] d     Array to partially sort. On exit d[0 .. k) is what
+ *                      sp_slasrt would put there. The rest of d holds the
+ *                      other entries in no particular order.
+ * \returns             The codes of sp_slasrt, and SP_STATUS_ERROR if k is
+ *                      out of range
+ *
+ * This selects the k-th entry and sorts the ones before it, which takes
+ * O(n + k log k) time instead of O(n log n).
+ */
+SP_STATUS
+sp_slasrt_topk(
+    char id,
+    len_t k,
+    len_t n,
+    float * const d)
+{
+    if (id != 'I' && id != 'D') {
+        return SP_STATUS_ERROR;
+    } else if (n <= 0) {
+        return SP_STATUS_INVALID_DIM;
+    } else if (k < 0 || k > n) {
+        return SP_STATUS_ERROR;
+    } else if (k == 0) {
+        return SP_STATUS_OK;
+    }
+
+    bool is_decreasing = id == 'D';
+    len_t m = move_nans_last(d, NULL, n);
+    sp_sort_key * keys = (sp_sort_key *)d;
+    len_t len = k < m ? k : m;
+
+    to_keys(keys, m, is_decreasing);
+    if (len < m) {
+        select_key(keys, m, len - 1);
+    }
+    sort_keys(keys, NULL, len);
+    from_keys(keys, m, is_decreasing);
+
+    return SP_STATUS_OK;
+}
+
+
+/**
+ * Find the k-th entry of an array in sorted order.
+ *
+ * \param[in] id        'I' for increasing order, 'D' for decreasing
+ * \param[in] k         Index of the entry to find, 0 <= k < n
+ * \param[in] n         Length of d
+ * \param[in,out] d     Array to select from. On exit d[k] is what sp_slasrt
+ *                      would put there, no entry before it comes after it
+ *                      in that order and no entry after it comes before it.
+ * \returns             The codes of sp_slasrt, and SP_STATUS_ERROR if k is
+ *                      out of range
+ *
+ * This is C++ std::nth_element for floats, with the order and NaN placement
+ * of sp_slasrt. It takes O(n) time on average. For example, the median of
+ * an odd-length array is d[n / 2] after sp_sselect('I', n / 2, n, d).
+ */
+SP_STATUS
+sp_sselect(
+    char id,
+    len_t k,
+    len_t n,
+    float * const d)
+{
+    if (id != 'I' && id != 'D') {
+        return SP_STATUS_ERROR;
+    } else if (n <= 0) {
+        return SP_STATUS_INVALID_DIM;
+    } else if (k < 0 || k >= n) {
+        return SP_STATUS_ERROR;
+    }
+
+    bool is_decreasing = id == 'D';
+    len_t m = move_nans_last(d, NULL, n);
+    sp_sort_key * keys = (sp_sort_key *)d;
+
+    if (k < m) {
+        to_keys(keys, m, is_decreasing);
+        select_key(keys, m, k);
+        from_keys(keys, m, is_decreasing);
+    }
+
+    return SP_STATUS_OK;
 }
@@ -0,0 +1,216 @@
+/*
+ * AVX2 version of the small sorting network. This file is compiled with
+ * -mavx2 -mfma.
+ */
+#if defined(__AVX2__)
+
+#include <immintrin.h>
+
+#include "snackpack/snackpack.h"
+#include "snackpack/internal/sort_internal.h"
+#include "snackpack/internal/sort_simd.h"
+
+
+/*
+ * One layer of comparators on the 8 keys in v. Lane i is compared with
+ * lane perm[i]; the lanes set in take_max keep the larger key and the
+ * others the smaller one.
+ */
+static inline __m256i
+layer(
+    __m256i v,
+    __m256i perm,
+    __m256i take_max)
+{
+    __m256i w = _mm256_permutevar8x32_epi32(v, perm);
+    return _mm256_blendv_epi8(
+        _mm256_min_epu32(v, w), _mm256_max_epu32(v, w), take_max);
+}
+
+
+#define PERM(a, b, c, d, e, f, g, h) _mm256_setr_epi32(a, b, c, d, e, f, g, h)
+#define MASK(a, b, c, d, e, f, g, h) \
+    _mm256_setr_epi32(-a, -b, -c, -d, -e, -f, -g, -h)
+
+
+/* The 19-comparator network for 8 keys, in 6 layers. */
+static inline __m256i
+sort8(__m256i v)
+{
+    v = layer(v, PERM(2, 3, 0, 1, 6, 7, 4, 5), MASK(0, 0, 1, 1, 0, 0, 1, 1));
+    v = layer(v, PERM(4, 5, 6, 7, 0, 1, 2, 3), MASK(0, 0, 0, 0, 1, 1, 1, 1));
+    v = layer(v, PERM(1, 0, 3, 2, 5, 4, 7, 6), MASK(0, 1, 0, 1, 0, 1, 0, 1));
+    v = layer(v, PERM(0, 1, 4, 5, 2, 3, 6, 7), MASK(0, 0, 0, 0, 1, 1, 0, 0));
+    v = layer(v, PERM(0, 4, 2, 6, 1, 5, 3, 7), MASK(0, 0, 0, 0, 1, 0, 1, 0));
+    v = layer(v, PERM(0, 2, 1, 4, 3, 6, 5, 7), MASK(0, 0, 1, 0, 1, 0, 1, 0));
+    return v;
+}
+
+
+/* Sort a bitonic sequence of 8 keys. */
+static inline __m256i
+merge8(__m256i v)
+{
+    v = layer(v, PERM(4, 5, 6, 7, 0, 1, 2, 3), MASK(0, 0, 0, 0, 1, 1, 1, 1));
+    v = layer(v, PERM(2, 3, 0, 1, 6, 7, 4, 5), MASK(0, 0, 1, 1, 0, 0, 1, 1));
+    v = layer(v, PERM(1, 0, 3, 2, 5, 4, 7, 6), MASK(0, 1, 0, 1, 0, 1, 0, 1));
+    return v;
+}
+
+
+void
+sp_sort16_avx2(
+    uint32_t * const keys)
+{
+    __m256i a = sort8(_mm256_loadu_si256((const __m256i *)keys));
+    __m256i b = sort8(_mm256_loadu_si256((const __m256i *)(keys + 8)));
+
+    /* a followed by b reversed is bitonic; split it into the lower and
+     * upper halves, each of which is bitonic again.
+     */
+    b = _mm256_permutevar8x32_epi32(b, PERM(7, 6, 5, 4, 3, 2, 1, 0));
+    __m256i lo = _mm256_min_epu32(a, b);
+    __m256i hi = _mm256_max_epu32(a, b);
+
+    _mm256_storeu_si256((__m256i *)keys, merge8(lo));
+    _mm256_storeu_si256((__m256i *)(keys + 8), merge8(hi));
+}
+
+
+/*
+ * For each 8-bit mask of the lanes below the pivot, the lanes in the order
+ * that puts those first, one source lane per nibble.
+ */
+static const uint32_t partition_lut[256] = {
+    0x76543210, 0x76543210, 0x76543201, 0x76543210, 0x76543102, 0x76543120,
+    0x76543021, 0x76543210, 0x76542103, 0x76542130, 0x76542031, 0x76542310,
+    0x76541032, 0x76541320, 0x76540321, 0x76543210, 0x76532104, 0x76532140,
+    0x76532041, 0x76532410, 0x76531042, 0x76531420, 0x76530421, 0x76534210,
+    0x76521043, 0x76521430, 0x76520431, 0x76524310, 0x76510432, 0x76514320,
+    0x76504321, 0x76543210, 0x76432105, 0x76432150, 0x76432051, 0x76432510,
+    0x76431052, 0x76431520, 0x76430521, 0x76435210, 0x76421053, 0x76421530,
+    0x76420531, 0x76425310, 0x76410532, 0x76415320, 0x76405321, 0x76453210,
+    0x76321054, 0x76321540, 0x76320541, 0x76325410, 0x76310542, 0x76315420,
+    0x76305421, 0x76354210, 0x76210543, 0x76215430, 0x76205431, 0x76254310,
+    0x76105432, 0x76154320, 0x76054321, 0x76543210, 0x75432106, 0x75432160,
+    0x75432061, 0x75432610, 0x75431062, 0x75431620, 0x75430621, 0x75436210,
+    0x75421063, 0x75421630, 0x75420631, 0x75426310, 0x75410632, 0x75416320,
+    0x75406321, 0x75463210, 0x75321064, 0x75321640, 0x75320641, 0x75326410,
+    0x75310642, 0x75316420, 0x75306421, 0x75364210, 0x75210643, 0x75216430,
+    0x75206431, 0x75264310, 0x75106432, 0x75164320, 0x75064321, 0x75643210,
+    0x74321065, 0x74321650, 0x74320651, 0x74326510, 0x74310652, 0x74316520,
+    0x74306521, 0x74365210, 0x74210653, 0x74216530, 0x74206531, 0x74265310,
+    0x74106532, 0x74165320, 0x74065321, 0x74653210, 0x73210654, 0x73216540,
+    0x73206541, 0x73265410, 0x73106542, 0x73165420, 0x73065421, 0x73654210,
+    0x72106543, 0x72165430, 0x72065431, 0x72654310, 0x71065432, 0x71654320,
+    0x70654321, 0x76543210, 0x65432107, 0x65432170, 0x65432071, 0x65432710,
+    0x65431072, 0x65431720, 0x65430721, 0x65437210, 0x65421073, 0x65421730,
+    0x65420731, 0x65427310, 0x65410732, 0x65417320, 0x65407321, 0x65473210,
+    0x65321074, 0x65321740, 0x65320741, 0x65327410, 0x65310742, 0x65317420,
+    0x65307421, 0x65374210, 0x65210743, 0x65217430, 0x65207431, 0x65274310,
+    0x65107432, 0x65174320, 0x65074321, 0x65743210, 0x64321075, 0x64321750,
+    0x64320751, 0x64327510, 0x64310752, 0x64317520, 0x64307521, 0x64375210,
+    0x64210753, 0x64217530, 0x64207531, 0x64275310, 0x64107532, 0x64175320,
+    0x64075321, 0x64753210, 0x63210754, 0x63217540, 0x63207541, 0x63275410,
+    0x63107542, 0x63175420, 0x63075421, 0x63754210, 0x62107543, 0x62175430,
+    0x62075431, 0x62754310, 0x61075432, 0x61754320, 0x60754321, 0x67543210,
+    0x54321076, 0x54321760, 0x54320761, 0x54327610, 0x54310762, 0x54317620,
+    0x54307621, 0x54376210, 0x54210763, 0x54217630, 0x54207631, 0x54276310,
+    0x54107632, 0x54176320, 0x54076321, 0x54763210, 0x53210764, 0x53217640,
+    0x53207641, 0x53276410, 0x53107642, 0x53176420, 0x53076421, 0x53764210,
+    0x52107643, 0x52176430, 0x52076431, 0x52764310, 0x51076432, 0x51764320,
+    0x50764321, 0x57643210, 0x43210765, 0x43217650, 0x43207651, 0x43276510,
+    0x43107652, 0x43176520, 0x43076521, 0x43765210, 0x42107653, 0x42176530,
+    0x42076531, 0x42765310, 0x41076532, 0x41765320, 0x40765321, 0x47653210,
+    0x32107654, 0x32176540, 0x32076541, 0x32765410, 0x31076542, 0x31765420,
+    0x30765421, 0x37654210, 0x21076543, 0x21765430, 0x20765431, 0x27654310,
+    0x10765432, 0x17654320, 0x07654321, 0x76543210,
+};
+
+
+/*
+ * Reorder the 8 keys in v so that the ones below pivot come first, and
+ * return how many there are.
+ */
+static inline __m256i
+compress8(
+    __m256i v,
+    __m256i pivot,
+    len_t * const count)
+{
+    __m256i ge = _mm256_cmpeq_epi32(_mm256_max_epu32(v, pivot), v);
+    uint32_t less = ~(uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(ge))
+        & 0xffu;
+    __m256i perm = _mm256_and_si256(
+        _mm256_srlv_epi32(_mm256_set1_epi32((int)partition_lut[less]),
+            PERM(0, 4, 8, 12, 16, 20, 24, 28)),
+        _mm256_set1_epi32(0xf));
+    *count = __builtin_popcount(less);
+    return _mm256_permutevar8x32_epi32(v, perm);
+}
+
+
+/*
+ * In-place partition. The first and last 8 keys are held in registers, so
+ * there are always at least 8 free slots at whichever end is written, and
+ * every block of 8 is stored whole at both ends: the keys below the pivot
+ * are kept at the left and the others at the right.
+ */
+len_t
+sp_sort_partition_avx2(
+    uint32_t * const keys,
+    len_t n,
+    uint32_t pivot)
+{
+    uint32_t tail[24];
+
+    if (n < 16) {
+        return sp_sort_partition(keys, n, pivot);
+    }
+
+    __m256i p = _mm256_set1_epi32((int)pivot);
+    __m256i first = _mm256_loadu_si256((const __m256i *)keys);
+    __m256i last = _mm256_loadu_si256((const __m256i *)(keys + n - 8));
+
+    len_t read_l = 8;
+    len_t read_r = n - 8;
+    len_t write_l = 0;
+    len_t write_r = n;
+    while (read_r - read_l >= 8) {
+        __m256i v;
+        if (read_l - write_l <= write_r - read_r) {
+            v = _mm256_loadu_si256((const __m256i *)(keys + read_l));
+            read_l += 8;
+        } else {
+            read_r -= 8;
+            v = _mm256_loadu_si256((const __m256i *)(keys + read_r));
+        }
+
+        len_t count;
+        v = compress8(v, p, &count);
+        _mm256_storeu_si256((__m256i *)(keys + write_l), v);
+        _mm256_storeu_si256((__m256i *)(keys + write_r - 8), v);
+        write_l += count;
+        write_r -= 8 - count;
+    }
+
+    /* The rest, plus the two held blocks, fill the gap exactly. */
+    len_t rest = read_r - read_l;
+    _mm256_storeu_si256((__m256i *)tail, first);
+    _mm256_storeu_si256((__m256i *)(tail + 8), last);
+    for (len_t i = 0; i < rest; i++) {
+        tail[16 + i] = keys[read_l + i];
+    }
+    for (len_t i = 0; i < 16 + rest; i++) {
+        if (tail[i] < pivot) {
+            keys[write_l++] = tail[i];
+        } else {
+            keys[--write_r] = tail[i];
+        }
+    }
+
+    return write_l;
+}
+
+
+#endif
@@ -0,0 +1,477 @@
+/* Needed for pthread_setaffinity_np, sched_getaffinity and CPU_*. */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "snackpack/threads.h"
+#include "snackpack/internal/threadpool.h"
+
+
+/*
+ * Number of times an idle thread polls for new work before it goes to
+ * sleep on a condition variable (which is a futex wait on Linux). Back-to-
+ * back parallel calls are then picked up without a system call.
+ */
+#ifndef SP_SPIN_COUNT
+#define SP_SPIN_COUNT (4096)
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SP_CPU_RELAX() __builtin_ia32_pause()
+#else
+#define SP_CPU_RELAX() do {} while (0)
+#endif
+
+
+/*
+ * One call to sp_parallel_for. This lives on the stack of the calling
+ * thread, which does not return until every worker has checked in, so
+ * workers never see a stale job.
+ */
+typedef struct {
+    sp_task_fn fn;
+    void * arg;
+    len_t n;
+    len_t num_ranges;
+    len_t next_range;
+    len_t num_finished;
+} sp_job;
+
+
+/*
+ * Pool state. submit_lock is held by the thread running a job (and while
+ * the workers are started or stopped), so everything apart from the
+ * atomics is only written under it.
+ */
+static struct {
+    pthread_mutex_t submit_lock;
+    pthread_mutex_t wake_lock;
+    pthread_cond_t wake_cond;
+    pthread_mutex_t done_lock;
+    pthread_cond_t done_cond;
+
+    pthread_t workers[SP_MAX_THREADS];
+    len_t num_workers;
+
+    /* Requested threads including the caller, 0 for the default. */
+    len_t num_threads;
+    len_t default_num_threads;
+    bool is_pinned;
+    bool is_shutdown;
+
+#ifdef __linux__
+    /* CPUs the process may run on, read when the workers are started. */
+    cpu_set_t cpus;
+#endif
+
+    sp_job * job;
+    unsigned generation;
+    unsigned start_generation;
+    unsigned num_sleepers;
+} pool = {
+    .submit_lock = PTHREAD_MUTEX_INITIALIZER,
+    .wake_lock = PTHREAD_MUTEX_INITIALIZER,
+    .wake_cond = PTHREAD_COND_INITIALIZER,
+    .done_lock = PTHREAD_MUTEX_INITIALIZER,
+    .done_cond = PTHREAD_COND_INITIALIZER,
+};
+
+
+/* True on pool workers, and on a caller while it runs its share of a job. */
+static __thread bool in_parallel = false;
+
+/* True on a thread that locked submit_lock in the fork prepare handler. */
+static __thread bool is_fork_locked = false;
+
+
+/* Number of CPUs the process may run on. */
+static long
+num_allowed_cpus(void)
+{
+#ifdef __linux__
+    cpu_set_t set;
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        return CPU_COUNT(&set);
+    }
+#endif
+    return sysconf(_SC_NPROCESSORS_ONLN);
+}
+
+
+/*
+ * Threads to use when none were requested through sp_set_num_threads. This
+ * is read once, when the library is loaded.
+ */
+static len_t
+default_num_threads(void)
+{
+    const char * env = getenv("SNACKPACK_NUM_THREADS");
+    long n = env != NULL ? atol(env) : 0;
+    if (n <= 0) {
+        n = num_allowed_cpus();
+    }
+    if (n < 1) {
+        n = 1;
+    } else if (n > SP_MAX_THREADS) {
+        n = SP_MAX_THREADS;
+    }
+    return (len_t)n;
+}
+
+
+/* Claim and run ranges of the job until there are none left. */
+static void
+run_ranges(
+    sp_job * const job)
+{
+    for (;;) {
+        len_t r = __atomic_fetch_add(&job->next_range, 1, __ATOMIC_RELAXED);
+        if (r >= job->num_ranges) {
+            break;
+        }
+        len_t begin = (len_t)((int64_t)job->n * r / job->num_ranges);
+        len_t end = (len_t)((int64_t)job->n * (r + 1) / job->num_ranges);
+        job->fn(job->arg, begin, end);
+    }
+}
+
+
+/* Block until the generation counter moves past seen. */
+static unsigned
+wait_for_job(
+    unsigned seen)
+{
+    unsigned gen;
+
+    for (len_t i = 0; i < SP_SPIN_COUNT; i++) {
+        gen = __atomic_load_n(&pool.generation, __ATOMIC_ACQUIRE);
+        if (gen != seen) {
+            return gen;
+        }
+        SP_CPU_RELAX();
+    }
+
+    pthread_mutex_lock(&pool.wake_lock);
+    __atomic_add_fetch(&pool.num_sleepers, 1, __ATOMIC_SEQ_CST);
+    while ((gen = __atomic_load_n(&pool.generation, __ATOMIC_SEQ_CST))
+            == seen) {
+        pthread_cond_wait(&pool.wake_cond, &pool.wake_lock);
+    }
+    __atomic_sub_fetch(&pool.num_sleepers, 1, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&pool.wake_lock);
+    return gen;
+}
+
+
+static void *
+worker_main(
+    void * const p)
+{
+    len_t id = (len_t)(intptr_t)p;
+    unsigned seen = pool.start_generation;
+
+    in_parallel = true;
+
+#ifdef __linux__
+    /* Worker id goes to allowed CPU id + 1, counting round the set. */
+    int num_cpus = CPU_COUNT(&pool.cpus);
+    if (pool.is_pinned && num_cpus > 0) {
+        int target = (int)((id + 1) % num_cpus);
+        for (size_t cpu = 0; cpu < (size_t)CPU_SETSIZE; cpu++) {
+            if (CPU_ISSET(cpu, &pool.cpus) && target-- == 0) {
+                cpu_set_t set;
+                CPU_ZERO(&set);
+                CPU_SET(cpu, &set);
+                pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+                break;
+            }
+        }
+    }
+#endif
+
+    for (;;) {
+        seen = wait_for_job(seen);
+        if (pool.is_shutdown) {
+            break;
+        }
+
+        sp_job * job = __atomic_load_n(&pool.job, __ATOMIC_ACQUIRE);
+        run_ranges(job);
+
+        /* The job may go out of scope as soon as the last worker checks
+         * in, so it must not be touched after this.
+         */
+        len_t num_workers = pool.num_workers;
+        if (__atomic_add_fetch(&job->num_finished, 1, __ATOMIC_ACQ_REL)
+                == num_workers) {
+            pthread_mutex_lock(&pool.done_lock);
+            pthread_cond_signal(&pool.done_cond);
+            pthread_mutex_unlock(&pool.done_lock);
+        }
+    }
+    return NULL;
+}
+
+
+/* Wake the workers for a new generation. Called with submit_lock held. */
+static void
+publish(
+    sp_job * const job)
+{
+    __atomic_store_n(&pool.job, job, __ATOMIC_RELEASE);
+    __atomic_add_fetch(&pool.generation, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&pool.num_sleepers, __ATOMIC_SEQ_CST) > 0) {
+        pthread_mutex_lock(&pool.wake_lock);
+        pthread_cond_broadcast(&pool.wake_cond);
+        pthread_mutex_unlock(&pool.wake_lock);
+    }
+}
+
+
+/* Start the workers. Called with submit_lock held. */
+static void
+start_workers(void)
+{
+    len_t num_threads = pool.num_threads > 0 ?
+        pool.num_threads : pool.default_num_threads;
+
+#ifdef __linux__
+    if (sched_getaffinity(0, sizeof(pool.cpus), &pool.cpus) != 0) {
+        CPU_ZERO(&pool.cpus);
+    }
+#endif
+
+    pool.is_shutdown = false;
+    pool.start_generation = pool.generation;
+    pool.num_workers = 0;
+    for (len_t i = 0; i < num_threads - 1; i++) {
+        if (pthread_create(&pool.workers[i], NULL, worker_main,
+                (void *)(intptr_t)i) != 0) {
+            break;
+        }
+        pool.num_workers++;
+    }
+}
+
+
+/* Stop and join the workers. Called with submit_lock held. */
+static void
+stop_workers(void)
+{
+    if (pool.num_workers == 0) {
+        return;
+    }
+    pool.is_shutdown = true;
+    publish(NULL);
+    for (len_t i = 0; i < pool.num_workers; i++) {
+        pthread_join(pool.workers[i], NULL);
+    }
+    pool.num_workers = 0;
+    pool.is_shutdown = false;
+}
+
+
+void
+sp_parallel_for(
+    len_t n,
+    len_t grain,
+    sp_task_fn fn,
+    void * arg)
+{
+    if (n <= 0) {
+        return;
+    }
+    if (grain < 1) {
+        grain = 1;
+    }
+
+    len_t max_ranges = n / grain + (n % grain != 0);
+    if (max_ranges <= 1 || in_parallel
+            || pthread_mutex_trylock(&pool.submit_lock) != 0) {
+        fn(arg, 0, n);
+        return;
+    }
+
+    if (pool.num_workers == 0) {
+        start_workers();
+    }
+    if (pool.num_workers == 0) {
+        pthread_mutex_unlock(&pool.submit_lock);
+        fn(arg, 0, n);
+        return;
+    }
+
+    sp_job job = {
+        .fn = fn,
+        .arg = arg,
+        .n = n,
+        .num_ranges = max_ranges < pool.num_workers + 1 ?
+            max_ranges : pool.num_workers + 1,
+        .next_range = 0,
+        .num_finished = 0,
+    };
+    publish(&job);
+
+    in_parallel = true;
+    run_ranges(&job);
+    in_parallel = false;
+
+    /* Every worker checks in, even if it found no range left to run. */
+    bool is_done = false;
+    for (len_t i = 0; i < SP_SPIN_COUNT && !is_done; i++) {
+        is_done = __atomic_load_n(&job.num_finished, __ATOMIC_ACQUIRE)
+            == pool.num_workers;
+        SP_CPU_RELAX();
+    }
+    if (!is_done) {
+        pthread_mutex_lock(&pool.done_lock);
+        while (__atomic_load_n(&job.num_finished, __ATOMIC_ACQUIRE)
+                != pool.num_workers) {
+            pthread_cond_wait(&pool.done_cond, &pool.done_lock);
+        }
+        pthread_mutex_unlock(&pool.done_lock);
+    }
+
+    pthread_mutex_unlock(&pool.submit_lock);
+}
+
+
+/**
+ * Set the number of threads used by the parallel routines.
+ *
+ * \param[in] num_threads   Number of threads, including the calling thread.
+ *                          0 restores the default, which is the value of
+ *                          the SNACKPACK_NUM_THREADS environment variable
+ *                          or else the number of CPUs in the affinity mask
+ *                          of the process, both read when the library is
+ *                          loaded.
+ *
+ * The pool is started lazily on the first parallel call, so this is cheap.
+ * If the pool is running, it waits for any job in progress and then stops
+ * the workers so that they are restarted with the new count.
+ */
+void
+sp_set_num_threads(
+    len_t num_threads)
+{
+    if (num_threads < 0) {
+        num_threads = 0;
+    } else if (num_threads > SP_MAX_THREADS) {
+        num_threads = SP_MAX_THREADS;
+    }
+
+    pthread_mutex_lock(&pool.submit_lock);
+    stop_workers();
+    pool.num_threads = num_threads;
+    pthread_mutex_unlock(&pool.submit_lock);
+}
+
+
+/**
+ * Return the number of threads used by the parallel routines, including
+ * the calling thread.
+ */
+len_t
+sp_get_num_threads(void)
+{
+    len_t num_threads = __atomic_load_n(&pool.num_threads, __ATOMIC_RELAXED);
+    return num_threads > 0 ? num_threads : pool.default_num_threads;
+}
+
+
+/**
+ * Pin each worker thread to its own CPU (Linux only).
+ *
+ * \param[in] is_pinned     True to pin worker i to CPU i + 1 of the
+ *                          affinity mask of the process, leaving the first
+ *                          allowed CPU for the calling thread.
+ *
+ * Pinning can also be enabled with SNACKPACK_PIN_THREADS=1. Like
+ * sp_set_num_threads, this restarts a running pool.
+ */
+void
+sp_set_thread_affinity(
+    bool is_pinned)
+{
+    pthread_mutex_lock(&pool.submit_lock);
+    stop_workers();
+    pool.is_pinned = is_pinned;
+    pthread_mutex_unlock(&pool.submit_lock);
+}
+
+
+/*
+ * fork() copies only the calling thread, so the child has the pool state
+ * but none of the workers. The prepare handler takes submit_lock so that no
+ * job is in flight; the child then drops the workers it does not have, and
+ * starts a new pool on its first parallel call.
+ */
+static void
+fork_prepare(void)
+{
+    /* A caller running its share of a job already holds submit_lock. */
+    if (!in_parallel) {
+        pthread_mutex_lock(&pool.submit_lock);
+        is_fork_locked = true;
+    }
+}
+
+
+static void
+fork_parent(void)
+{
+    if (is_fork_locked) {
+        is_fork_locked = false;
+        pthread_mutex_unlock(&pool.submit_lock);
+    }
+}
+
+
+static void
+fork_child(void)
+{
+    /* Workers may have held these when the parent forked. */
+    pthread_mutex_init(&pool.wake_lock, NULL);
+    pthread_cond_init(&pool.wake_cond, NULL);
+    pthread_mutex_init(&pool.done_lock, NULL);
+    pthread_cond_init(&pool.done_cond, NULL);
+
+    pool.num_workers = 0;
+    pool.is_shutdown = false;
+    pool.job = NULL;
+    pool.num_sleepers = 0;
+
+    if (is_fork_locked) {
+        is_fork_locked = false;
+        pthread_mutex_unlock(&pool.submit_lock);
+    }
+}
+
+
+__attribute__((constructor))
+static void
+sp_threadpool_init(void)
+{
+    const char * env = getenv("SNACKPACK_PIN_THREADS");
+    pool.is_pinned = env != NULL && atoi(env) != 0;
+    pool.default_num_threads = default_num_threads();
+    pthread_atfork(fork_prepare, fork_parent, fork_child);
+}
+
+
+/* Join the workers before the library is unloaded. */
+__attribute__((destructor))
+static void
+sp_threadpool_fini(void)
+{
+    pthread_mutex_lock(&pool.submit_lock);
+    stop_workers();
+    pthread_mutex_unlock(&pool.submit_lock);
+}
@@ -0,0 +1,90 @@
+/*
+ * Calls into the ILP64 library with dimensions above 46340, the limit of
+ * the default build. Each call must succeed and give the exact result.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "snackpack/blas1_real.h"
+#include "snackpack/blas2_real.h"
+#include "snackpack/error.h"
+#include "snackpack/sort.h"
+
+
+#define N (50000)
+
+
+static int num_failed = 0;
+
+
+#define CHECK(cond) do { \
+if (!(cond)) { \
+    printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+    num_failed++; \
+} \
+} while (0)
+
+
+int
+main(void)
+{
+    float * x = malloc(2 * N * sizeof(float));
+    float * y = malloc(N * sizeof(float));
+    len_t * perm = malloc(N * sizeof(len_t));
+    if (x == NULL || y == NULL || perm == NULL) {
+        printf("out of memory\n");
+        return 1;
+    }
+
+    CHECK(sizeof(len_t) == 8);
+    CHECK(SP_MAX_DIMENSION > N);
+
+    /* Vectors longer than the default limit */
+    for (len_t i = 0; i < N; i++) {
+        x[i] = 1.0f;
+        y[i] = (float)(i % 7);
+    }
+    x[N - 1] = -2.0f;
+    sp_clear_last_error();
+    CHECK(sp_blas_sdot(N - 1, x, 1, x, 1) == (float)(N - 1));
+    CHECK(sp_blas_isamax(N, x, 1) == N - 1);
+    CHECK(sp_get_last_error() == SP_NO_ERROR);
+
+    /* A leading dimension above the default limit: y = A^T * v, with the
+     * columns of A in x and lda = N. */
+    for (len_t i = 0; i < 2 * N; i++) {
+        x[i] = i < N ? 1.0f : 2.0f;
+    }
+    float v[2] = {0.0f, 0.0f};
+    sp_blas_sgemv(true, N, 2, 1.0f, x, N, y, 1, 0.0f, v, 1);
+    float sum = 0.0f;
+    for (len_t i = 0; i < N; i++) {
+        sum += y[i];
+    }
+    CHECK(v[0] == sum);
+    CHECK(v[1] == 2.0f * sum);
+    CHECK(sp_get_last_error() == SP_NO_ERROR);
+
+    /* Sort with the permutation */
+    for (len_t i = 0; i < N; i++) {
+        y[i] = (float)(N - i);
+    }
+    CHECK(sp_slasrt_perm('I', N, y, perm) == SP_STATUS_OK);
+    for (len_t i = 0; i < N; i++) {
+        if (y[i] != (float)(i + 1) || perm[i] != N - 1 - i) {
+            CHECK(y[i] == (float)(i + 1) && perm[i] == N - 1 - i);
+            break;
+        }
+    }
+    CHECK(sp_get_last_error() == SP_NO_ERROR);
+
+    free(x);
+    free(y);
+    free(perm);
+
+    if (num_failed > 0) {
+        printf("%d checks failed\n", num_failed);
+        return 1;
+    }
+    return 0;
+}
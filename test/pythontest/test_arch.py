@@ -0,0 +1,237 @@
+import numpy as np
+from numpy.random import randn
+from numpy.testing import assert_allclose, assert_array_equal, assert_equal
+
+from snackpack import arch, blas, lapack
+from snackpack.util import FloatArray
+
+
+arch_names = ('sse42', 'avx2', 'avx512')
+
+# Sizes around the widths of the vector loops and their unrolled tails.
+sizes = (1, 3, 7, 8, 9, 15, 16, 17, 31, 32, 33, 63, 64, 65, 100, 1000, 4099)
+
+
+def set_arch(name):
+    """Select a kernel variant; returns False if the host lacks it."""
+    return arch.set_arch(np.frombuffer(name.encode() + b'\0', np.uint8))
+
+
+def each_arch(fn):
+    """Return fn() for the scalar kernels and for every vector variant that
+    the host supports, as a list of (name, result) pairs with the scalar
+    result first."""
+    results = []
+    try:
+        for name in ('scalar',) + arch_names:
+            if set_arch(name):
+                results.append((name, fn()))
+    finally:
+        set_arch('auto')
+    return results
+
+
+def assert_same_as_scalar(fn, rtol=1e-6, atol=1e-6):
+    results = each_arch(fn)
+    expected = results[0][1]
+    for name, result in results[1:]:
+        assert_allclose(expected, result, rtol, atol, err_msg=name)
+
+
+def assert_equal_to_scalar(fn):
+    results = each_arch(fn)
+    expected = results[0][1]
+    for name, result in results[1:]:
+        assert_array_equal(expected, result, err_msg=name)
+
+
+def test_blas1_reductions():
+    """Test the vector sasum, sdot and snrm2 kernels against scalar"""
+    for n in sizes:
+        x = FloatArray(randn(n))
+        y = FloatArray(randn(n))
+        # sdot may cancel, so its tolerance is relative to sum(|x*y|).
+        scale = float(np.abs(x * y).sum())
+        assert_same_as_scalar(lambda: blas.sasum(n, x, 1), 1e-5)
+        assert_same_as_scalar(lambda: blas.sdot(n, x, 1, y, 1), 0,
+                              1e-5 * scale)
+        assert_same_as_scalar(lambda: blas.snrm2(n, x, 1), 1e-5)
+
+
+def test_blas1_updates():
+    """Test the vector saxpy, sscal and srot kernels against scalar"""
+    for n in sizes:
+        x = FloatArray(randn(n))
+        y = FloatArray(randn(n))
+
+        def saxpy():
+            r = y.copy()
+            blas.saxpy(n, 0.75, x, 1, r, 1)
+            return r
+
+        def sscal():
+            r = x.copy()
+            blas.sscal(n, -1.5, r, 1)
+            return r
+
+        def srot():
+            u = x.copy()
+            v = y.copy()
+            blas.srot(n, u, 1, v, 1, 0.6, 0.8)
+            return np.concatenate((u, v))
+
+        assert_same_as_scalar(saxpy)
+        assert_same_as_scalar(sscal)
+        assert_same_as_scalar(srot)
+
+
+def test_blas1_moves():
+    """Test the vector scopy, sswap, isamax and isamin kernels against
+    scalar"""
+    for n in sizes:
+        x = FloatArray(randn(n))
+        y = FloatArray(randn(n))
+
+        def scopy():
+            r = y.copy()
+            blas.scopy(n, x, 1, r, 1)
+            return r
+
+        def sswap():
+            u = x.copy()
+            v = y.copy()
+            blas.sswap(n, u, 1, v, 1)
+            return np.concatenate((u, v))
+
+        assert_equal_to_scalar(scopy)
+        assert_equal_to_scalar(sswap)
+        assert_equal_to_scalar(lambda: blas.isamax(n, x, 1))
+        assert_equal_to_scalar(lambda: blas.isamin(n, x, 1))
+
+
+def test_fused_blas1():
+    """Test the vector saxpy_dot and scopy_scal kernels against scalar"""
+    for n in sizes:
+        x = FloatArray(randn(n))
+        y = FloatArray(randn(n))
+        z = FloatArray(randn(n))
+
+        def saxpy_dot():
+            r = y.copy()
+            dot = blas.saxpy_dot(n, 0.75, x, 1, r, 1, z, 1)
+            return np.append(r, dot)
+
+        def scopy_scal():
+            r = y.copy()
+            blas.scopy_scal(n, -1.5, x, 1, r, 1)
+            return r
+
+        assert_same_as_scalar(saxpy_dot, 1e-5, 1e-4)
+        assert_same_as_scalar(scopy_scal)
+
+
+def test_sgemv():
+    """Test the vector sgemv kernels against scalar"""
+    for rows, cols in ((1, 1), (7, 5), (33, 17), (64, 64), (301, 203)):
+        lda = rows + 3
+        A = FloatArray(randn(lda * cols))
+        for is_trans in (False, True):
+            len_x, len_y = (rows, cols) if is_trans else (cols, rows)
+            x = FloatArray(randn(len_x))
+            y = FloatArray(randn(len_y))
+            for beta in (0.0, 1.0, 0.5):
+                def sgemv():
+                    r = y.copy()
+                    blas.sgemv(is_trans, rows, cols, 1.25, A, lda, x, 1,
+                               beta, r, 1)
+                    return r
+                assert_same_as_scalar(sgemv, 1e-5, 1e-4)
+
+
+def test_sgemv_batch():
+    """Test the vector small-matrix sgemv kernels against scalar"""
+    count = 10
+    for rows, cols in ((1, 1), (3, 5), (4, 4), (8, 8), (13, 9)):
+        stride_A = rows * cols
+        A = FloatArray(randn(stride_A * count))
+        for is_trans in (False, True):
+            len_x, len_y = (rows, cols) if is_trans else (cols, rows)
+            x = FloatArray(randn(len_x * count))
+            y = FloatArray(randn(len_y * count))
+
+            def sgemv_batch():
+                r = y.copy()
+                blas.sgemv_batch(is_trans, rows, cols, 1.25, A, rows,
+                                 stride_A, x, 1, len_x, 0.5, r, 1, len_y,
+                                 count)
+                return r
+            assert_same_as_scalar(sgemv_batch, 1e-5, 1e-4)
+
+
+def test_sger_ssymv():
+    """Test the vector sger and ssymv kernels against scalar"""
+    for n in (1, 7, 33, 64, 130, 301):
+        lda = n + 3
+        A = FloatArray(randn(lda * n))
+        x = FloatArray(randn(n))
+        y = FloatArray(randn(n))
+
+        def sger():
+            r = A.copy()
+            blas.sger(n, n, 0.75, x, 1, y, 1, r, lda)
+            return r
+
+        assert_same_as_scalar(sger)
+        for is_upper in (False, True):
+            def ssymv():
+                r = y.copy()
+                blas.ssymv(is_upper, n, 1.25, A, lda, x, 1, 0.5, r, 1)
+                return r
+            assert_same_as_scalar(ssymv, 1e-5, 1e-4)
+
+
+def test_sgemm():
+    """Test the sgemm micro-kernels against scalar"""
+    for m, n, k in ((1, 1, 1), (7, 5, 3), (32, 12, 16), (33, 13, 17),
+                    (100, 70, 300)):
+        for is_trans_a in (False, True):
+            for is_trans_b in (False, True):
+                lda = (k if is_trans_a else m) + 1
+                ldb = (n if is_trans_b else k) + 2
+                A = FloatArray(randn(lda * (m if is_trans_a else k)))
+                B = FloatArray(randn(ldb * (k if is_trans_b else n)))
+                C = FloatArray(randn((m + 3) * n))
+
+                def sgemm():
+                    r = C.copy()
+                    blas.sgemm(is_trans_a, is_trans_b, m, n, k, 1.25, A,
+                               lda, B, ldb, 0.5, r, m + 3)
+                    return r
+                assert_same_as_scalar(sgemm, 1e-5, 1e-4)
+
+
+def test_sort():
+    """Test the vector sort kernels against scalar"""
+    for n in (2, 15, 16, 17, 100, 2047, 10000):
+        x = FloatArray(randn(n))
+
+        def slasrt():
+            d = x.copy()
+            lapack.slasrt(b'I', n, d)
+            return d
+
+        def sselect():
+            d = x.copy()
+            lapack.sselect(b'I', n // 2, n, d)
+            return d[n // 2]
+
+        assert_equal_to_scalar(slasrt)
+        assert_equal_to_scalar(sselect)
+
+
+def test_arch_available():
+    """Test that at least the scalar kernels can be selected, and that
+    sp_set_arch leaves the selection alone for an unknown name"""
+    results = each_arch(lambda: None)
+    assert_equal(results[0][0], 'scalar')
+    assert not set_arch('no such arch')
@@ -0,0 +1,182 @@
+from itertools import product
+
+import numpy as np
+from numpy.random import randn
+from numpy.testing import assert_allclose, assert_array_equal
+
+from snackpack import blas
+from snackpack.util import FloatArray, indexed_vector
+
+
+vec_inc = (-3, -1, 1, 3)
+batch_counts = (1, 5, 300)
+lengths = (1, 8, 37)
+
+
+def batch(n, inc, batch_count):
+    """Return a strided batch, its stride and a list of indexed views."""
+    stride = n * abs(inc) + 2
+    v = FloatArray(randn(stride * batch_count))
+    views = [indexed_vector(v[b * stride:(b + 1) * stride], n, inc)
+             for b in range(batch_count)]
+    return v, stride, views
+
+
+def pointers(v, stride, batch_count):
+    """Return an array of pointers to the members of a strided batch, for
+    the _ptr routines."""
+    return np.array([v.ctypes.data + b * stride * v.itemsize
+                     for b in range(batch_count)], dtype=np.uintp)
+
+
+def test_sasum_batch():
+    """Test sp_blas_sasum_batch"""
+    for n, inc, count in product(lengths, vec_inc, batch_counts):
+        x, stride, x_idx = batch(n, inc, count)
+        x0 = x.copy()
+        result = FloatArray(np.zeros(count))
+        blas.sasum_batch(n, x, inc, stride, result, count)
+        expected = [np.sum(np.abs(v)) for v in x_idx]
+        assert_allclose(expected, result, 1e-5)
+        assert_array_equal(x0, x)
+
+        result_ptr = FloatArray(np.zeros(count))
+        blas.sasum_batch_ptr(n, pointers(x, stride, count), inc, result_ptr,
+                             count)
+        assert_array_equal(result, result_ptr)
+
+
+def test_sdot_batch():
+    """Test sp_blas_sdot_batch"""
+    for n, inc_x, inc_y, count in product(
+            lengths, vec_inc, vec_inc, batch_counts):
+        x, stride_x, x_idx = batch(n, inc_x, count)
+        y, stride_y, y_idx = batch(n, inc_y, count)
+        result = FloatArray(np.zeros(count))
+        blas.sdot_batch(n, x, inc_x, stride_x, y, inc_y, stride_y,
+                        result, count)
+        expected = [u.dot(v) for u, v in zip(x_idx, y_idx)]
+        assert_allclose(expected, result, 1e-5, 1e-5)
+
+        result_ptr = FloatArray(np.zeros(count))
+        blas.sdot_batch_ptr(n, pointers(x, stride_x, count), inc_x,
+                            pointers(y, stride_y, count), inc_y, result_ptr,
+                            count)
+        assert_array_equal(result, result_ptr)
+
+
+def test_snrm2_batch():
+    """Test sp_blas_snrm2_batch"""
+    for n, inc, count in product(lengths, vec_inc, batch_counts):
+        x, stride, x_idx = batch(n, inc, count)
+        result = FloatArray(np.zeros(count))
+        blas.snrm2_batch(n, x, inc, stride, result, count)
+        expected = [np.linalg.norm(v) for v in x_idx]
+        assert_allclose(expected, result, 1e-6)
+
+        result_ptr = FloatArray(np.zeros(count))
+        blas.snrm2_batch_ptr(n, pointers(x, stride, count), inc, result_ptr,
+                             count)
+        assert_array_equal(result, result_ptr)
+
+
+def test_saxpy_batch():
+    """Test sp_blas_saxpy_batch"""
+    for n, inc_x, inc_y, count in product(
+            lengths, vec_inc, vec_inc, batch_counts):
+        a = randn()
+        x, stride_x, x_idx = batch(n, inc_x, count)
+        y, stride_y, y_idx = batch(n, inc_y, count)
+        expected = [a * u + v for u, v in zip(x_idx, y_idx)]
+        y_ptr = y.copy()
+        blas.saxpy_batch(n, a, x, inc_x, stride_x, y, inc_y, stride_y, count)
+        # a*x + y may cancel, so allow an absolute error as well
+        for e, v in zip(expected, y_idx):
+            assert_allclose(e, v, 1e-6, 1e-6)
+
+        blas.saxpy_batch_ptr(n, a, pointers(x, stride_x, count), inc_x,
+                             pointers(y_ptr, stride_y, count), inc_y, count)
+        assert_array_equal(y, y_ptr)
+
+
+def test_sscal_batch():
+    """Test sp_blas_sscal_batch"""
+    for n, inc, count in product(lengths, vec_inc, batch_counts):
+        a = randn()
+        x, stride, x_idx = batch(n, inc, count)
+        expected = [a * v for v in x_idx]
+        x_ptr = x.copy()
+        blas.sscal_batch(n, a, x, inc, stride, count)
+        for e, v in zip(expected, x_idx):
+            assert_allclose(e, v, 1e-6)
+
+        blas.sscal_batch_ptr(n, a, pointers(x_ptr, stride, count), inc,
+                             count)
+        assert_array_equal(x, x_ptr)
+
+
+def test_sgemv_batch():
+    """Test sp_blas_sgemv_batch, including the small-matrix kernels"""
+    count = 40
+    shapes = ((4, 4), (8, 8), (16, 16), (8, 3), (16, 37), (5, 7), (64, 64))
+    for (rows, cols), is_trans in product(shapes, (False, True)):
+        len_x, len_y = (rows, cols) if is_trans else (cols, rows)
+        for inc_x, inc_y, b in product((-2, 1), (-1, 1), (0.0, randn())):
+            a = randn()
+            lda = rows + 1
+            stride_A = lda * cols
+            A = FloatArray(randn(stride_A * count))
+            x, stride_x, x_idx = batch(len_x, inc_x, count)
+            y, stride_y, y_idx = batch(len_y, inc_y, count)
+
+            expected = []
+            for k in range(count):
+                A_k = A[k * stride_A:(k + 1) * stride_A]
+                A_slice = np.reshape(A_k, (lda, cols), 'F')[:rows, :]
+                if is_trans:
+                    A_slice = A_slice.T
+                expected.append(a * A_slice.dot(x_idx[k]) + b * y_idx[k])
+
+            y_ptr = y.copy()
+            blas.sgemv_batch(is_trans, rows, cols, a, A, lda, stride_A,
+                             x, inc_x, stride_x, b, y, inc_y, stride_y, count)
+            for e, v in zip(expected, y_idx):
+                assert_allclose(e, v, 1e-4, 5e-4)
+
+            blas.sgemv_batch_ptr(is_trans, rows, cols, a,
+                                 pointers(A, stride_A, count), lda,
+                                 pointers(x, stride_x, count), inc_x, b,
+                                 pointers(y_ptr, stride_y, count), inc_y,
+                                 count)
+            assert_array_equal(y, y_ptr)
+
+
+def test_sgemv_batch_shared():
+    """Test sp_blas_sgemv_batch with one matrix or one x for the batch"""
+    count = 40
+    for (rows, cols), is_trans in product(((8, 8), (5, 7)), (False, True)):
+        len_x, len_y = (rows, cols) if is_trans else (cols, rows)
+        for share_A, share_x in ((True, False), (False, True),
+                                 (True, True)):
+            a, b = randn(), randn()
+            lda = rows + 1
+            stride_A = 0 if share_A else lda * cols
+            A = FloatArray(randn(max(stride_A, lda * cols) * count))
+            x, stride_x, x_idx = batch(len_x, 1, count)
+            if share_x:
+                stride_x = 0
+                x_idx = [x_idx[0]] * count
+            y, stride_y, y_idx = batch(len_y, 1, count)
+
+            expected = []
+            for k in range(count):
+                A_k = A[k * stride_A:k * stride_A + lda * cols]
+                A_slice = np.reshape(A_k, (lda, cols), 'F')[:rows, :]
+                if is_trans:
+                    A_slice = A_slice.T
+                expected.append(a * A_slice.dot(x_idx[k]) + b * y_idx[k])
+
+            blas.sgemv_batch(is_trans, rows, cols, a, A, lda, stride_A,
+                             x, 1, stride_x, b, y, 1, stride_y, count)
+            for e, v in zip(expected, y_idx):
+                assert_allclose(e, v, 1e-4, 5e-4)
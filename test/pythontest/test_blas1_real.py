@@ -1,13 +1,15 @@
+import ctypes
+
 from numpy.testing import (
     assert_equal, assert_array_equal, assert_array_almost_equal_nulp,
-    assert_almost_equal)
+    assert_almost_equal, assert_allclose)
 
 import numpy as np
 from numpy.random import randn
 
-from snackpack import blas
+from snackpack import arch, blas, threads
 from snackpack.util import (
-    FloatArray, float_t, len_t, indexed_vector,
+    FloatArray, float_t_max, indexed_vector, len_t,
     vector_generator,
     double_vector_generator,
     assert_nonindexed_unchanged)
@@ -30,10 +32,11 @@ def test_saxpy():
     for a in alpha:
         for n, x, inc_x, x_idx, y, inc_y, y_idx in double_vector_generator():
             y0 = y.copy()
-            # Compute the expected from the indexed versions
+            # Compute the expected from the indexed versions. It is in
+            # double precision, and saxpy may use a fused multiply-add.
             expected = a * x_idx + y_idx
             blas.saxpy(n, a, x, inc_x, y, inc_y)
-            assert_array_almost_equal_nulp(expected, y_idx)
+            assert_allclose(expected, y_idx, 1e-6, 1e-6)
             assert_nonindexed_unchanged(y0, y, n, inc_y)
 
 
@@ -120,6 +123,63 @@ def test_snrm2():
         assert_array_equal(x, x0)
 
 
+# Lengths above SP_REDUCE_PARALLEL_MIN, where the reductions are chunked
+# and spread over the thread pool. The largest vector is SP_MAX_DIMENSION
+# long, or 1 << 16 if len_t is 64 bits.
+max_dimension = int((2 ** (8 * ctypes.sizeof(len_t) - 1) - 1) ** 0.5)
+reduce_sizes = sorted(set((1 << 15, 40001, min(1 << 16, max_dimension))))
+
+
+def reduce_all(n, x, inc_x, y, inc_y):
+    return (blas.sasum(n, x, inc_x), blas.sdot(n, x, inc_x, y, inc_y),
+            blas.sdsdot(n, 0.5, x, inc_x, y, inc_y),
+            blas.snrm2(n, x, inc_x))
+
+
+def test_reduce_threads():
+    """Test that sasum, sdot, sdsdot and snrm2 on long vectors give the
+    same bits for any number of threads and any kernel variant"""
+    try:
+        for n in reduce_sizes:
+            for inc_x, inc_y in ((1, 1), (-3, 2)):
+                x = FloatArray(randn(n * abs(inc_x)))
+                y = FloatArray(randn(n * abs(inc_y)))
+                x_idx = indexed_vector(x, n, inc_x)
+                y_idx = indexed_vector(y, n, inc_y)
+
+                threads.set_num_threads(1)
+                expected = reduce_all(n, x, inc_x, y, inc_y)
+                assert_almost_equal(
+                    expected[0] / np.abs(x_idx).astype(np.float64).sum(),
+                    1.0, decimal=5)
+                assert_almost_equal(
+                    expected[3] / np.linalg.norm(x_idx.astype(np.float64)),
+                    1.0, decimal=5)
+
+                for num_threads in (2, 3, 4):
+                    threads.set_num_threads(num_threads)
+                    assert_array_equal(expected,
+                                       reduce_all(n, x, inc_x, y, inc_y))
+
+                for name in (b'scalar\0', b'avx2\0'):
+                    if arch.set_arch(np.frombuffer(name, np.uint8)):
+                        assert_array_equal(expected,
+                                           reduce_all(n, x, inc_x, y, inc_y))
+                    arch.set_arch(np.frombuffer(b'auto\0', np.uint8))
+    finally:
+        threads.set_num_threads(0)
+
+
+def test_snrm2_no_overflow():
+    """Test sp_blas_snrm2 on values whose squares overflow or underflow"""
+    for scale in (1e30, 1e-30):
+        for n, x, inc_x, x_idx in vector_generator():
+            x_idx *= scale
+            expected = np.linalg.norm(x_idx.astype(np.float64))
+            result = blas.snrm2(n, x, inc_x)
+            assert_almost_equal(expected / result, 1.0, decimal=6)
+
+
 def test_sscal():
     """Test sp_blas_sscal"""
     alpha = randn(50)
@@ -154,40 +214,109 @@ def test_isamin():
         assert_array_equal(x, x0)
 
 
+def test_isamax_ties():
+    """Test that sp_blas_isamax and sp_blas_isamin return the first of
+    several equal elements"""
+    for n in (1, 7, 16, 33, 100, 1000):
+        x = FloatArray(np.random.randint(-3, 4, n))
+        expected = np.where(np.amax(np.abs(x)) == np.abs(x))[0][0]
+        assert_equal(expected, blas.isamax(n, x, 1))
+        expected = np.where(np.amin(np.abs(x)) == np.abs(x))[0][0]
+        assert_equal(expected, blas.isamin(n, x, 1))
+
+
+def test_isamax_value():
+    """Test sp_blas_isamax_value and sp_blas_isamin_value"""
+    for n, x, inc_x, x_idx in vector_generator():
+        value = FloatArray(np.zeros(1))
+        result = blas.isamax_value(n, x, inc_x, value)
+        assert_equal(blas.isamax(n, x, inc_x), result)
+        assert_equal(x[result], value[0])
+
+        result = blas.isamin_value(n, x, inc_x, value)
+        assert_equal(blas.isamin(n, x, inc_x), result)
+        assert_equal(x[result], value[0])
+
+
+def test_saxpy_dot():
+    """Test sp_blas_saxpy_dot against saxpy followed by sdot"""
+    for a in (0.0, randn()):
+        for n, x, inc_x, x_idx, y, inc_y, y_idx in double_vector_generator():
+            z = FloatArray(randn(n))
+            expected_y = a * x_idx + y_idx
+            expected = np.dot(expected_y, z)
+            result = blas.saxpy_dot(n, a, x, inc_x, y, inc_y, z, 1)
+            assert_array_almost_equal_nulp(expected_y, y_idx)
+            assert_almost_equal(expected / result, 1.0, decimal=4)
+
+
+def test_snrm2_scal():
+    """Test sp_blas_snrm2_scal"""
+    for n, x, inc_x, x_idx in vector_generator():
+        expected = np.linalg.norm(x_idx)
+        result = blas.snrm2_scal(n, x, inc_x)
+        assert_almost_equal(expected / result, 1.0, decimal=5)
+        assert_almost_equal(np.linalg.norm(x_idx), 1.0, decimal=5)
+
+
+def test_snrm2_scal_no_overflow():
+    """Test sp_blas_snrm2_scal on vectors whose norm has no float
+    reciprocal, or overflows float"""
+    for scale in (1e-40, 3e37):
+        for n, x, inc_x, x_idx in vector_generator():
+            x_idx *= scale
+            expected = np.linalg.norm(x_idx.astype(np.float64))
+            result = blas.snrm2_scal(n, x, inc_x)
+            # The returned norm is a float, so it may be subnormal or inf
+            if expected > float_t_max:
+                assert_equal(np.inf, result)
+            else:
+                assert_allclose(expected, result, 1e-5, 1e-44)
+            assert_almost_equal(np.linalg.norm(x_idx), 1.0, decimal=5)
+
+    for v, expected in (([1e-39, 0.0], [1.0, 0.0]),
+                        ([3e38, 3e38], [0.5 ** 0.5, 0.5 ** 0.5])):
+        x = FloatArray(v)
+        blas.snrm2_scal(2, x, 1)
+        assert_allclose(expected, x, 1e-6)
+
+
+def test_scopy_scal():
+    """Test sp_blas_scopy_scal"""
+    for a in (0.0, randn()):
+        for n, x, inc_x, x_idx, y, inc_y, y_idx in double_vector_generator():
+            y0 = y.copy()
+            blas.scopy_scal(n, a, x, inc_x, y, inc_y)
+            assert_array_almost_equal_nulp(a * x_idx, y_idx)
+            assert_nonindexed_unchanged(y0, y, n, inc_y)
+
+
 def test_srotg():
     """Test sp_blas_srotg"""
     # TODO: Find some pathological cases
     for a, b in np.random.randn(1000, 2):
-        a_f = float_t(a)
-        b_f = float_t(b)
-        c_f = float_t()
-        s_f = float_t()
-        blas.srotg(a_f, b_f, c_f, s_f)
+        r = FloatArray([a])
+        z = FloatArray([b])
+        c = FloatArray(np.zeros(1))
+        s = FloatArray(np.zeros(1))
+        blas.srotg(r, z, c, s)
         # Kind of week precision here - LAPACK reference implementation is
         # more accurate than BLAS implementation.
-        assert_almost_equal(
-            a * c_f.value + b * s_f.value, a_f.value, decimal=5)
-        assert_almost_equal(
-            -a * s_f.value + b * c_f.value, 0, decimal=6)
+        assert_almost_equal(a * c[0] + b * s[0], r[0], decimal=5)
+        assert_almost_equal(-a * s[0] + b * c[0], 0, decimal=6)
 
 
 def test_srot():
     """Test sp_blas_srot"""
-    inc_x = len_t(1)
-    inc_y = len_t(1)
-    n = len_t(100)
-
     # TODO: find some pathological cases
-    # TODO: clean this up
     for c, s in np.random.randn(10, 2):
-        c_f = float_t(c)
-        s_f = float_t(s)
-        x = FloatArray(np.random.randn(n.value, 1))
-        y = FloatArray(np.random.randn(n.value, 1))
-        x_res, y_res = [], []
-        for i in range(n.value):
-            x_res.append(c_f * x[i] + s_f * y[i])
-            y_res.append(c_f * y[i] - s_f * x[i])
-        x_res = FloatArray(x_res)
-        y_res = FloatArray(y_res)
-        blas.srot(n, x, inc_x, y, inc_y, c_f, s_f)
+        for n, x, inc_x, x_idx, y, inc_y, y_idx in double_vector_generator():
+            x0 = x.copy()
+            y0 = y.copy()
+            expected_x = c * x_idx + s * y_idx
+            expected_y = c * y_idx - s * x_idx
+            blas.srot(n, x, inc_x, y, inc_y, c, s)
+            assert_allclose(expected_x, x_idx, 1e-5, 1e-5)
+            assert_allclose(expected_y, y_idx, 1e-5, 1e-5)
+            assert_nonindexed_unchanged(x0, x, n, inc_x)
+            assert_nonindexed_unchanged(y0, y, n, inc_y)
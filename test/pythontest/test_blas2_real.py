@@ -10,7 +10,6 @@ from snackpack import blas
 from snackpack.util import (
     FloatArray, matrix_generator, square_matrix_generator, indexed_vector,
     assert_nonindexed_unchanged)
-from snackpack.blas import SP_TRANS
 
 
 vec_inc = (-3, -1, 1, 3)
@@ -35,7 +34,7 @@ def test_sgemv_no_trans():
             blas.sgemv(False, rows, cols, a, A, lda, x, 1, b, y, 1)
 
             assert_array_equal(x0, x)
-            assert_allclose(expected, expected, 1e-5, 5e-5)
+            assert_allclose(expected, y, 1e-5, 5e-5)
 
     for lda, rows, cols, A in matrix_generator():
         for inc_x, inc_y in product(vec_inc, vec_inc):
@@ -63,6 +62,29 @@ def test_sgemv_no_trans():
             assert_nonindexed_unchanged(y0, y, rows, inc_y)
 
 
+def test_sgemv_no_trans_row_blocks():
+    """Test sp_blas_sgemv with no transpose across several row blocks"""
+    rows, cols = 5000, 7
+    for inc_x, inc_y in product(vec_inc, vec_inc):
+        for b in (0.0, 1.0, randn()):
+            a = randn()
+            A = FloatArray(randn(rows * cols))
+            x = FloatArray(randn(cols * abs(inc_x)))
+            y = FloatArray(randn(rows * abs(inc_y)))
+
+            x_idx = indexed_vector(x, cols, inc_x)
+            y_idx = indexed_vector(y, rows, inc_y)
+
+            A_slice = np.reshape(A, (rows, cols), 'F')
+            y0 = y.copy()
+
+            expected = a * A_slice.dot(x_idx) + b * y_idx
+            blas.sgemv(False, rows, cols, a, A, rows, x, inc_x, b, y, inc_y)
+
+            assert_allclose(expected, y_idx, 1e-5, 5e-5)
+            assert_nonindexed_unchanged(y0, y, rows, inc_y)
+
+
 def test_sgemv_with_trans():
     """Test sp_blas_sgemv with transpose"""
     alpha = randn(4)
@@ -107,6 +129,74 @@ def test_sgemv_with_trans():
             assert_nonindexed_unchanged(y0, y, cols, inc_y)
 
 
+def test_sgemv_with_trans_row_blocks():
+    """Test sp_blas_sgemv with transpose across several row blocks"""
+    rows, cols = 5000, 7
+    for inc_x, inc_y in product(vec_inc, vec_inc):
+        for b in (0.0, 1.0, randn()):
+            a = randn()
+            A = FloatArray(randn(rows * cols))
+            x = FloatArray(randn(rows * abs(inc_x)))
+            y = FloatArray(randn(cols * abs(inc_y)))
+
+            x_idx = indexed_vector(x, rows, inc_x)
+            y_idx = indexed_vector(y, cols, inc_y)
+
+            A_sliceT = np.reshape(A, (rows, cols), 'F').T
+            y0 = y.copy()
+
+            expected = a * A_sliceT.dot(x_idx) + b * y_idx
+            blas.sgemv(True, rows, cols, a, A, rows, x, inc_x, b, y, inc_y)
+
+            assert_allclose(expected, y_idx, 1e-4, 5e-4)
+            assert_nonindexed_unchanged(y0, y, cols, inc_y)
+
+
+def test_sgemv_threaded():
+    """Test sp_blas_sgemv on a matrix large enough to be split up"""
+    rows, cols = 700, 300
+    for is_trans, inc_x, inc_y in product((False, True), vec_inc, vec_inc):
+        len_x, len_y = (rows, cols) if is_trans else (cols, rows)
+        a, b = randn(2)
+        A = FloatArray(randn(rows * cols))
+        x = FloatArray(randn(len_x * abs(inc_x)))
+        y = FloatArray(randn(len_y * abs(inc_y)))
+
+        x_idx = indexed_vector(x, len_x, inc_x)
+        y_idx = indexed_vector(y, len_y, inc_y)
+
+        A_slice = np.reshape(A, (rows, cols), 'F')
+        if is_trans:
+            A_slice = A_slice.T
+        y0 = y.copy()
+
+        expected = a * A_slice.dot(x_idx) + b * y_idx
+        blas.sgemv(is_trans, rows, cols, a, A, rows, x, inc_x, b, y, inc_y)
+
+        assert_allclose(expected, y_idx, 1e-4, 5e-4)
+        assert_nonindexed_unchanged(y0, y, len_y, inc_y)
+
+
+def test_sger():
+    """Test sp_blas_sger"""
+    for lda, rows, cols, A in matrix_generator():
+        for inc_x, inc_y in product(vec_inc, vec_inc):
+            a = randn()
+            x = FloatArray(randn(rows * abs(inc_x)))
+            y = FloatArray(randn(cols * abs(inc_y)))
+            x_idx = indexed_vector(x, rows, inc_x)
+            y_idx = indexed_vector(y, cols, inc_y)
+
+            A0 = np.reshape(A, (lda, cols), 'F').copy()
+            expected = A0[:rows, :] + a * np.outer(x_idx, y_idx)
+            blas.sger(rows, cols, a, x, inc_x, y, inc_y, A, lda)
+
+            A_new = np.reshape(A, (lda, cols), 'F')
+            assert_allclose(expected, A_new[:rows, :], 1e-5, 1e-5)
+            assert_array_equal(A0[rows:, :], A_new[rows:, :])
+            A[:] = A0.flatten('F')
+
+
 def test_strmv_no_trans():
     """Test sp_blas_strmv with no transpose"""
     for lda, n, A0 in square_matrix_generator():
@@ -132,3 +222,239 @@ def test_strmv_no_trans():
             expected = A.dot(x_idx)[:n]
             blas.strmv(True, False, True, n, A_f, lda, x, inc_x)
             assert_allclose(expected, x_idx, 1e-5, 5e-5)
+
+
+def test_strmv_all():
+    """Test sp_blas_strmv for every triangle, transpose and diagonal"""
+    for lda, n, A0 in square_matrix_generator():
+        for inc_x, is_upper, is_trans, is_unit in product(
+                vec_inc, (True, False), (True, False), (True, False)):
+            A = np.reshape(A0, (lda, n), 'F')[:n, :].copy()
+            A = np.triu(A) if is_upper else np.tril(A)
+            if is_unit:
+                np.fill_diagonal(A, 1.0)
+            op_A = A.T if is_trans else A
+
+            x = FloatArray(randn(n * abs(inc_x)))
+            x0 = x.copy()
+            x_idx = indexed_vector(x, n, inc_x)
+            expected = op_A.dot(x_idx)
+
+            blas.strmv(is_upper, is_trans, is_unit, n, A0, lda, x, inc_x)
+            assert_allclose(expected, x_idx, 1e-4, 1e-4 * n)
+            assert_nonindexed_unchanged(x0, x, n, inc_x)
+
+
+def test_strsv_all():
+    """Test sp_blas_strsv for every triangle, transpose and diagonal"""
+    for lda, n, A0 in square_matrix_generator():
+        # Small off-diagonal entries keep the system well conditioned, also
+        # with a unit diagonal
+        A_full = np.reshape(A0, (lda, n), 'F') / n
+        A_full[:n, :] += np.eye(n)
+        A_f = FloatArray(A_full.flatten('F'))
+
+        for inc_x, is_upper, is_trans, is_unit in product(
+                vec_inc, (True, False), (True, False), (True, False)):
+            A = A_full[:n, :].copy()
+            A = np.triu(A) if is_upper else np.tril(A)
+            if is_unit:
+                np.fill_diagonal(A, 1.0)
+            op_A = A.T if is_trans else A
+
+            x = FloatArray(randn(n * abs(inc_x)))
+            x0 = x.copy()
+            x_idx = indexed_vector(x, n, inc_x)
+            b = x_idx.copy()
+
+            blas.strsv(is_upper, is_trans, is_unit, n, A_f, lda, x, inc_x)
+            assert_allclose(op_A.dot(x_idx), b, 1e-4, 1e-4 * n)
+            assert_nonindexed_unchanged(x0, x, n, inc_x)
+
+
+def test_ssymv():
+    """Test sp_blas_ssymv with either triangle stored"""
+    for lda, n, A0 in square_matrix_generator():
+        A_full = np.reshape(A0, (lda, n), 'F')[:n, :]
+        for inc_x, inc_y, is_upper in product(vec_inc, vec_inc, (True, False)):
+            a, b = randn(2)
+            T = np.triu(A_full) if is_upper else np.tril(A_full)
+            S = T + T.T - np.diag(np.diag(T))
+
+            x = FloatArray(randn(n * abs(inc_x)))
+            y = FloatArray(randn(n * abs(inc_y)))
+            x_idx = indexed_vector(x, n, inc_x)
+            y_idx = indexed_vector(y, n, inc_y)
+            y0 = y.copy()
+
+            expected = a * S.dot(x_idx) + b * y_idx
+            blas.ssymv(is_upper, n, a, A0, lda, x, inc_x, b, y, inc_y)
+
+            assert_allclose(expected, y_idx, 1e-4, 1e-4 * n)
+            assert_nonindexed_unchanged(y0, y, n, inc_y)
+
+
+def test_ssymv_threaded():
+    """Test sp_blas_ssymv on a matrix large enough to be split up"""
+    n = 1100
+    for is_upper, inc_x, inc_y in product((True, False), vec_inc, vec_inc):
+        a, b = randn(2)
+        A = FloatArray(randn(n * n))
+        T = np.reshape(A, (n, n), 'F')
+        T = np.triu(T) if is_upper else np.tril(T)
+        S = T + T.T - np.diag(np.diag(T))
+
+        x = FloatArray(randn(n * abs(inc_x)))
+        y = FloatArray(randn(n * abs(inc_y)))
+        x_idx = indexed_vector(x, n, inc_x)
+        y_idx = indexed_vector(y, n, inc_y)
+        y0 = y.copy()
+
+        expected = a * S.dot(x_idx) + b * y_idx
+        blas.ssymv(is_upper, n, a, A, n, x, inc_x, b, y, inc_y)
+
+        assert_allclose(expected, y_idx, 1e-4, 5e-3)
+        assert_nonindexed_unchanged(y0, y, n, inc_y)
+
+
+def pack_triangle(T, is_upper):
+    """Pack the upper or lower triangle of T by columns"""
+    n = T.shape[0]
+    return FloatArray(np.concatenate(
+        [T[:j + 1, j] if is_upper else T[j:, j] for j in range(n)]))
+
+
+def band_storage(A, kl, ku):
+    """Store the band of A with kl sub- and ku super-diagonals by columns"""
+    rows, cols = A.shape
+    band = np.zeros((kl + ku + 1, cols))
+    for j in range(cols):
+        for i in range(max(0, j - ku), min(rows, j + kl + 1)):
+            band[ku + i - j, j] = A[i, j]
+    return FloatArray(band.flatten('F'))
+
+
+def test_sspmv():
+    """Test sp_blas_sspmv with either triangle stored"""
+    for lda, n, A0 in square_matrix_generator():
+        A = np.reshape(A0, (lda, n), 'F')[:n, :]
+        for inc_x, inc_y, is_upper in product(vec_inc, vec_inc, (True, False)):
+            a, b = randn(2)
+            T = np.triu(A) if is_upper else np.tril(A)
+            S = T + T.T - np.diag(np.diag(T))
+
+            x = FloatArray(randn(n * abs(inc_x)))
+            y = FloatArray(randn(n * abs(inc_y)))
+            x_idx = indexed_vector(x, n, inc_x)
+            y_idx = indexed_vector(y, n, inc_y)
+
+            expected = a * S.dot(x_idx) + b * y_idx
+            blas.sspmv(is_upper, n, a, pack_triangle(T, is_upper), x, inc_x,
+                       b, y, inc_y)
+            assert_allclose(expected, y_idx, 1e-4, 1e-4 * n)
+
+
+def test_stpmv_stpsv():
+    """Test sp_blas_stpmv and sp_blas_stpsv for every case"""
+    for lda, n, A0 in square_matrix_generator():
+        A = np.reshape(A0, (lda, n), 'F')[:n, :] / n + np.eye(n)
+        for inc_x, is_upper, is_trans, is_unit in product(
+                vec_inc, (True, False), (True, False), (True, False)):
+            T = np.triu(A) if is_upper else np.tril(A)
+            AP = pack_triangle(T, is_upper)
+            if is_unit:
+                np.fill_diagonal(T, 1.0)
+            op_T = T.T if is_trans else T
+
+            x = FloatArray(randn(n * abs(inc_x)))
+            x_idx = indexed_vector(x, n, inc_x)
+            b = x_idx.copy()
+
+            blas.stpmv(is_upper, is_trans, is_unit, n, AP, x, inc_x)
+            assert_allclose(op_T.dot(b), x_idx, 1e-4, 1e-4 * n)
+
+            blas.stpsv(is_upper, is_trans, is_unit, n, AP, x, inc_x)
+            assert_allclose(b, x_idx, 1e-4, 1e-4 * n)
+
+
+def test_sspr_sspr2():
+    """Test the packed symmetric rank-1 and rank-2 updates"""
+    for n, is_upper, inc_x, inc_y in product(
+            (1, 5, 40), (True, False), vec_inc, vec_inc):
+        a = randn()
+        T = randn(n, n)
+        x = FloatArray(randn(n * abs(inc_x)))
+        y = FloatArray(randn(n * abs(inc_y)))
+        x_idx = indexed_vector(x, n, inc_x)
+        y_idx = indexed_vector(y, n, inc_y)
+
+        AP = pack_triangle(T, is_upper)
+        blas.sspr(is_upper, n, a, x, inc_x, AP)
+        expected = pack_triangle(T + a * np.outer(x_idx, x_idx), is_upper)
+        assert_allclose(expected, AP, 1e-5, 1e-5)
+
+        AP = pack_triangle(T, is_upper)
+        blas.sspr2(is_upper, n, a, x, inc_x, y, inc_y, AP)
+        expected = pack_triangle(
+            T + a * np.outer(x_idx, y_idx) + a * np.outer(y_idx, x_idx),
+            is_upper)
+        assert_allclose(expected, AP, 1e-5, 1e-5)
+
+
+def test_sgbmv():
+    """Test sp_blas_sgbmv against the equivalent dense product"""
+    shapes = ((1, 1, 0, 0), (5, 7, 1, 2), (9, 4, 3, 0), (20, 12, 25, 15))
+    for (rows, cols, kl, ku), is_trans in product(shapes, (False, True)):
+        for inc_x, inc_y in product(vec_inc, vec_inc):
+            a, b = randn(2)
+            A = np.triu(np.tril(randn(rows, cols), ku), -kl)
+            op_A = A.T if is_trans else A
+            len_y, len_x = op_A.shape
+
+            x = FloatArray(randn(len_x * abs(inc_x)))
+            y = FloatArray(randn(len_y * abs(inc_y)))
+            x_idx = indexed_vector(x, len_x, inc_x)
+            y_idx = indexed_vector(y, len_y, inc_y)
+
+            expected = a * op_A.dot(x_idx) + b * y_idx
+            blas.sgbmv(is_trans, rows, cols, kl, ku, a,
+                       band_storage(A, kl, ku), kl + ku + 1, x, inc_x, b, y,
+                       inc_y)
+            assert_allclose(expected, y_idx, 1e-4, 1e-4)
+
+
+def test_ssbmv_stbmv_stbsv():
+    """Test the symmetric and triangular band routines"""
+    for n, k in product((1, 6, 50), (0, 1, 4, 60)):
+        A = np.triu(np.tril(randn(n, n), k), -k) / (k + 1) + np.eye(n)
+        for is_upper, inc_x, inc_y in product(
+                (True, False), vec_inc, vec_inc):
+            T = np.triu(A) if is_upper else np.tril(A)
+            S = T + T.T - np.diag(np.diag(T))
+            band = band_storage(T, 0 if is_upper else k, k if is_upper else 0)
+            a, b = randn(2)
+
+            x = FloatArray(randn(n * abs(inc_x)))
+            y = FloatArray(randn(n * abs(inc_y)))
+            x_idx = indexed_vector(x, n, inc_x)
+            y_idx = indexed_vector(y, n, inc_y)
+
+            expected = a * S.dot(x_idx) + b * y_idx
+            blas.ssbmv(is_upper, n, k, a, band, k + 1, x, inc_x, b, y, inc_y)
+            assert_allclose(expected, y_idx, 1e-4, 1e-4 * n)
+
+            for is_trans, is_unit in product((True, False), (True, False)):
+                T_op = T.copy()
+                if is_unit:
+                    np.fill_diagonal(T_op, 1.0)
+                if is_trans:
+                    T_op = T_op.T
+                x0 = x_idx.copy()
+
+                blas.stbmv(is_upper, is_trans, is_unit, n, k, band, k + 1, x,
+                           inc_x)
+                assert_allclose(T_op.dot(x0), x_idx, 1e-4, 1e-4 * n)
+
+                blas.stbsv(is_upper, is_trans, is_unit, n, k, band, k + 1, x,
+                           inc_x)
+                assert_allclose(x0, x_idx, 1e-4, 1e-4 * n)
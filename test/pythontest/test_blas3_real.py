@@ -0,0 +1,159 @@
+import threading
+from itertools import product
+
+import numpy as np
+from numpy.random import randn
+from numpy.testing import assert_allclose, assert_equal
+
+from snackpack import blas, error
+from snackpack.util import FloatArray
+
+# Value of SP_ERROR_INVALID_LDA in snackpack/error.h
+SP_ERROR_INVALID_LDA = 3
+
+
+shapes = ((1, 1, 1), (7, 5, 3), (33, 17, 65), (64, 64, 64), (200, 13, 300),
+          (300, 257, 129))
+
+
+def test_sgemm():
+    """Test sp_blas_sgemm for all transpose combinations"""
+    for (m, n, k), ta, tb in product(shapes, (False, True), (False, True)):
+        for a, b in ((1.0, 0.0), (randn(), randn()), (0.0, randn())):
+            rows_a, cols_a = (k, m) if ta else (m, k)
+            rows_b, cols_b = (n, k) if tb else (k, n)
+            lda, ldb, ldc = rows_a + 1, rows_b + 2, m + 3
+
+            A = FloatArray(randn(lda * cols_a))
+            B = FloatArray(randn(ldb * cols_b))
+            C = FloatArray(randn(ldc * n))
+
+            A_s = np.reshape(A, (lda, cols_a), 'F')[:rows_a, :]
+            B_s = np.reshape(B, (ldb, cols_b), 'F')[:rows_b, :]
+            C_s = np.reshape(C, (ldc, n), 'F')
+            op_a = A_s.T if ta else A_s
+            op_b = B_s.T if tb else B_s
+
+            C0 = C_s.copy()
+            expected = a * op_a.astype(float).dot(op_b) + b * C0[:m, :]
+            blas.sgemm(ta, tb, m, n, k, a, A, lda, B, ldb, b, C, ldc)
+
+            C_new = np.reshape(C, (ldc, n), 'F')
+            assert_allclose(expected, C_new[:m, :], 1e-4, 1e-4 * k)
+            assert_allclose(C0[m:, :], C_new[m:, :])
+
+
+def test_sgemm_invalid_lda():
+    """Test that sp_blas_sgemm rejects leading dimensions that are too
+    small and leaves C untouched"""
+    m, n, k = 7, 5, 3
+    A = FloatArray(randn(100))
+    B = FloatArray(randn(100))
+    for ta, tb in product((False, True), (False, True)):
+        rows_a = k if ta else m
+        rows_b = n if tb else k
+        for lda, ldb, ldc in ((rows_a - 1, rows_b, m),
+                              (rows_a, rows_b - 1, m),
+                              (rows_a, rows_b, m - 1)):
+            C = FloatArray(randn(100))
+            C0 = C.copy()
+            error.clear_last_error()
+            blas.sgemm(ta, tb, m, n, k, 1.0, A, lda, B, ldb, 0.0, C, ldc)
+            assert_equal(SP_ERROR_INVALID_LDA, error.get_last_error())
+            assert_equal(C0, C)
+    error.clear_last_error()
+
+
+def test_sgemm_small_stack():
+    """Test sp_blas_sgemm on a thread with a small stack"""
+    n = 64
+    A = FloatArray(randn(n * n))
+    B = FloatArray(randn(n * n))
+    C = FloatArray(np.zeros(n * n))
+
+    old_size = threading.stack_size(512 * 1024)
+    try:
+        t = threading.Thread(target=blas.sgemm,
+                             args=(False, False, n, n, n, 1.0, A, n, B, n,
+                                   0.0, C, n))
+        t.start()
+        t.join()
+    finally:
+        threading.stack_size(old_size)
+
+    A_s = np.reshape(A, (n, n), 'F').astype(float)
+    B_s = np.reshape(B, (n, n), 'F')
+    assert_allclose(A_s.dot(B_s), np.reshape(C, (n, n), 'F'), 1e-4,
+                    1e-4 * n)
+
+
+def test_strsm():
+    """Test sp_blas_strsm for every side, triangle, transpose and diagonal"""
+    for (m, n, _), is_left, is_upper, is_trans, is_unit in product(
+            shapes, (True, False), (True, False), (True, False),
+            (True, False)):
+        na = m if is_left else n
+        lda, ldb = na + 1, m + 2
+        a = randn()
+
+        # Small off-diagonal entries keep the system well conditioned, also
+        # with a unit diagonal
+        A = FloatArray(randn(lda * na) / na)
+        A_s = np.reshape(A, (lda, na), 'F')
+        A_s[:na, :] += np.eye(na)
+        B = FloatArray(randn(ldb * n))
+
+        T = np.triu(A_s[:na, :]) if is_upper else np.tril(A_s[:na, :])
+        if is_unit:
+            np.fill_diagonal(T, 1.0)
+        op_T = T.T if is_trans else T
+
+        B0 = np.reshape(B, (ldb, n), 'F').copy()
+        blas.strsm(is_left, is_upper, is_trans, is_unit, m, n, a, A, lda,
+                   B, ldb)
+
+        X = np.reshape(B, (ldb, n), 'F')
+        got = op_T.dot(X[:m, :]) if is_left else X[:m, :].dot(op_T)
+        assert_allclose(got, a * B0[:m, :], 1e-4, 1e-4 * na)
+        assert_allclose(B0[m:, :], X[m:, :])
+
+
+def test_strsm_invalid_lda():
+    """Test that sp_blas_strsm rejects leading dimensions that are too
+    small and leaves B untouched"""
+    m, n = 7, 5
+    A = FloatArray(randn(100))
+    for is_left in (True, False):
+        na = m if is_left else n
+        for lda, ldb in ((na - 1, m), (na, m - 1)):
+            B = FloatArray(randn(100))
+            B0 = B.copy()
+            error.clear_last_error()
+            blas.strsm(is_left, True, False, False, m, n, 1.0, A, lda, B,
+                       ldb)
+            assert_equal(SP_ERROR_INVALID_LDA, error.get_last_error())
+            assert_equal(B0, B)
+    error.clear_last_error()
+
+
+def test_strsm_small_stack():
+    """Test sp_blas_strsm on a thread with a small stack"""
+    m, n = 200, 300
+    A = FloatArray(randn(m * m) / m)
+    A_s = np.reshape(A, (m, m), 'F')
+    A_s += np.eye(m)
+    B = FloatArray(randn(m * n))
+    B0 = np.reshape(B, (m, n), 'F').copy()
+
+    old_size = threading.stack_size(1024 * 1024)
+    try:
+        t = threading.Thread(target=blas.strsm,
+                             args=(True, False, False, False, m, n, 1.0, A,
+                                   m, B, m))
+        t.start()
+        t.join()
+    finally:
+        threading.stack_size(old_size)
+
+    X = np.reshape(B, (m, n), 'F')
+    assert_allclose(np.tril(A_s).dot(X), B0, 1e-4, 1e-4 * m)
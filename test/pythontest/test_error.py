@@ -0,0 +1,140 @@
+import ctypes
+import threading
+
+import numpy as np
+from numpy.random import randn
+from numpy.testing import assert_equal, assert_almost_equal
+
+from snackpack import blas, error
+from snackpack.util import FloatArray, len_t
+
+# Values of the SP_ERROR enum in snackpack/error.h
+SP_NO_ERROR = 0
+SP_ERROR_INVALID_DIM = 1
+SP_ERROR_INVALID_INC = 2
+SP_ERROR_INVALID_LDA = 3
+SP_ERROR_DIM_TOO_LARGE = 7
+
+# SP_MAX_DIMENSION, the largest n whose square fits in len_t
+max_dimension = int((2 ** (8 * ctypes.sizeof(len_t) - 1) - 1) ** 0.5)
+
+
+def test_err_valid():
+    """Test that the _err routines match the plain ones on valid input"""
+    for n in (1, 17, 1000):
+        x = FloatArray(randn(n))
+        y = FloatArray(randn(n))
+
+        result = FloatArray(np.zeros(1))
+        assert_equal(SP_NO_ERROR, blas.sdot_err(n, x, 1, y, 1, result))
+        assert_equal(blas.sdot(n, x, 1, y, 1), result[0])
+
+        assert_equal(SP_NO_ERROR, blas.sasum_err(n, x, 1, result))
+        assert_almost_equal(blas.sasum(n, x, 1) / result[0], 1.0)
+
+        index = np.zeros(1, dtype=len_t)
+        assert_equal(SP_NO_ERROR, blas.isamax_err(n, x, 1, index))
+        assert_equal(blas.isamax(n, x, 1), index[0])
+
+        value = FloatArray(np.zeros(1))
+        assert_equal(SP_NO_ERROR,
+                     blas.isamax_value_err(n, x, 1, value, index))
+        assert_equal(blas.isamax(n, x, 1), index[0])
+        assert_equal(x[index[0]], value[0])
+
+        assert_equal(SP_NO_ERROR,
+                     blas.isamin_value_err(n, x, 1, value, index))
+        assert_equal(blas.isamin(n, x, 1), index[0])
+        assert_equal(x[index[0]], value[0])
+
+        expected = y.copy()
+        blas.saxpy(n, 2.0, x, 1, expected, 1)
+        assert_equal(SP_NO_ERROR, blas.saxpy_err(n, 2.0, x, 1, y, 1))
+        assert_equal(expected, y)
+
+
+def test_err_invalid():
+    """Test that the _err routines report the failed check"""
+    x = FloatArray(randn(10))
+    y = FloatArray(randn(10))
+    a = FloatArray(randn(100))
+    result = FloatArray(np.zeros(1))
+
+    assert_equal(SP_ERROR_INVALID_DIM, blas.sdot_err(0, x, 1, y, 1, result))
+    assert_equal(SP_ERROR_INVALID_INC, blas.sdot_err(10, x, 0, y, 1, result))
+    assert_equal(SP_ERROR_INVALID_INC, blas.sscal_err(10, 2.0, x, 0))
+    assert_equal(SP_ERROR_DIM_TOO_LARGE,
+                 blas.sasum_err(max_dimension + 1, x, 1, result))
+    assert_equal(SP_ERROR_INVALID_LDA,
+                 blas.sgemv_err(False, 10, 10, 1.0, a, 9, x, 1, 0.0, y, 1))
+    assert_equal(SP_ERROR_INVALID_LDA,
+                 blas.sgemm_err(False, False, 10, 10, 10, 1.0, a, 9, a, 10,
+                                0.0, a, 10))
+
+    index = np.zeros(1, dtype=len_t)
+    assert_equal(SP_ERROR_INVALID_INC,
+                 blas.isamax_value_err(10, x, 0, result, index))
+    assert_equal(SP_ERROR_INVALID_INC,
+                 blas.isamin_value_err(10, x, 0, result, index))
+
+    # A failed call is followed by a clean one.
+    assert_equal(SP_NO_ERROR, blas.sdot_err(10, x, 1, y, 1, result))
+
+    # The batched routines check each argument once for the whole batch.
+    assert_equal(SP_NO_ERROR,
+                 blas.saxpy_batch_err(5, 2.0, x, 1, 5, y, 1, 5, 2))
+    assert_equal(SP_ERROR_INVALID_INC,
+                 blas.saxpy_batch_err(5, 2.0, x, 0, 5, y, 1, 5, 2))
+    assert_equal(SP_ERROR_INVALID_DIM,
+                 blas.sdot_batch_err(5, x, 1, 5, y, 1, 5, result, -1))
+    error.clear_last_error()
+
+
+def test_err_pending():
+    """Test that an _err routine that passes keeps the pending error"""
+    x = FloatArray(randn(10))
+    y = FloatArray(randn(10))
+    result = FloatArray(np.zeros(1))
+
+    error.clear_last_error()
+    blas.saxpy(10, 1.0, x, 0, y, 1)
+    assert_equal(SP_NO_ERROR, blas.sdot_err(10, x, 1, y, 1, result))
+    assert_equal(SP_ERROR_INVALID_INC, error.get_last_error())
+
+    # A failure replaces it, as for the plain routines.
+    assert_equal(SP_ERROR_INVALID_DIM, blas.sdot_err(0, x, 1, y, 1, result))
+    assert_equal(SP_ERROR_INVALID_DIM, error.get_last_error())
+    error.clear_last_error()
+
+
+def test_last_error():
+    """Test that the plain routines set the thread-local last error"""
+    x = FloatArray(randn(10))
+    y = FloatArray(randn(10))
+
+    error.clear_last_error()
+    assert_equal(SP_NO_ERROR, error.get_last_error())
+    blas.sdot(10, x, 1, y, 1)
+    assert_equal(SP_NO_ERROR, error.get_last_error())
+
+    blas.saxpy(10, 1.0, x, 0, y, 1)
+    assert_equal(SP_ERROR_INVALID_INC, error.get_last_error())
+
+    # Like errno, a successful call leaves the error in place.
+    blas.sdot(10, x, 1, y, 1)
+    assert_equal(SP_ERROR_INVALID_INC, error.get_last_error())
+
+    # Another thread has its own error.
+    errors = []
+
+    def fail_other():
+        error.clear_last_error()
+        blas.sdot(0, x, 1, y, 1)
+        errors.append(error.get_last_error())
+
+    t = threading.Thread(target=fail_other)
+    t.start()
+    t.join()
+    assert_equal([SP_ERROR_INVALID_DIM], errors)
+    assert_equal(SP_ERROR_INVALID_INC, error.get_last_error())
+    error.clear_last_error()
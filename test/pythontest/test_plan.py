@@ -0,0 +1,125 @@
+from itertools import product
+
+import numpy as np
+from numpy.random import randn
+from numpy.testing import assert_equal, assert_array_equal
+
+from snackpack import blas, plan
+from snackpack.util import FloatArray
+
+
+def test_plan_sgemv():
+    """Test that an sgemv plan gives the same result as sp_blas_sgemv"""
+    for is_trans in (False, True):
+        for rows, cols in ((4, 9), (16, 16), (7, 5), (300, 400)):
+            lda = rows + 2
+            a = FloatArray(randn(cols, lda))
+            x = FloatArray(randn(cols if not is_trans else rows))
+            y = FloatArray(randn(rows if not is_trans else cols))
+            for alpha, beta in ((1.5, 0.5), (0.0, 2.0), (1.0, 0.0)):
+                expected = y.copy()
+                blas.sgemv(is_trans, rows, cols, alpha, a, lda, x, 1, beta,
+                           expected, 1)
+
+                p = plan.sgemv(is_trans, rows, cols, alpha, lda, 1, beta, 1)
+                result = y.copy()
+                plan.execute(p, a, x, result)
+                plan.destroy(p)
+                np.testing.assert_allclose(expected, result, rtol=1e-5,
+                                           atol=1e-5)
+
+
+def test_plan_blas1():
+    """Test the level 1 plans against the plain routines"""
+    for n in (1, 17, 1000, 40000):
+        x = FloatArray(randn(n))
+        y = FloatArray(randn(n))
+
+        p = plan.sdot(n, 1, 1)
+        assert_equal(blas.sdot(n, x, 1, y, 1), plan.execute(p, x, x, y))
+        plan.destroy(p)
+
+        expected = y.copy()
+        blas.saxpy(n, 2.0, x, 1, expected, 1)
+        result = y.copy()
+        p = plan.saxpy(n, 2.0, 1, 1)
+        plan.execute(p, x, x, result)
+        plan.destroy(p)
+        assert_array_equal(expected, result)
+
+        result = y.copy()
+        p = plan.scopy(n, 1, 1)
+        plan.execute(p, x, x, result)
+        plan.destroy(p)
+        assert_array_equal(x, result)
+
+        expected = y.copy()
+        blas.sscal(n, 3.0, expected, 1)
+        result = y.copy()
+        p = plan.sscal(n, 3.0, 1)
+        plan.execute(p, x, x, result)
+        plan.destroy(p)
+        assert_array_equal(expected, result)
+
+
+def test_plan_sgemv_strided():
+    """Test sgemv plans with non-unit and negative increments"""
+    for is_trans in (False, True):
+        for rows, cols in ((4, 9), (7, 5), (300, 400)):
+            lda = rows + 2
+            a = FloatArray(randn(cols, lda))
+            len_x, len_y = (rows, cols) if is_trans else (cols, rows)
+            for inc_x, inc_y in ((2, -1), (-3, 2)):
+                x = FloatArray(randn(len_x * abs(inc_x)))
+                y = FloatArray(randn(len_y * abs(inc_y)))
+
+                expected = y.copy()
+                blas.sgemv(is_trans, rows, cols, 1.5, a, lda, x, inc_x, 0.5,
+                           expected, inc_y)
+
+                p = plan.sgemv(is_trans, rows, cols, 1.5, lda, inc_x, 0.5,
+                               inc_y)
+                result = y.copy()
+                plan.execute(p, a, x, result)
+                plan.destroy(p)
+                assert_array_equal(expected, result)
+
+
+def test_plan_blas1_strided():
+    """Test the level 1 plans with non-unit and negative increments"""
+    for n, (inc_x, inc_y) in product((1, 17, 1000, 40000),
+                                     ((2, -1), (-3, 2), (-1, -1))):
+        x = FloatArray(randn(n * abs(inc_x)))
+        y = FloatArray(randn(n * abs(inc_y)))
+
+        p = plan.sdot(n, inc_x, inc_y)
+        assert_equal(blas.sdot(n, x, inc_x, y, inc_y),
+                     plan.execute(p, x, x, y))
+        plan.destroy(p)
+
+        expected = y.copy()
+        blas.saxpy(n, 2.0, x, inc_x, expected, inc_y)
+        result = y.copy()
+        p = plan.saxpy(n, 2.0, inc_x, inc_y)
+        plan.execute(p, x, x, result)
+        plan.destroy(p)
+        assert_array_equal(expected, result)
+
+        expected = y.copy()
+        blas.scopy(n, x, inc_x, expected, inc_y)
+        result = y.copy()
+        p = plan.scopy(n, inc_x, inc_y)
+        plan.execute(p, x, x, result)
+        plan.destroy(p)
+        assert_array_equal(expected, result)
+
+        # An sscal plan takes the vector as y, with inc_y = inc_x
+        expected = x.copy()
+        blas.sscal(n, 3.0, expected, inc_x)
+        result = x.copy()
+        x0 = x.copy()
+        p = plan.sscal(n, 3.0, inc_x)
+        plan.execute(p, x, x, result)
+        plan.destroy(p)
+        assert_array_equal(expected, result)
+        assert_array_equal(x0, x)
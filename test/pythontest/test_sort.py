@@ -0,0 +1,136 @@
+import numpy as np
+from numpy.random import randn, randint
+from numpy.testing import assert_equal, assert_array_equal
+
+from snackpack import lapack
+from snackpack.util import FloatArray, len_t
+
+
+sort_sizes = (2, 3, 15, 16, 17, 100, 2047, 2048, 10000)
+
+
+def test_slasrt():
+    """Test sp_slasrt against numpy.sort"""
+    for n in sort_sizes:
+        for x in (randn(n), randint(-3, 4, n), np.arange(n), -np.arange(n)):
+            x = FloatArray(x)
+            expected = np.sort(x)
+
+            d = x.copy()
+            assert_equal(lapack.slasrt(b'I', n, d), 0)
+            assert_array_equal(expected, d)
+
+            d = x.copy()
+            assert_equal(lapack.slasrt(b'D', n, d), 0)
+            assert_array_equal(expected[::-1], d)
+
+
+def test_slasrt_special_values():
+    """Test that sp_slasrt puts -0.0 before 0.0 and NaNs last"""
+    for n in sort_sizes:
+        x = FloatArray(randn(n))
+        x[::4] = 0.0
+        x[1::4] = -0.0
+        x[::7] = np.nan
+        m = n - np.isnan(x).sum()
+        for id in (b'I', b'D'):
+            d = x.copy()
+            assert_equal(lapack.slasrt(id, n, d), 0)
+            assert np.isnan(d[m:]).all()
+            s = d[:m] if id == b'I' else d[m - 1::-1]
+            assert (np.diff(s) >= 0).all()
+            zeros = np.signbit(s[s == 0])
+            assert_array_equal(np.sort(zeros)[::-1], zeros)
+
+
+def test_slasrt_invalid():
+    """Test the return values of sp_slasrt on bad input"""
+    d = FloatArray(randn(3))
+    assert_equal(lapack.slasrt(b'X', 3, d), -1)
+    assert_equal(lapack.slasrt(b'I', 0, d), -2)
+
+
+def test_slasrt_perm():
+    """Test that sp_slasrt_perm returns a stable sorting permutation"""
+    for n in sort_sizes:
+        x = FloatArray(randint(-3, 4, n))
+        for id in (b'I', b'D'):
+            d = x.copy()
+            perm = np.empty(n, dtype=len_t)
+            assert_equal(lapack.slasrt_perm(id, n, d, perm), 0)
+            assert_array_equal(x[perm], d)
+
+            # Equal values keep their input order
+            order = np.argsort(-x if id == b'D' else x, kind='stable')
+            assert_array_equal(order, perm)
+
+
+def test_slasrt_cols():
+    """Test sp_slasrt_cols and sp_slapmt"""
+    for n in sort_sizes:
+        for rows in (1, 5, 300):
+            lda = rows + 1
+            x = FloatArray(randn(n))
+            # Column-major rows x n matrix with leading dimension lda
+            a = FloatArray(randn(n, lda))
+            a0 = a.copy()
+            d = x.copy()
+            assert_equal(lapack.slasrt_cols(b'D', n, d, rows, a, lda), 0)
+
+            perm = np.argsort(-x, kind='stable').astype(len_t)
+            assert_array_equal(x[perm], d)
+            assert_array_equal(a0[perm, :rows], a[:, :rows])
+            assert_array_equal(a0[:, rows:], a[:, rows:])
+
+            # Moving the columns back restores A and leaves perm alone
+            perm0 = perm.copy()
+            assert_equal(lapack.slapmt(False, rows, n, a, lda, perm), 0)
+            assert_array_equal(a0, a)
+            assert_array_equal(perm0, perm)
+
+
+def test_slasrt_topk():
+    """Test sp_slasrt_topk against a full sort"""
+    for n in sort_sizes:
+        x = FloatArray(randn(n))
+        for k in (0, 1, n // 2, n):
+            for id in (b'I', b'D'):
+                expected = np.sort(x)
+                if id == b'D':
+                    expected = expected[::-1]
+                d = x.copy()
+                assert_equal(lapack.slasrt_topk(id, k, n, d), 0)
+                assert_array_equal(expected[:k], d[:k])
+                assert_array_equal(np.sort(x), np.sort(d))
+
+
+def test_sselect():
+    """Test sp_sselect against a full sort"""
+    for n in sort_sizes:
+        for x in (randn(n), randint(-3, 4, n)):
+            x = FloatArray(x)
+            expected = np.sort(x)
+            for k in (0, n // 2, n - 1):
+                d = x.copy()
+                assert_equal(lapack.sselect(b'I', k, n, d), 0)
+                assert_equal(expected[k], d[k])
+                assert (d[:k] <= d[k]).all()
+                assert (d[k + 1:] >= d[k]).all()
+
+                d = x.copy()
+                assert_equal(lapack.sselect(b'D', k, n, d), 0)
+                assert_equal(expected[n - 1 - k], d[k])
+
+
+def test_slasrt_large():
+    """Test sp_slasrt above the size where it runs on the thread pool"""
+    n = 1 << 19
+    for x in (randn(n), randint(-3, 4, n), np.ones(n)):
+        x = FloatArray(x)
+        x[::7] = np.nan
+        x[::11] = -0.0
+        expected = np.sort(x)
+
+        d = x.copy()
+        assert_equal(lapack.slasrt(b'I', n, d), 0)
+        assert_array_equal(expected, d)
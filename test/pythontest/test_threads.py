@@ -0,0 +1,115 @@
+import os
+import subprocess
+import sys
+import time
+from unittest import SkipTest
+
+import numpy as np
+from numpy.random import randn
+from numpy.testing import assert_equal
+
+from snackpack import blas, threads
+from snackpack.util import FloatArray
+
+
+# Above SP_REDUCE_PARALLEL_MIN, so that sdot runs on the thread pool, and
+# below SP_MAX_DIMENSION.
+n_threaded = 40000
+
+
+def run_python(code, env=None, preexec_fn=None):
+    """Run code in a fresh interpreter that imports snackpack the same way
+    as this one, and return what it prints."""
+    child_env = dict(os.environ)
+    child_env.pop('SNACKPACK_NUM_THREADS', None)
+    child_env['PYTHONPATH'] = os.pathsep.join(p for p in sys.path if p)
+    child_env.update(env or {})
+    out = subprocess.check_output(
+        [sys.executable, '-c', code], env=child_env, preexec_fn=preexec_fn)
+    return out.decode().strip()
+
+
+def test_set_num_threads():
+    """Test sp_set_num_threads and sp_get_num_threads"""
+    default = threads.get_num_threads()
+    assert default >= 1
+    try:
+        for n in (1, 2, 3, 8):
+            threads.set_num_threads(n)
+            assert_equal(n, threads.get_num_threads())
+        threads.set_num_threads(100000)
+        assert_equal(256, threads.get_num_threads())
+        threads.set_num_threads(-1)
+        assert_equal(default, threads.get_num_threads())
+    finally:
+        threads.set_num_threads(0)
+    assert_equal(default, threads.get_num_threads())
+
+
+def test_num_threads_env():
+    """Test that SNACKPACK_NUM_THREADS sets the default thread count"""
+    code = ('from snackpack import threads; '
+            'print(threads.get_num_threads())')
+    for n in (1, 3, 5):
+        out = run_python(code, {'SNACKPACK_NUM_THREADS': str(n)})
+        assert_equal(str(n), out)
+    assert_equal(run_python(code, {'SNACKPACK_NUM_THREADS': '0'}),
+                 run_python(code))
+
+
+def test_num_threads_affinity():
+    """Test that the default thread count follows the affinity mask"""
+    if not hasattr(os, 'sched_setaffinity'):
+        raise SkipTest('no sched_setaffinity')
+    cpu = min(os.sched_getaffinity(0))
+    code = ('from snackpack import threads; '
+            'print(threads.get_num_threads())')
+    out = run_python(code, preexec_fn=lambda: os.sched_setaffinity(0, [cpu]))
+    assert_equal('1', out)
+
+
+def test_thread_counts_agree():
+    """Test a threaded sdot with different and pinned thread counts"""
+    x = FloatArray(randn(n_threaded))
+    y = FloatArray(randn(n_threaded))
+    try:
+        threads.set_num_threads(1)
+        expected = blas.sdot(n_threaded, x, 1, y, 1)
+        for n in (2, 4):
+            threads.set_num_threads(n)
+            assert_equal(expected, blas.sdot(n_threaded, x, 1, y, 1))
+        threads.set_thread_affinity(True)
+        assert_equal(expected, blas.sdot(n_threaded, x, 1, y, 1))
+    finally:
+        threads.set_thread_affinity(False)
+        threads.set_num_threads(0)
+
+
+def test_fork():
+    """Test that a forked child can use the thread pool"""
+    if not hasattr(os, 'fork'):
+        raise SkipTest('no fork')
+    x = FloatArray(randn(n_threaded))
+    try:
+        # Start the workers in the parent.
+        threads.set_num_threads(4)
+        expected = blas.sdot(n_threaded, x, 1, x, 1)
+
+        pid = os.fork()
+        if pid == 0:
+            ok = blas.sdot(n_threaded, x, 1, x, 1) == expected
+            os._exit(0 if ok else 1)
+
+        deadline = time.time() + 30
+        while True:
+            done, status = os.waitpid(pid, os.WNOHANG)
+            if done != 0:
+                break
+            if time.time() > deadline:
+                os.kill(pid, 9)
+                os.waitpid(pid, 0)
+                raise AssertionError('forked child hung')
+            time.sleep(0.01)
+        assert_equal(0, status)
+    finally:
+        threads.set_num_threads(0)